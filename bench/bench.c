@@ -0,0 +1,123 @@
+/**
+ * @file bench.c
+ * @brief Harness of the benchmark firmware. It counts with the SysTick, which QEMU models and drives with the virtual clock, because QEMU does not model the DWT cycle counter.
+ *
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-22
+ */
+/* System dependent libraries */
+#include <stdio.h>
+#include "stm32f4xx.h"
+
+/* HW independent libraries */
+#include "bench.h"
+
+/* Private variables ---------------------------------------------------------*/
+static volatile uint32_t bench_wraps = 0; /*!< Wraps of the SysTick since `bench_init()` */
+static uint64_t bench_overhead = 0;       /*!< Ticks of an empty measurement */
+static uint64_t bench_cal_insns = 1;      /*!< Instructions of the calibration */
+static uint64_t bench_cal_ticks = 1;      /*!< Ticks of the calibration */
+
+/* Private functions ----------------------------------------------------------*/
+/**
+ * @brief Ticks of the core clock since `bench_init()`
+ *
+ * @return ticks
+ */
+static uint64_t _ticks(void)
+{
+    uint32_t wraps;
+    uint32_t val;
+    do
+    {
+        wraps = bench_wraps;
+        val = SysTick->VAL;
+    } while (wraps != bench_wraps);
+    return ((uint64_t)wraps << 24) + (BENCH_SYSTICK_RELOAD - val);
+}
+
+/**
+ * @brief Loop of exactly 2 instructions per iteration
+ *
+ * @param iterations number of iterations, at least 1
+ */
+static void _calibration_loop(uint32_t iterations)
+{
+    __asm volatile("1: subs %0, %0, #1\n\t"
+                   "bne 1b"
+                   : "+r"(iterations)
+                   :
+                   : "cc");
+}
+
+/**
+ * @brief Empty scenario, to measure the cost of the measurement
+ */
+static void _empty(void)
+{
+}
+
+/**
+ * @brief Ticks of several runs of a scenario
+ *
+ * @param scenario scenario to run
+ * @param runs number of runs
+ * @return ticks
+ */
+static uint64_t _measure(bench_scenario_t scenario, uint32_t runs)
+{
+    uint64_t start = _ticks();
+    for (uint32_t i = 0; i < runs; i++)
+    {
+        scenario();
+    }
+    return _ticks() - start;
+}
+
+/* Public functions -----------------------------------------------------------*/
+/**
+ * @brief Count the wraps of the SysTick
+ */
+void SysTick_Handler(void)
+{
+    bench_wraps++;
+}
+
+void bench_init(void)
+{
+    SysTick->CTRL = 0;
+    SysTick->LOAD = BENCH_SYSTICK_RELOAD;
+    SysTick->VAL = 0;
+    NVIC_SetPriority(SysTick_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 15, 0)); // Lowest priority: it only counts wraps
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+
+    bench_overhead = _measure(_empty, 1);
+
+    // The difference of two loops leaves out the call and the measurement
+    uint64_t start = _ticks();
+    _calibration_loop(BENCH_CALIBRATION_LOOPS);
+    uint64_t single = _ticks() - start;
+    start = _ticks();
+    _calibration_loop(2 * BENCH_CALIBRATION_LOOPS);
+    uint64_t twice = _ticks() - start;
+    if (twice > single)
+    {
+        bench_cal_insns = 2 * BENCH_CALIBRATION_LOOPS;
+        bench_cal_ticks = twice - single;
+    }
+}
+
+void bench_run(const char *p_name, bench_scenario_t scenario, uint32_t runs)
+{
+    uint64_t ticks = _measure(scenario, runs);
+    ticks = (ticks > bench_overhead) ? ticks - bench_overhead : 0;
+    uint64_t insns = (ticks * bench_cal_insns + bench_cal_ticks / 2) / bench_cal_ticks;
+    printf("BENCH %s insns=%lu cycles=%lu\n", p_name, (unsigned long)(insns / runs), (unsigned long)(ticks / runs));
+}
+
+int bench_end(void)
+{
+    printf("BENCH_END\n");
+    return 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file bench.h
+ * @brief Header for bench.c file. Harness of the benchmark firmware: it counts the instructions and cycles of every scenario with the SysTick and prints them for `tools/bench_compare.py`.
+ *
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-22
+ */
+#ifndef BENCH_H_
+#define BENCH_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+
+/* Defines ----------------------------------------------------------*/
+#define BENCH_SYSTICK_RELOAD 0xFFFFFFU /*!< The SysTick runs free over its 24 bits and counts its wraps @hideinitializer */
+#define BENCH_CALIBRATION_LOOPS 1000U  /*!< Iterations of the calibration loop, of 2 instructions each @hideinitializer */
+
+/* Typedefs --------------------------------------------------------------------*/
+/**
+ * @brief Scenario of a benchmark: it injects its stimuli and runs the code under test once
+ */
+typedef void (*bench_scenario_t)(void);
+
+/* Function prototypes and explanation -------------------------------------------------*/
+/**
+ * @brief Start the SysTick as a free running counter of the core clock and calibrate the instructions per tick
+ *
+ * The calibration runs a loop of a known number of instructions. Under QEMU with `-icount` every instruction advances the
+ * virtual clock by the same time, so the ticks of any scenario are an exact and repeatable count of its instructions. On
+ * the board the ticks are the real cycles and the instructions are only an estimate.
+ */
+void bench_init(void);
+
+/**
+ * @brief Run a scenario several times and print its instructions and cycles per run
+ *
+ * Prints one line `BENCH <name> insns=<n> cycles=<n>`, without the cost of the measurement itself.
+ *
+ * @param p_name name of the scenario, unique in the whole suite
+ * @param scenario scenario to run
+ * @param runs number of runs
+ */
+void bench_run(const char *p_name, bench_scenario_t scenario, uint32_t runs);
+
+/**
+ * @brief Print the end of the benchmark, so that a firmware that hangs or resets is not taken as a faster one
+ *
+ * @return exit code of the firmware
+ */
+int bench_end(void);
+
+#endif /* BENCH_H_ */
@@ -0,0 +1,151 @@
+/**
+ * @file bench_fsm.c
+ * @brief Benchmark of the FSMs. Every scenario injects the flags that the ISRs would set and the time that would pass, so each run goes through the same transitions without any hardware stimulus.
+ *
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-22
+ */
+/* System dependent libraries */
+#include <stdlib.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_button.h"
+#include "port_ultrasound.h"
+#include "port_display.h"
+#include "port_buzzer.h"
+
+/* HW independent libraries */
+#include "fsm_button.h"
+#include "fsm_ultrasound.h"
+#include "fsm_display.h"
+#include "fsm_buzzer.h"
+#include "bench.h"
+
+/* Defines */
+#define BENCH_RUNS 10                  /*!< Runs of every scenario @hideinitializer */
+#define BENCH_BUTTON_DEBOUNCE_MS 150   /*!< Debounce time of the button under test @hideinitializer */
+#define BENCH_BUTTON_HOLD_MS 500       /*!< Duration of every press @hideinitializer */
+#define BENCH_ECHO_INIT_TICK 100       /*!< Tick of the rising edge of every echo @hideinitializer */
+#define BENCH_SWEEP_STEP_CM 10         /*!< Step of the distance sweeps @hideinitializer */
+#define BENCH_SWEEP_MAX_CM 220         /*!< Last distance of the sweeps, past the last zone @hideinitializer */
+
+/* Private variables ---------------------------------------------------------*/
+static fsm_button_t *p_fsm_button;         /*!< Button under test */
+static fsm_ultrasound_t *p_fsm_ultrasound; /*!< Ultrasound under test */
+static fsm_display_t *p_fsm_display;       /*!< Display under test */
+static fsm_buzzer_t *p_fsm_buzzer;         /*!< Buzzer under test */
+static uint32_t now_ms = 1000;             /*!< Scripted time, always moving forward */
+
+/**
+ * @brief Echo widths in ticks of 1 us: about 100 cm with one outlier, so the median discards it
+ */
+static const uint32_t echo_ticks[FSM_ULTRASOUND_NUM_MEASUREMENTS] = {5831, 5889, 5773, 11662, 5860};
+
+/* Private functions ----------------------------------------------------------*/
+/**
+ * @brief Move the scripted time forward
+ *
+ * @param ms time to advance
+ */
+static void _advance_ms(uint32_t ms)
+{
+    now_ms += ms;
+    port_system_set_millis(now_ms);
+}
+
+/**
+ * @brief A whole press of the button, debounced by the FSM: press, debounce, release and debounce
+ */
+static void _button_press(void)
+{
+    _advance_ms(BENCH_BUTTON_DEBOUNCE_MS);
+    port_button_set_pressed(PORT_PARKING_BUTTON_ID, true);
+    fsm_button_fire(p_fsm_button);
+    _advance_ms(BENCH_BUTTON_DEBOUNCE_MS + 1);
+    fsm_button_fire(p_fsm_button);
+    _advance_ms(BENCH_BUTTON_HOLD_MS);
+    port_button_set_pressed(PORT_PARKING_BUTTON_ID, false);
+    fsm_button_fire(p_fsm_button);
+    _advance_ms(BENCH_BUTTON_DEBOUNCE_MS + 1);
+    fsm_button_fire(p_fsm_button);
+}
+
+/**
+ * @brief One published distance: the trigger, the echo and the median of `FSM_ULTRASOUND_NUM_MEASUREMENTS` echoes
+ */
+static void _ultrasound_measurement(void)
+{
+    for (uint32_t i = 0; i < FSM_ULTRASOUND_NUM_MEASUREMENTS; i++)
+    {
+        port_ultrasound_set_trigger_ready(PORT_REAR_PARKING_SENSOR_ID, true);
+        fsm_ultrasound_fire(p_fsm_ultrasound);
+        port_ultrasound_set_trigger_end(PORT_REAR_PARKING_SENSOR_ID, true);
+        fsm_ultrasound_fire(p_fsm_ultrasound);
+        port_ultrasound_set_echo_init_tick(PORT_REAR_PARKING_SENSOR_ID, BENCH_ECHO_INIT_TICK);
+        fsm_ultrasound_fire(p_fsm_ultrasound);
+        port_ultrasound_set_echo_end_tick(PORT_REAR_PARKING_SENSOR_ID, BENCH_ECHO_INIT_TICK + echo_ticks[i]);
+        port_ultrasound_set_echo_overflows(PORT_REAR_PARKING_SENSOR_ID, 0);
+        port_ultrasound_set_echo_received(PORT_REAR_PARKING_SENSOR_ID, true);
+        fsm_ultrasound_fire(p_fsm_ultrasound);
+    }
+}
+
+/**
+ * @brief Switch the display on, sweep every zone from near to far and switch it off
+ */
+static void _display_sweep(void)
+{
+    fsm_display_set_status(p_fsm_display, true);
+    fsm_display_fire(p_fsm_display);
+    for (uint32_t cm = 0; cm <= BENCH_SWEEP_MAX_CM; cm += BENCH_SWEEP_STEP_CM)
+    {
+        fsm_display_set_distance(p_fsm_display, cm);
+        fsm_display_fire(p_fsm_display);
+    }
+    fsm_display_set_status(p_fsm_display, false);
+    fsm_display_fire(p_fsm_display);
+}
+
+/**
+ * @brief Switch the buzzer on, sweep every zone from near to far and switch it off
+ */
+static void _buzzer_sweep(void)
+{
+    fsm_buzzer_set_status(p_fsm_buzzer, true);
+    fsm_buzzer_fire(p_fsm_buzzer);
+    for (uint32_t cm = 0; cm <= BENCH_SWEEP_MAX_CM; cm += BENCH_SWEEP_STEP_CM)
+    {
+        fsm_buzzer_set_distance(p_fsm_buzzer, cm);
+        fsm_buzzer_fire(p_fsm_buzzer);
+    }
+    fsm_buzzer_set_status(p_fsm_buzzer, false);
+    fsm_buzzer_fire(p_fsm_buzzer);
+}
+
+int main(void)
+{
+    port_system_init();
+
+    // Same configuration as main.c
+    p_fsm_button = fsm_button_new(BENCH_BUTTON_DEBOUNCE_MS, PORT_PARKING_BUTTON_ID);
+    p_fsm_ultrasound = fsm_ultrasound_new(PORT_REAR_PARKING_SENSOR_ID);
+    p_fsm_display = fsm_display_new(PORT_REAR_PARKING_DISPLAY_ID);
+    fsm_display_set_gradient(p_fsm_display, true);
+    fsm_display_set_animations(p_fsm_display, true);
+    p_fsm_buzzer = fsm_buzzer_new(PORT_PARKING_BUZZER_ID);
+
+    bench_init();
+    bench_run("fsm_button_press", _button_press, BENCH_RUNS);
+    bench_run("fsm_ultrasound_measurement", _ultrasound_measurement, BENCH_RUNS);
+    bench_run("fsm_display_sweep", _display_sweep, BENCH_RUNS);
+    bench_run("fsm_buzzer_sweep", _buzzer_sweep, BENCH_RUNS);
+
+    fsm_button_destroy(p_fsm_button);
+    fsm_ultrasound_destroy(p_fsm_ultrasound);
+    fsm_display_destroy(p_fsm_display);
+    fsm_buzzer_destroy(p_fsm_buzzer);
+
+    exit(bench_end());
+}
@@ -0,0 +1,92 @@
+/**
+ * @file bench_port.c
+ * @brief Benchmark of the port drivers called from the FSM actions: the RGB LED, the encoding of the LED bar, the buzzer patterns and the time base.
+ *
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-22
+ */
+/* System dependent libraries */
+#include <stdlib.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_display.h"
+#include "port_ws2812.h"
+#include "port_buzzer.h"
+
+/* HW independent libraries */
+#include "bench.h"
+
+/* Defines */
+#define BENCH_RUNS 10          /*!< Runs of every scenario @hideinitializer */
+#define BENCH_TIME_READS 100   /*!< Reads of the time base per run @hideinitializer */
+
+/* Private variables ---------------------------------------------------------*/
+/**
+ * @brief Colors written to the RGB LED, the same ones the display uses for the zones
+ */
+static const rgb_color_t colors[] = {COLOR_RED, COLOR_YELLOW, COLOR_GREEN, COLOR_TURQUOISE, COLOR_BLUE, COLOR_OFF};
+
+static rgb_color_t bar_pixels[PORT_DISPLAY_BAR_NUM_LEDS];                      /*!< Frame of the LED bar */
+static uint8_t bar_buffer[PORT_WS2812_BUFFER_SIZE(PORT_DISPLAY_BAR_NUM_LEDS)]; /*!< SPI frame of the LED bar */
+static volatile uint32_t time_sink;                                            /*!< Keeps the time reads */
+
+/* Private functions ----------------------------------------------------------*/
+/**
+ * @brief Write every color to the RGB LED
+ */
+static void _display_set_rgb(void)
+{
+    for (uint32_t i = 0; i < sizeof(colors) / sizeof(colors[0]); i++)
+    {
+        port_display_set_rgb(PORT_REAR_PARKING_DISPLAY_ID, colors[i]);
+    }
+}
+
+/**
+ * @brief Encode a whole frame of the LED bar
+ */
+static void _ws2812_encode(void)
+{
+    port_ws2812_encode(bar_pixels, PORT_DISPLAY_BAR_NUM_LEDS, bar_buffer);
+}
+
+/**
+ * @brief Start a beep pattern and a continuous tone, the two kinds of pattern of the buzzer FSM
+ */
+static void _buzzer_play_pattern(void)
+{
+    port_buzzer_play_pattern(PORT_PARKING_BUZZER_ID, (buzzer_pattern_t){RE, 150, 150, PORT_BUZZER_PATTERN_FOREVER, PORT_BUZZER_VOLUME_MAX});
+    port_buzzer_play_pattern(PORT_PARKING_BUZZER_ID, (buzzer_pattern_t){DO, 0, 0, PORT_BUZZER_PATTERN_FOREVER, PORT_BUZZER_VOLUME_MAX});
+}
+
+/**
+ * @brief Read the milliseconds and the microseconds, as the scheduler and the traces do
+ */
+static void _system_time(void)
+{
+    for (uint32_t i = 0; i < BENCH_TIME_READS; i++)
+    {
+        time_sink = port_system_get_millis() + port_system_get_micros();
+    }
+}
+
+int main(void)
+{
+    port_system_init();
+    port_display_init(PORT_REAR_PARKING_DISPLAY_ID);
+    port_buzzer_init(PORT_PARKING_BUZZER_ID);
+    for (uint32_t i = 0; i < PORT_DISPLAY_BAR_NUM_LEDS; i++)
+    {
+        bar_pixels[i] = colors[i % (sizeof(colors) / sizeof(colors[0]))];
+    }
+
+    bench_init();
+    bench_run("port_display_set_rgb", _display_set_rgb, BENCH_RUNS);
+    bench_run("port_ws2812_encode", _ws2812_encode, BENCH_RUNS);
+    bench_run("port_buzzer_play_pattern", _buzzer_play_pattern, BENCH_RUNS);
+    bench_run("port_system_time", _system_time, BENCH_RUNS);
+
+    exit(bench_end());
+}
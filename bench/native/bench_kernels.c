@@ -0,0 +1,252 @@
+/**
+ * @file bench_kernels.c
+ * @brief Host benchmark of the pure computational kernels: display and buzzer levels, echo to distance, median of the echoes and PSC/ARR of the timers.
+ *
+ * Every kernel is warmed up and then timed over many repetitions with `port_system_get_cycles()` (nanoseconds on the
+ * native port). It prints one line per kernel with the statistics of the time per call, for quick A/B comparisons of a
+ * kernel change before flashing the board. An optional argument runs only the kernels whose name contains it.
+ *
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-24
+ */
+/* System dependent libraries */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* HW dependent libraries */
+#include "port_system.h"
+#include "port_display.h"
+#include "port_buzzer.h"
+#include "port_timer.h"
+
+/* HW independent libraries */
+#include "zones.h"
+#include "display_levels.h"
+#include "buzzer_levels.h"
+#include "ultrasound_echo.h"
+
+/* Defines */
+#define BENCH_WARMUP_RUNS 100   /*!< Runs of every kernel before timing it, to fill the caches and settle the clock @hideinitializer */
+#define BENCH_RUNS 1000         /*!< Timed runs of every kernel @hideinitializer */
+#define BENCH_NUM_ECHOES 1000   /*!< Echoes converted and grouped for the median per run @hideinitializer */
+#define BENCH_ECHO_GROUP 5      /*!< Echoes per median, as in the ultrasound FSM @hideinitializer */
+#define BENCH_SEED 12345U       /*!< Seed of the pseudo-random inputs, so every execution times the same data @hideinitializer */
+
+/* Typedefs --------------------------------------------------------------------*/
+/**
+ * @brief Kernel under test: its name, one run and the calls to the kernel in one run
+ */
+typedef struct
+{
+    const char *p_name;
+    void (*run)(void);
+    uint32_t calls;
+} bench_kernel_t;
+
+/* Private variables ---------------------------------------------------------*/
+/**
+ * @brief Colors of the zones, the same ones the display uses
+ */
+static const rgb_color_t zone_colors[ZONES_NUM + 1] = {COLOR_RED, COLOR_YELLOW, COLOR_GREEN, COLOR_TURQUOISE, COLOR_BLUE, COLOR_OFF};
+
+/**
+ * @brief Timer clocks of the clock profiles and periods (numerator and denominator in seconds) programmed by the drivers
+ */
+static const uint32_t timer_clocks_hz[] = {16000000, 42000000, 84000000, 90000000, 180000000};
+static const uint32_t timer_periods[][2] = {{10, 1000000}, {100, 1000}, {65536, 1000000}, {1, 50}, {1, DO}, {1, RE}, {1, MI}, {1, FA}, {1, SOL}};
+
+static rgb_color_t gradient_lut[DISPLAY_LEVELS_GRADIENT_SIZE];  /*!< Output of the gradient */
+static rgb_color_t anim_frames[PORT_DISPLAY_ANIM_MAX_FRAMES];    /*!< Output of the breathing animation */
+static uint32_t echo_ticks[BENCH_NUM_ECHOES][3];                 /*!< Rising edge, falling edge and overflows of every echo */
+static uint32_t echo_cm[BENCH_NUM_ECHOES];                       /*!< Distances of the echoes, input of the median */
+static uint32_t echo_group[BENCH_ECHO_GROUP];                    /*!< Copy of a group of echoes: the median sorts it */
+static double samples[BENCH_RUNS];                               /*!< Time per call of every timed run */
+static volatile uint32_t sink;                                   /*!< Keeps the results of the kernels */
+
+/* Private functions ----------------------------------------------------------*/
+/**
+ * @brief Pseudo-random generator (LCG), the same on every host
+ *
+ * @return next number
+ */
+static uint32_t _rand(void)
+{
+    static uint32_t state = BENCH_SEED;
+    state = state * 1664525U + 1013904223U;
+    return state >> 8;
+}
+
+/**
+ * @brief Build the echoes: a 16-bit timer that counts microseconds, with distances up to the range of the sensor
+ */
+static void _init_echoes(void)
+{
+    for (uint32_t i = 0; i < BENCH_NUM_ECHOES; i++)
+    {
+        uint32_t init = _rand() % 65536U;
+        uint32_t duration_us = _rand() % (ZONES_RANGE_MAX_CM * 58U);
+        uint32_t end = init + duration_us;
+        echo_ticks[i][0] = init;
+        echo_ticks[i][1] = end % 65536U;
+        echo_ticks[i][2] = end / 65536U;
+        echo_cm[i] = ultrasound_echo_to_cm(echo_ticks[i][0], echo_ticks[i][1], echo_ticks[i][2]);
+    }
+}
+
+/**
+ * @brief Gradient table of the display, built when the gradient is enabled and when the zones change
+ */
+static void _display_gradient(void)
+{
+    display_levels_build_gradient(gradient_lut, zone_colors);
+    sink = gradient_lut[ZONES_RANGE_MAX_CM / 2].g;
+}
+
+/**
+ * @brief Frames of the breathing animation of the danger zone, built when its color changes
+ */
+static void _display_breathe(void)
+{
+    display_levels_breathe(anim_frames, PORT_DISPLAY_ANIM_MAX_FRAMES, zone_colors[ZONE_DANGER]);
+    sink = anim_frames[PORT_DISPLAY_ANIM_MAX_FRAMES / 2].r;
+}
+
+/**
+ * @brief Pattern of the buzzer for every zone in every mode
+ */
+static void _buzzer_levels(void)
+{
+    buzzer_pattern_t pattern;
+    for (uint32_t zone = 0; zone <= ZONE_NONE; zone++)
+    {
+        for (uint32_t mode = 0; mode < 4; mode++)
+        {
+            buzzer_levels_compute(&pattern, zone, mode & 1U, mode & 2U);
+            sink = pattern.volume;
+        }
+    }
+}
+
+/**
+ * @brief Distance of every echo
+ */
+static void _echo_to_cm(void)
+{
+    for (uint32_t i = 0; i < BENCH_NUM_ECHOES; i++)
+    {
+        sink = ultrasound_echo_to_cm(echo_ticks[i][0], echo_ticks[i][1], echo_ticks[i][2]);
+    }
+}
+
+/**
+ * @brief Median of every group of echoes, as the ultrasound FSM does after each group
+ */
+static void _echo_median(void)
+{
+    for (uint32_t i = 0; i + BENCH_ECHO_GROUP <= BENCH_NUM_ECHOES; i += BENCH_ECHO_GROUP)
+    {
+        memcpy(echo_group, &echo_cm[i], sizeof(echo_group));
+        sink = ultrasound_echo_median_cm(echo_group, BENCH_ECHO_GROUP);
+    }
+}
+
+/**
+ * @brief PSC and ARR of every period of the drivers with every clock profile
+ */
+static void _timer_period(void)
+{
+    uint32_t psc, arr;
+    for (uint32_t c = 0; c < sizeof(timer_clocks_hz) / sizeof(timer_clocks_hz[0]); c++)
+    {
+        for (uint32_t p = 0; p < sizeof(timer_periods) / sizeof(timer_periods[0]); p++)
+        {
+            port_timer_compute_period(timer_clocks_hz[c], timer_periods[p][0], timer_periods[p][1], &psc, &arr);
+            sink = psc + arr;
+        }
+    }
+}
+
+/**
+ * @brief Kernels of the suite
+ */
+static const bench_kernel_t kernels[] = {
+    {"display_gradient", _display_gradient, 1},
+    {"display_breathe", _display_breathe, 1},
+    {"buzzer_levels", _buzzer_levels, (ZONE_NONE + 1) * 4},
+    {"echo_to_cm", _echo_to_cm, BENCH_NUM_ECHOES},
+    {"echo_median", _echo_median, BENCH_NUM_ECHOES / BENCH_ECHO_GROUP},
+    {"timer_period", _timer_period, (sizeof(timer_clocks_hz) / sizeof(timer_clocks_hz[0])) * (sizeof(timer_periods) / sizeof(timer_periods[0]))},
+};
+
+/**
+ * @brief Order of two samples for qsort
+ *
+ * @param a first sample
+ * @param b second sample
+ * @return negative, 0 or positive if the first one is smaller, equal or greater
+ */
+static int _compare_samples(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Warm up a kernel, time it and print the statistics of the time per call
+ *
+ * Prints one line `KERNEL <name> calls=<n> min=<ns> median=<ns> p90=<ns> mean=<ns> stddev=<ns>`.
+ *
+ * @param p_kernel kernel to run
+ */
+static void _bench_kernel(const bench_kernel_t *p_kernel)
+{
+    for (uint32_t i = 0; i < BENCH_WARMUP_RUNS; i++)
+    {
+        p_kernel->run();
+    }
+
+    double ns_per_cycle = 1000.0 / port_system_get_cycles_per_us();
+    double sum = 0.0;
+    for (uint32_t i = 0; i < BENCH_RUNS; i++)
+    {
+        uint32_t start = port_system_get_cycles();
+        p_kernel->run();
+        uint32_t cycles = port_system_get_cycles() - start;
+        samples[i] = (cycles * ns_per_cycle) / p_kernel->calls;
+        sum += samples[i];
+    }
+
+    double mean = sum / BENCH_RUNS;
+    double sum_sq = 0.0;
+    for (uint32_t i = 0; i < BENCH_RUNS; i++)
+    {
+        sum_sq += (samples[i] - mean) * (samples[i] - mean);
+    }
+    qsort(samples, BENCH_RUNS, sizeof(samples[0]), _compare_samples);
+
+    printf("KERNEL %s calls=%lu min=%.1f median=%.1f p90=%.1f mean=%.1f stddev=%.1f\n", p_kernel->p_name,
+           (unsigned long)p_kernel->calls, samples[0], samples[BENCH_RUNS / 2], samples[(BENCH_RUNS * 9) / 10], mean,
+           sqrt(sum_sq / BENCH_RUNS));
+}
+
+int main(int argc, char *argv[])
+{
+    const char *p_filter = (argc > 1) ? argv[1] : "";
+
+    port_system_init();
+    _init_echoes();
+
+    printf("KERNELS warmup=%d runs=%d (ns per call)\n", BENCH_WARMUP_RUNS, BENCH_RUNS);
+    for (uint32_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++)
+    {
+        if (strstr(kernels[i].p_name, p_filter) != NULL)
+        {
+            _bench_kernel(&kernels[i]);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file boot_timeline.h
+ * @brief Header for boot_timeline.c file. Instantes de cada etapa del arranque, desde el reset hasta la primera distancia en el display.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-23
+ */
+
+#ifndef BOOT_TIMELINE_H_
+#define BOOT_TIMELINE_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Enums */
+/**
+ * @brief Etapas del arranque, en el orden en el que se pasan
+ */
+enum BOOT_STAGES {
+	BOOT_STAGE_SYSTEM_INIT = 0, //fin de `port_system_init()`
+	BOOT_STAGE_FSM_BUTTON, //fin de `fsm_button_new()`
+	BOOT_STAGE_FSM_DISPLAY, //fin de `fsm_display_new()`
+	BOOT_STAGE_FSM_BUZZER, //fin de `fsm_buzzer_new()`
+	BOOT_STAGE_FSM_ULTRASOUND, //fin de `fsm_ultrasound_new()`
+	BOOT_STAGE_FSM_URBANITE, //fin de `fsm_urbanite_new()`
+	BOOT_STAGE_SCHEDULER, //entrada al bucle del planificador
+	BOOT_STAGE_URBANITE_ON, //primer encendido del urbanite
+	BOOT_STAGE_FIRST_DISTANCE, //primera distancia que se ve en el display
+	BOOT_STAGE_NUM
+};
+
+/* Defines */
+#define BOOT_TIMELINE_NOT_REACHED UINT32_MAX /*!< Instante de una etapa por la que todavia no se ha pasado */
+
+/**
+ * @brief Marca de una etapa. Sin `USE_BOOT_TIMELINE` no genera codigo
+ */
+#ifdef USE_BOOT_TIMELINE
+#define BOOT_TIMELINE_MARK(stage) boot_timeline_mark(stage)
+#else
+#define BOOT_TIMELINE_MARK(stage) ((void)0)
+#endif
+
+/* Function prototypes and explanation -------------------------------------------------*/
+/**
+ * @brief Apunta el instante de una etapa la primera vez que se pasa por ella
+ *
+ * Hasta `BOOT_STAGE_SYSTEM_INIT` cuenta los ciclos que lleva el contador desde `SystemInit()`, con el reloj de arranque.
+ * Desde ahi suma `port_system_get_micros()`, que sigue contando en los modos de bajo consumo en los que el urbanite
+ * espera a que lo enciendan. Al llegar a `BOOT_STAGE_FIRST_DISTANCE` registra todas las etapas con el logger.
+ *
+ * @param stage etapa de `BOOT_STAGES`
+ */
+void 	boot_timeline_mark (uint32_t stage);
+
+/**
+ * @brief Devuelve el instante de una etapa
+ *
+ * @param stage etapa de `BOOT_STAGES`
+ * @return microsegundos desde el reset, o `BOOT_TIMELINE_NOT_REACHED`
+ */
+uint32_t 	boot_timeline_get_us (uint32_t stage);
+
+#endif /* BOOT_TIMELINE_H_ */
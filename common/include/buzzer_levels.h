@@ -0,0 +1,45 @@
+/**
+ * @file buzzer_levels.h
+ * @brief Header for buzzer_levels.c file.
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutierrez Fontán
+ * @date 2025-06-24
+ */
+
+#ifndef BUZZER_LEVELS_H_
+#define BUZZER_LEVELS_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include "port_buzzer.h"
+#include "zones.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+/**
+* @brief volumen de cada zona, de 0 a `PORT_BUZZER_VOLUME_MAX`: cuanto mas cerca esta el obstaculo mas fuerte suena
+*/
+#define BUZZER_VOLUME_DANGER 100
+#define BUZZER_VOLUME_WARNING 85
+#define BUZZER_VOLUME_NO_PROBLEM 70
+#define BUZZER_VOLUME_INFO 55
+#define BUZZER_VOLUME_OK 40
+
+/**
+* @brief porcentaje del volumen de cada zona que se mantiene en modo noche
+*/
+#define BUZZER_NIGHT_VOLUME_PERCENT 40
+
+/* Function prototypes and explanation -------------------------------------------------*/
+/**
+* @brief calcula el patron con el que tiene que sonar el buzzer: la nota, el tiempo que pasa encendido y apagado en cada pitido y el volumen, que sube al acercarse el obstaculo
+* @param p_pattern patron que tiene que sonar
+* @param zone zona de la nueva medicion
+* @param pulsed si pita (true) o suena continuo (false)
+* @param night si el volumen baja a `BUZZER_NIGHT_VOLUME_PERCENT`
+*/
+void 	buzzer_levels_compute (buzzer_pattern_t *p_pattern, uint32_t zone, bool pulsed, bool night);
+
+#endif /* BUZZER_LEVELS_H_ */
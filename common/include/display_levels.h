@@ -0,0 +1,44 @@
+/**
+ * @file display_levels.h
+ * @brief Header for display_levels.c file.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-24
+ */
+
+#ifndef DISPLAY_LEVELS_H_
+#define DISPLAY_LEVELS_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include "port_display.h"
+#include "zones.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define DISPLAY_LEVELS_GAMMA 2.2 /*!< Gamma con la que se interpolan los colores en el modo degradado y se escala la respiracion */
+#define DISPLAY_LEVELS_GRADIENT_SIZE (ZONES_RANGE_MAX_CM + 1) /*!< Colores de la tabla del degradado: uno por centimetro */
+
+/* Function prototypes and explanation -------------------------------------------------*/
+/**
+ * @brief Calcula la tabla del degradado, un color por centimetro entre 0 y `ZONES_RANGE_MAX_CM`
+ *
+ * Cada color de zona se coloca en el centro de su zona (con los limites actuales de `zones.c`) y entre dos centros se
+ * interpola con correccion gamma. Antes del primer centro y despues del ultimo el color se mantiene.
+ *
+ * @param p_lut tabla de salida, de `DISPLAY_LEVELS_GRADIENT_SIZE` colores
+ * @param p_zone_colors color de cada una de las `ZONES_NUM` zonas
+ */
+void 	display_levels_build_gradient (rgb_color_t *p_lut, const rgb_color_t *p_zone_colors);
+
+/**
+ * @brief Calcula los fotogramas de la respiracion: brillo percibido senoidal, pasado a ciclo de trabajo con la gamma
+ *
+ * @param p_frames fotogramas de salida
+ * @param num_frames numero de fotogramas de un periodo
+ * @param color color con el brillo maximo
+ */
+void 	display_levels_breathe (rgb_color_t *p_frames, uint32_t num_frames, rgb_color_t color);
+
+#endif /* DISPLAY_LEVELS_H_ */
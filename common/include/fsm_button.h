@@ -16,6 +16,7 @@
 
 /* Other includes */
 #include "fsm.h"
+#include "fsm_stats.h"
 
 /* Defines and enums ----------------------------------------------------------*/
 /* Enums */
@@ -32,12 +33,26 @@ enum  	FSM_BUTTON {
 	BUTTON_PRESSED_WAIT
 };
 
+/* Defines */
+#define FSM_BUTTON_MAX_HOLD_THRESHOLDS 4 /*!< Numero maximo de umbrales de pulsacion mantenida por boton */
+
 /* Typedefs --------------------------------------------------------------------*/
 /**
  * @brief Se define la estructura fsm_button_t
  */
 typedef struct fsm_button_t fsm_button_t;
 
+#ifdef USE_FSM_STATS
+/**
+ * @brief Contadores de funcionamiento del boton
+ */
+typedef struct
+{
+	fsm_stats_t fsm; //contadores comunes, que lleva el planificador
+	uint32_t presses; //pulsaciones (flancos de bajada aceptados)
+} fsm_button_stats_t;
+#endif
+
 /* Function prototypes and explanation -------------------------------------------------*/
 /**
  * @brief Crea un nuevo boton FSM
@@ -107,6 +122,64 @@ void 	fsm_button_reset_duration (fsm_button_t *p_fsm);
  
 uint32_t 	fsm_button_get_debounce_time_ms (fsm_button_t *p_fsm);
 
+/**
+ * @brief Devuelve el instante en el que vence el tiempo de rebote en curso
+ *
+ * @param p_fsm Estructura de boton
+ * @return Instante (en ms desde el arranque) del timeout de debounce. Solo tiene sentido en los estados BUTTON_PRESSED_WAIT y BUTTON_RELEASED_WAIT
+ */
+ 
+uint32_t 	fsm_button_get_next_timeout (fsm_button_t *p_fsm);
+
+/**
+ * @brief Devuelve el siguiente plazo del boton, para que el planificador lo despierte a tiempo
+ *
+ * @param p_fsm Estructura de boton
+ * @param p_deadline_ms Donde se devuelve el instante (en ms desde el arranque) en el que vence el debounce
+ * @return true si el boton esta esperando a que venza el debounce, false si solo depende de la interrupcion (siempre con el debounce por hardware)
+ */
+bool 	fsm_button_get_next_deadline (fsm_button_t *p_fsm, uint32_t *p_deadline_ms);
+
+/**
+ * @brief Registra un umbral de pulsacion mantenida
+ *
+ * Un umbral se alcanza en cuanto el boton lleva pulsado `hold_ms`, sin esperar a que se suelte. Quien lo registra
+ * se despierta a tiempo con `fsm_button_get_next_hold_deadline()` y lo comprueba con `fsm_button_check_hold_threshold()`.
+ *
+ * @param p_fsm Estructura de boton
+ * @param hold_ms Tiempo de pulsacion (contado desde el flanco de pulsacion)
+ * @return ID del umbral, o `FSM_BUTTON_MAX_HOLD_THRESHOLDS` si ya no caben mas
+ */
+uint32_t 	fsm_button_add_hold_threshold (fsm_button_t *p_fsm, uint32_t hold_ms);
+
+/**
+ * @brief Comprueba si la pulsacion en curso (o la ultima, si ya se ha soltado) ha alcanzado un umbral que no se ha reseteado
+ *
+ * @param p_fsm Estructura de boton
+ * @param threshold_id ID del umbral
+ * @return true si se ha alcanzado el umbral
+ */
+bool 	fsm_button_check_hold_threshold (fsm_button_t *p_fsm, uint32_t threshold_id);
+
+/**
+ * @brief Marca un umbral como atendido hasta la siguiente pulsacion, igual que `fsm_button_reset_duration()` con la duracion
+ *
+ * @param p_fsm Estructura de boton
+ * @param threshold_id ID del umbral
+ */
+void 	fsm_button_reset_hold_threshold (fsm_button_t *p_fsm, uint32_t threshold_id);
+
+/**
+ * @brief Devuelve el instante en el que la pulsacion en curso alcanza el siguiente umbral pendiente
+ *
+ * @param p_fsm Estructura de boton
+ * @param p_deadline_ms Donde se devuelve el instante (en ms desde el arranque)
+ * @note Un umbral alcanzado sigue dando su plazo (ya vencido) mientras el boton este pulsado, hasta que se resetea con
+ * `fsm_button_reset_hold_threshold()`: quien lo registra tiene que resetearlo al atenderlo.
+ * @return true si el boton esta pulsado y le queda algun umbral sin resetear
+ */
+bool 	fsm_button_get_next_hold_deadline (fsm_button_t *p_fsm, uint32_t *p_deadline_ms);
+
 /**
  * @brief Comprueba si el boton esta activo
  *
@@ -115,5 +188,35 @@ uint32_t 	fsm_button_get_debounce_time_ms (fsm_button_t *p_fsm);
  */
  
 bool 	fsm_button_check_activity (fsm_button_t *p_fsm);
+
+/**
+ * @brief Activa o desactiva el debounce por hardware con el tiempo de rebote del boton
+ *
+ * Con el debounce por hardware el port solo avisa de flancos ya filtrados y marcados con su instante, asi que los
+ * estados de espera se pasan sin mirar el tiempo, el boton no tiene plazos para el planificador y la duracion de la
+ * pulsacion es la que hay entre los dos flancos, sin el retraso de dispararse despues.
+ *
+ * @param p_fsm Estructura de boton
+ * @param enable true para activarlo
+ */
+void 	fsm_button_set_hw_debounce (fsm_button_t *p_fsm, bool enable);
+
+/**
+ * @brief Devuelve si el boton usa el debounce por hardware
+ *
+ * @param p_fsm Estructura de boton
+ * @return true si esta activado
+ */
+bool 	fsm_button_get_hw_debounce (fsm_button_t *p_fsm);
  
+#ifdef USE_FSM_STATS
+/**
+ * @brief Devuelve los contadores de funcionamiento del boton. Solo existe con `USE_FSM_STATS`
+ *
+ * @param p_fsm Estructura de boton
+ * @return contadores, que se pueden poner a cero
+ */
+fsm_button_stats_t * 	fsm_button_get_stats (fsm_button_t *p_fsm);
+#endif
+
 #endif
\ No newline at end of file
@@ -13,6 +13,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "fsm.h"
+#include "fsm_stats.h"
+#include "zones.h"
+#include "buzzer_levels.h"
 /* Standard C includes */
 
 /* Defines and enums ----------------------------------------------------------*/
@@ -22,22 +25,21 @@
 */
 enum  FSM_BUZZER_SYSTEM {
   QUIETO_PARAO_BUZZER = 0,
-  PIPIPIPI_BUZZER,
-  CALLAITO_BUZZER
+  PIPIPIPI_BUZZER
 };
-/* Defines  ----------------------------------------------------------*/
-/**
-* @brief distancias a la que cambia la maquina de estados
-*/
-#define DANGER_MIN_CM 0
-#define WARNING_MIN_CM 25
-#define NO_PROBLEM_MIN_CM 50
-#define INFO_MIN_CM 150
-#define OK_MIN_CM 175
-#define OK_MAX_CM 200
-
 /* Typedefs --------------------------------------------------------------------*/
 typedef struct fsm_buzzer_t fsm_buzzer_t;
+
+#ifdef USE_FSM_STATS
+/**
+ * @brief Contadores de funcionamiento del buzzer
+ */
+typedef struct
+{
+	fsm_stats_t fsm; //contadores comunes, que lleva el planificador
+	uint32_t reconfigs; //cambios mandados al hardware: patron o silencio
+} fsm_buzzer_stats_t;
+#endif
 /* Function prototypes and explanation -------------------------------------------------*/
 
 /**
@@ -61,6 +63,7 @@ void 	fsm_buzzer_destroy (fsm_buzzer_t *p_fsm);
 /**
  * @brief Guarda la nueva distancia
  *
+ * @note La zona se busca en la tabla de zonas sin histeresis. Quien ya tenga la zona debe usar `fsm_buzzer_set_zone()`.
  * @param p_fsm fsm buzzer que va a guardar la distancia
  * 
  * @param distance_cm distancia que se guarda
@@ -68,6 +71,15 @@ void 	fsm_buzzer_destroy (fsm_buzzer_t *p_fsm);
  */
 void 	fsm_buzzer_set_distance (fsm_buzzer_t *p_fsm, uint32_t distance_cm);
 
+/**
+ * @brief Guarda la nueva distancia ya clasificada en su zona
+ *
+ * @param p_fsm fsm buzzer que va a guardar la distancia
+ * @param distance_cm distancia que se guarda
+ * @param zone zona de la distancia (ver `zones_classify()`)
+ */
+void 	fsm_buzzer_set_zone (fsm_buzzer_t *p_fsm, uint32_t distance_cm, uint32_t zone);
+
 
 /**
  * @brief Dispara la fsm del buzzer
@@ -143,7 +155,7 @@ uint32_t 	fsm_buzzer_get_distance (fsm_buzzer_t *p_fsm);
 
 
 /**
- * @brief Cambia a pulso intermitente la fsm del buzzer
+ * @brief Cambia a pulso intermitente la fsm del buzzer. Se aplica en el siguiente disparo
  *
  * @param p_fsm fsm buzzer que va a cambiar
  * 
@@ -152,11 +164,43 @@ void fsm_buzzer_pulsed_state(fsm_buzzer_t *p_fsm);
 
 
 /**
- * @brief Cambia a pulso continuo la fsm del buzzer
+ * @brief Cambia a pulso continuo la fsm del buzzer. Se aplica en el siguiente disparo
  *
  * @param p_fsm fsm buzzer que va a cambiar
  * 
  */
 void fsm_buzzer_continuous_state(fsm_buzzer_t *p_fsm);
 
+/**
+ * @brief Activa o desactiva el modo noche de la fsm del buzzer: el volumen de cada zona baja a `BUZZER_NIGHT_VOLUME_PERCENT`. Se aplica en el siguiente disparo
+ *
+ * @param p_fsm fsm buzzer que va a cambiar
+ * @param night true para el modo noche
+ */
+void 	fsm_buzzer_set_night_mode (fsm_buzzer_t *p_fsm, bool night);
+
+/**
+ * @brief Suspende el hardware del buzzer (relojes, interrupciones y pines) mientras no se usa
+ *
+ * @param p_fsm Estructura del buzzer
+ */
+void 	fsm_buzzer_suspend (fsm_buzzer_t *p_fsm);
+
+/**
+ * @brief Reanuda el hardware del buzzer suspendido con `fsm_buzzer_suspend()`
+ *
+ * @param p_fsm Estructura del buzzer
+ */
+void 	fsm_buzzer_resume (fsm_buzzer_t *p_fsm);
+
+#ifdef USE_FSM_STATS
+/**
+ * @brief Devuelve los contadores de funcionamiento del buzzer. Solo existe con `USE_FSM_STATS`
+ *
+ * @param p_fsm Estructura del buzzer
+ * @return contadores, que se pueden poner a cero
+ */
+fsm_buzzer_stats_t * 	fsm_buzzer_get_stats (fsm_buzzer_t *p_fsm);
+#endif
+
 #endif /* FSM_BUZZER_SYSTEM_H_ */
@@ -13,6 +13,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "fsm.h"
+#include "fsm_stats.h"
+#include "zones.h"
 /* Standard C includes */
 
 /* Defines and enums ----------------------------------------------------------*/
@@ -25,17 +27,24 @@ enum  FSM_DISPLAY_SYSTEM {
   SET_DISPLAY
 };
 /* Defines  ----------------------------------------------------------*/
-/**
-* @brief distancia a las que cambia la máquina de estados
-*/
-#define DANGER_MIN_CM 0
-#define WARNING_MIN_CM 25
-#define NO_PROBLEM_MIN_CM 50
-#define INFO_MIN_CM 150
-#define OK_MIN_CM 175
-#define OK_MAX_CM 200
+#define FSM_DISPLAY_BLINK_MIN_MS 200 /*!< Periodo de parpadeo en el limite de la zona de peligro */
+#define FSM_DISPLAY_BLINK_MAX_MS 2000 /*!< Periodo de parpadeo al final de la zona `ZONE_OK` */
+#define FSM_DISPLAY_BLINK_STEP_MS 100 /*!< El periodo de parpadeo cambia en pasos de este tamaño para no reiniciar la animacion en cada medida */
+#define FSM_DISPLAY_BREATHE_MS 1000 /*!< Periodo de la respiracion en la zona de peligro */
+#define FSM_DISPLAY_SWEEP_MS 1000 /*!< Duracion del barrido de colores al encender */
 /* Typedefs --------------------------------------------------------------------*/
 typedef struct fsm_display_t fsm_display_t;
+
+#ifdef USE_FSM_STATS
+/**
+ * @brief Contadores de funcionamiento del display
+ */
+typedef struct
+{
+	fsm_stats_t fsm; //contadores comunes, que lleva el planificador
+	uint32_t reconfigs; //cambios mandados al hardware: color, animacion o barra de LEDs
+} fsm_display_stats_t;
+#endif
 /* Function prototypes and explanation -------------------------------------------------*/
 
 /**
@@ -57,11 +66,21 @@ void 	fsm_display_destroy (fsm_display_t *p_fsm);
 /**
  * @brief Configura el sistema de visualización para mostrar la distancia en cm.
  *
+ * @note La zona se busca en la tabla de zonas sin histeresis. Quien ya tenga la zona debe usar `fsm_display_set_zone()`.
  * @param p_fsm objeto fsm display
  * @param distance_cm distancia en centimetros del ultrasound
  */
 void 	fsm_display_set_distance (fsm_display_t *p_fsm, uint32_t distance_cm);
 
+/**
+ * @brief Configura el sistema de visualización para mostrar una distancia ya clasificada en su zona.
+ *
+ * @param p_fsm objeto fsm display
+ * @param distance_cm distancia en centimetros del ultrasound
+ * @param zone zona de la distancia (ver `zones_classify()`)
+ */
+void 	fsm_display_set_zone (fsm_display_t *p_fsm, uint32_t distance_cm, uint32_t zone);
+
 /**
  * @brief Inicializa el display
  *
@@ -126,4 +145,83 @@ void 	fsm_display_set_state (fsm_display_t *p_fsm, int8_t state);
  */
 uint32_t 	fsm_display_get_distance (fsm_display_t *p_fsm);
 
+/**
+ * @brief Activa o desactiva el modo degradado del display
+ *
+ * En modo degradado el color no salta entre los cinco colores de zona: se interpola con correccion gamma entre
+ * los centros de las zonas, con una tabla de un color por centimetro (0 a `ZONES_RANGE_MAX_CM`) calculada al activarlo
+ * y cada vez que cambian los limites de las zonas.
+ * Fuera de ese rango el display se apaga igual que en el modo por zonas.
+ *
+ * @param p_fsm Estructura del display
+ * @param gradient true para el modo degradado, false para el modo por zonas (el de arranque)
+ */
+void 	fsm_display_set_gradient (fsm_display_t *p_fsm, bool gradient);
+
+/**
+ * @brief Devuelve si el display esta en modo degradado
+ *
+ * @param p_fsm Estructura del display
+ * @return Si el display esta en modo degradado
+ */
+bool 	fsm_display_get_gradient (fsm_display_t *p_fsm);
+
+/**
+ * @brief Muestra la distancia en la barra de LEDs direccionables en lugar de en el LED RGB
+ *
+ * La barra enciende mas LEDs cuanto mas cerca esta el obstaculo (uno al final de `ZONE_OK` y todos a 0 cm), todos del
+ * color de la distancia (por zonas o degradado). Fuera de rango la barra se apaga. Con la barra no hay animaciones.
+ *
+ * @param p_fsm Estructura del display
+ * @param bar true para la barra (inicializa su hardware y apaga el LED RGB), false para el LED RGB (el de arranque)
+ */
+void 	fsm_display_set_bar (fsm_display_t *p_fsm, bool bar);
+
+/**
+ * @brief Activa o desactiva las animaciones del display
+ *
+ * Con animaciones el display hace un barrido por los colores de las zonas al encenderse el urbanite (`fsm_display_request_sweep()`), respira en la zona de peligro
+ * y parpadea en el resto de zonas mas rapido cuanto mas cerca esta el obstaculo. Las animaciones las reproduce el
+ * hardware (`port_display_animate()`): la FSM solo las cambia cuando cambia la zona o el periodo.
+ *
+ * @param p_fsm Estructura del display
+ * @param animations true para activar las animaciones, false para color fijo (el de arranque)
+ */
+void 	fsm_display_set_animations (fsm_display_t *p_fsm, bool animations);
+
+/**
+ * @brief Pide el barrido de encendido para la proxima vez que se encienda el display
+ *
+ * Solo tiene efecto con animaciones. Lo pide el urbanite al encenderse: al quitar la pausa o al volver a encender
+ * el display por peligro estando en pausa no se repite, para no tapar la distancia. Una distancia en la zona de
+ * peligro corta el barrido.
+ *
+ * @param p_fsm Estructura del display
+ */
+void 	fsm_display_request_sweep (fsm_display_t *p_fsm);
+
+/**
+ * @brief Suspende el hardware del display (relojes, interrupciones y pines) mientras no se usa
+ *
+ * @param p_fsm Estructura del display
+ */
+void 	fsm_display_suspend (fsm_display_t *p_fsm);
+
+/**
+ * @brief Reanuda el hardware del display suspendido con `fsm_display_suspend()`
+ *
+ * @param p_fsm Estructura del display
+ */
+void 	fsm_display_resume (fsm_display_t *p_fsm);
+
+#ifdef USE_FSM_STATS
+/**
+ * @brief Devuelve los contadores de funcionamiento del display. Solo existe con `USE_FSM_STATS`
+ *
+ * @param p_fsm Estructura del display
+ * @return contadores, que se pueden poner a cero
+ */
+fsm_display_stats_t * 	fsm_display_get_stats (fsm_display_t *p_fsm);
+#endif
+
 #endif /* FSM_DISPLAY_SYSTEM_H_ */
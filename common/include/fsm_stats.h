@@ -0,0 +1,60 @@
+/**
+ * @file fsm_stats.h
+ * @brief Header for fsm_stats.c file. Contadores de funcionamiento comunes a todas las FSM: disparos, transiciones tomadas, guardas evaluadas y tiempo en cada estado.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-21
+ */
+
+#ifndef FSM_STATS_H_
+#define FSM_STATS_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include "fsm.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define FSM_STATS_MAX_STATES 8 /*!< Estados con tiempo propio. Los de mas no se cuentan */
+#define FSM_STATS_MAX_EDGES 16 /*!< Transiciones de la tabla con contador propio. Las de mas no se cuentan */
+
+/**
+ * @brief Suma uno a un contador de las estadisticas de una FSM. Sin `USE_FSM_STATS` no genera codigo
+ */
+#ifdef USE_FSM_STATS
+#define FSM_STATS_INC(p_fsm, counter) ((p_fsm)->stats.counter++)
+#else
+#define FSM_STATS_INC(p_fsm, counter) ((void)0)
+#endif
+
+/* Typedefs --------------------------------------------------------------------*/
+/**
+ * @brief Contadores comunes de una FSM. Los lleva el planificador, que es el que dispara las FSM
+ */
+typedef struct
+{
+	uint32_t fires; //disparos
+	uint32_t guard_evals; //guardas evaluadas, segun el orden de la tabla
+	uint32_t edges[FSM_STATS_MAX_EDGES]; //veces que se ha tomado cada transicion, por su indice en la tabla
+	uint32_t state_ms[FSM_STATS_MAX_STATES]; //milisegundos en cada estado hasta el ultimo disparo
+	uint32_t last_fire_ms; //instante del ultimo disparo
+} fsm_stats_t;
+
+/* Function prototypes and explanation -------------------------------------------------*/
+/**
+ * @brief Apunta un disparo de una FSM.
+ *
+ * `fsm_fire()` evalua en orden las guardas del estado de origen hasta la primera que se cumple, asi que la
+ * transicion tomada es la primera de la tabla del estado de origen al de destino y las guardas evaluadas son las
+ * del estado de origen hasta ella (todas si no se ha movido). El tiempo desde el disparo anterior se suma al estado de origen.
+ *
+ * @note Si no se toma una transicion de un estado a si mismo que existe en la tabla, se cuenta como tomada.
+ * @param p_stats contadores de la FSM
+ * @param p_fsm FSM ya disparada
+ * @param from_state estado antes del disparo
+ * @param now_ms instante del disparo
+ */
+void 	fsm_stats_fire (fsm_stats_t *p_stats, const fsm_t *p_fsm, int32_t from_state, uint32_t now_ms);
+
+#endif /* FSM_STATS_H_ */
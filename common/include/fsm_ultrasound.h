@@ -15,12 +15,15 @@
 #include <stdbool.h>
 
 #include "fsm.h"
+#include "fsm_stats.h"
 /* Defines and enums ----------------------------------------------------------*/
 /** 
  * @brief Numero de medidas del ultrasonidos
 */
 
 #define 	FSM_ULTRASOUND_NUM_MEASUREMENTS   5
+#define 	FSM_ULTRASOUND_MAX_RANGE_CM   400 /*!< Alcance del HC-SR04. Un eco mas largo es que no ha vuelto */
+#define 	FSM_ULTRASOUND_OUTLIER_CM   20 /*!< Distancia a la mediana a partir de la que un eco se cuenta como atipico */
 
 /**
  * @brief Estados de la maquina de estados
@@ -45,6 +48,20 @@ enum  FSM_ULTRASOUND {
 
 typedef struct fsm_ultrasound_t fsm_ultrasound_t;
 
+#ifdef USE_FSM_STATS
+/**
+ * @brief Contadores de funcionamiento del ultrasonidos
+ */
+typedef struct
+{
+	fsm_stats_t fsm; //contadores comunes, que lleva el planificador
+	uint32_t echoes; //ecos medidos
+	uint32_t measurements; //medidas publicadas (la mediana de cada `FSM_ULTRASOUND_NUM_MEASUREMENTS` ecos)
+	uint32_t echo_timeouts; //ecos mas largos que el alcance del sensor: el HC-SR04 da un pulso de unos 38 ms cuando no vuelve el eco
+	uint32_t outliers; //ecos descartados por la mediana a mas de `FSM_ULTRASOUND_OUTLIER_CM` de ella
+} fsm_ultrasound_stats_t;
+#endif
+
 /* Function prototypes and explanation -------------------------------------------------*/
 
 /**
@@ -168,4 +185,28 @@ void 	fsm_ultrasound_set_state (fsm_ultrasound_t *p_fsm, int8_t state);
  
 bool 	fsm_ultrasound_check_activity (fsm_ultrasound_t *p_fsm);
 
+/**
+ * @brief Suspende el hardware del ultrasonidos (relojes, interrupciones y pines) mientras no se usa
+ *
+ * @param p_fsm Estructura de ultrasonidos
+ */
+void 	fsm_ultrasound_suspend (fsm_ultrasound_t *p_fsm);
+
+/**
+ * @brief Reanuda el hardware del ultrasonidos suspendido con `fsm_ultrasound_suspend()`
+ *
+ * @param p_fsm Estructura de ultrasonidos
+ */
+void 	fsm_ultrasound_resume (fsm_ultrasound_t *p_fsm);
+
+#ifdef USE_FSM_STATS
+/**
+ * @brief Devuelve los contadores de funcionamiento del ultrasonidos. Solo existe con `USE_FSM_STATS`
+ *
+ * @param p_fsm Estructura del ultrasonidos
+ * @return contadores, que se pueden poner a cero
+ */
+fsm_ultrasound_stats_t * 	fsm_ultrasound_get_stats (fsm_ultrasound_t *p_fsm);
+#endif
+
 #endif /* FSM_ULTRASOUND_H_ */
@@ -17,6 +17,7 @@
 #include "fsm_display.h"
 #include "fsm_buzzer.h"
 #include "fsm_ultrasound.h"
+#include "fsm_stats.h"
 
 /* Defines and enums ----------------------------------------------------------*/
 /**
@@ -59,6 +60,19 @@
  */
  typedef struct fsm_urbanite_t 	fsm_urbanite_t;
 
+#ifdef USE_FSM_STATS
+/**
+ * @brief Contadores de funcionamiento del urbanite
+ */
+typedef struct
+{
+	fsm_stats_t fsm; //contadores comunes, que lleva el planificador
+	uint32_t switch_ons; //encendidos
+	uint32_t mode_changes; //cambios de modo del display con una pulsacion corta
+	uint32_t distances; //distancias pasadas al display y al buzzer
+} fsm_urbanite_stats_t;
+#endif
+
 /* Function prototypes and explanation -------------------------------------------------*/
 /**
 * @brief crea un nuevo fsm urbanite
@@ -86,5 +100,33 @@ void 	fsm_urbanite_fire (fsm_urbanite_t *p_fsm);
 */
 void 	fsm_urbanite_destroy (fsm_urbanite_t *p_fsm);
 
+/**
+* @brief devuelve el fsm_t del urbanite
+* @param p_fsm fsm urbanite
+* @return fsm_t del urbanite
+*/
+fsm_t * 	fsm_urbanite_get_inner_fsm (fsm_urbanite_t *p_fsm);
+
+/**
+* @brief devuelve el siguiente plazo del urbanite: el instante en el que el boton llega al tiempo de encendido o apagado
+* @note asi el planificador despierta al urbanite mientras el boton sigue pulsado, sin esperar a que se suelte. El urbanite
+* atiende el plazo en cuanto vence en todos sus estados (desde SLEEP_WHILE_ON pasa a MEASURE para apagarse), asi que
+* un plazo vencido no se devuelve mas de una pasada del planificador
+* @param p_fsm fsm urbanite
+* @param p_deadline_ms donde se devuelve el instante (en ms desde el arranque)
+* @return true si el boton esta pulsado y todavia no se ha atendido el tiempo de encendido o apagado
+*/
+bool 	fsm_urbanite_get_next_deadline (fsm_urbanite_t *p_fsm, uint32_t *p_deadline_ms);
+
+
+#ifdef USE_FSM_STATS
+/**
+ * @brief Devuelve los contadores de funcionamiento del urbanite. Solo existe con `USE_FSM_STATS`
+ *
+ * @param p_fsm fsm urbanite
+ * @return contadores, que se pueden poner a cero
+ */
+fsm_urbanite_stats_t * 	fsm_urbanite_get_stats (fsm_urbanite_t *p_fsm);
+#endif
 
 #endif /* FSM_URBANITE_H_ */
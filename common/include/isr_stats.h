@@ -0,0 +1,109 @@
+/**
+ * @file isr_stats.h
+ * @brief Header for isr_stats.c file. Histogramas logaritmicos de la latencia, la duracion y el tiempo expropiado de cada rutina de interrupcion.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-19
+ */
+
+#ifndef ISR_STATS_H_
+#define ISR_STATS_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdio.h>
+#include "trace.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define ISR_STATS_BUCKETS 20 /*!< Cubetas de cada histograma: la cubeta b tiene los valores de 2^(b-1) a 2^b - 1 ciclos; la ultima, el resto */
+#define ISR_STATS_MAX_NESTING 4 /*!< Niveles de anidamiento que se distinguen. El ultimo incluye los mas profundos */
+#define ISR_STATS_LATENCY_UNKNOWN UINT32_MAX /*!< Latencia de una rutina sin un contador que marque el evento */
+
+/**
+ * @brief Macros de las rutinas de interrupcion. Sin `USE_ISR_STATS` no generan codigo
+ */
+#ifdef USE_ISR_STATS
+#define ISR_STATS_ENTER(isr_id, latency_cycles) isr_stats_enter((isr_id), (latency_cycles))
+#define ISR_STATS_EXIT(isr_id) isr_stats_exit(isr_id)
+#else
+#define ISR_STATS_ENTER(isr_id, latency_cycles) ((void)0)
+#define ISR_STATS_EXIT(isr_id) ((void)0)
+#endif
+
+/* Typedefs --------------------------------------------------------------------*/
+/**
+ * @brief Histograma logaritmico de un valor en ciclos del nucleo
+ */
+typedef struct
+{
+	uint32_t count; //valores registrados
+	uint32_t min; //valor minimo
+	uint32_t max; //valor maximo
+	uint64_t sum; //suma de los valores, para la media
+	uint32_t buckets[ISR_STATS_BUCKETS]; //valores en cada cubeta, ver `isr_stats_bucket()`
+} isr_stats_hist_t;
+
+/**
+ * @brief Estadisticas de una rutina de interrupcion
+ */
+typedef struct
+{
+	isr_stats_hist_t latency; //ciclos desde el evento del periferico hasta la entrada en la rutina
+	isr_stats_hist_t duration; //ciclos de la propia rutina, sin los de las que la expropian
+	isr_stats_hist_t preempted; //ciclos de las rutinas que la han expropiado, en las ejecuciones expropiadas
+	uint32_t nesting[ISR_STATS_MAX_NESTING]; //ejecuciones segun las rutinas activas al entrar (0: desde el programa principal)
+	uint32_t stack_min_sp; //direccion mas baja de la pila al entrar (0 si no ha entrado nunca). La pila crece hacia abajo
+} isr_stats_t;
+
+/* Function prototypes and explanation -------------------------------------------------*/
+/**
+ * @brief Devuelve la cubeta de un valor: el numero de bits significativos, limitado a la ultima cubeta
+ *
+ * @param value valor en ciclos
+ * @return cubeta, de 0 (valor 0) a `ISR_STATS_BUCKETS` - 1
+ */
+static inline uint32_t 	isr_stats_bucket (uint32_t value){
+	uint32_t bucket = (value == 0) ? 0 : 32U - (uint32_t)__builtin_clz(value);
+	return (bucket < ISR_STATS_BUCKETS) ? bucket : ISR_STATS_BUCKETS - 1U;
+}
+
+/**
+ * @brief Marca la entrada en una rutina de interrupcion. Se llama lo primero en la rutina
+ *
+ * @param isr_id `TRACE_ISRS`
+ * @param latency_cycles ciclos desde el evento, o `ISR_STATS_LATENCY_UNKNOWN` si no se pueden medir
+ */
+void 	isr_stats_enter (uint8_t isr_id, uint32_t latency_cycles);
+
+/**
+ * @brief Marca la salida de la rutina de interrupcion activa. Se llama lo ultimo en la rutina
+ *
+ * @note Las rutinas anidadas salen en orden inverso al de entrada, asi que la que sale es la ultima que entro.
+ * @param isr_id `TRACE_ISRS`
+ */
+void 	isr_stats_exit (uint8_t isr_id);
+
+/**
+ * @brief Devuelve las estadisticas de una rutina
+ *
+ * @param isr_id `TRACE_ISRS`
+ * @return estadisticas, o NULL si la rutina no existe
+ */
+const isr_stats_t * 	isr_stats_get (uint8_t isr_id);
+
+/**
+ * @brief Vacia las estadisticas de todas las rutinas
+ */
+void 	isr_stats_reset (void);
+
+/**
+ * @brief Escribe una tabla con las estadisticas de cada rutina y sus histogramas en microsegundos, y la pila que habia
+ * usada en el peor caso al entrar en cada una. La pila de la propia rutina se suma aparte (`-fstack-usage`)
+ *
+ * @param p_file fichero de salida
+ */
+void 	isr_stats_dump (FILE *p_file);
+
+#endif /* ISR_STATS_H_ */
@@ -0,0 +1,111 @@
+/**
+ * @file logger.h
+ * @brief Header for logger.c file. Registro diferido en binario: las acciones de las FSM solo copian unas palabras a un buffer circular en RAM y el texto se saca en los ratos libres.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-16
+ */
+
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define LOGGER_LEVEL_DEBUG 0 /*!< Detalle para depurar */
+#define LOGGER_LEVEL_INFO 1 /*!< Cambios de estado del sistema */
+#define LOGGER_LEVEL_WARN 2 /*!< Situaciones anomalas que el sistema supera */
+#define LOGGER_LEVEL_ERROR 3 /*!< Fallos */
+#define LOGGER_LEVEL_NONE 4 /*!< Sin registros */
+
+#ifndef LOGGER_LEVEL
+#define LOGGER_LEVEL LOGGER_LEVEL_INFO /*!< Nivel minimo que se compila. Los registros de nivel menor desaparecen del binario. Se cambia con `-DLOG_LEVEL=<n>` en CMake */
+#endif
+
+#define LOGGER_BUFFER_WORDS 256 /*!< Palabras del buffer circular (potencia de 2) */
+#define LOGGER_MAX_ARGS 6 /*!< Argumentos maximos por registro */
+#define LOGGER_MAGIC 0xA5U /*!< Byte alto de la cabecera de cada registro, para resincronizar el decodificador */
+#define LOGGER_HEADER_WORDS 2 /*!< Palabras de cada registro antes de los argumentos: la cabecera y la direccion del formato */
+
+/**
+ * @brief Cabecera de un registro: el byte magico, el nivel y el numero de argumentos
+ */
+#define LOGGER_HEADER(level, num_args) ((LOGGER_MAGIC << 24) | ((uint32_t)(level) << 8) | (uint32_t)(num_args))
+
+/**
+ * @brief Guarda un registro. El formato se queda en la flash y el registro solo lleva su direccion y los argumentos,
+ * que tienen que ser enteros de 32 bits (sin `%s` ni `%f`)
+ */
+#define _LOGGER_RECORD(level, fmt, ...) do { \
+		static const char _logger_fmt[] = fmt; \
+		const uint32_t _logger_args[] = {0, ##__VA_ARGS__}; \
+		logger_write((level), _logger_fmt, &_logger_args[1], (sizeof(_logger_args) / sizeof(_logger_args[0])) - 1U); \
+	} while (0)
+
+#if LOGGER_LEVEL <= LOGGER_LEVEL_DEBUG
+#define LOGGER_DEBUG(fmt, ...) _LOGGER_RECORD(LOGGER_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOGGER_DEBUG(fmt, ...) ((void)0)
+#endif
+
+#if LOGGER_LEVEL <= LOGGER_LEVEL_INFO
+#define LOGGER_INFO(fmt, ...) _LOGGER_RECORD(LOGGER_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOGGER_INFO(fmt, ...) ((void)0)
+#endif
+
+#if LOGGER_LEVEL <= LOGGER_LEVEL_WARN
+#define LOGGER_WARN(fmt, ...) _LOGGER_RECORD(LOGGER_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOGGER_WARN(fmt, ...) ((void)0)
+#endif
+
+#if LOGGER_LEVEL <= LOGGER_LEVEL_ERROR
+#define LOGGER_ERROR(fmt, ...) _LOGGER_RECORD(LOGGER_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOGGER_ERROR(fmt, ...) ((void)0)
+#endif
+
+/* Function prototypes and explanation -------------------------------------------------*/
+/**
+ * @brief Copia un registro al buffer circular. Se usa a traves de `LOGGER_DEBUG()`, `LOGGER_INFO()`, `LOGGER_WARN()` y `LOGGER_ERROR()`
+ *
+ * @note Solo se puede llamar desde el bucle principal, no desde las rutinas de interrupcion.
+ * @param level nivel del registro
+ * @param p_fmt formato tipo `printf`, guardado en la flash
+ * @param p_args argumentos
+ * @param num_args numero de argumentos (como mucho `LOGGER_MAX_ARGS`; los que sobran se descartan)
+ * @return false si el registro no cabe; entonces se descarta y se cuenta como perdido
+ */
+bool 	logger_write (uint32_t level, const char *p_fmt, const uint32_t *p_args, uint32_t num_args);
+
+/**
+ * @brief Saca del buffer el registro mas antiguo
+ *
+ * @param p_words donde se copia el registro: la cabecera, la direccion del formato y los argumentos
+ * @param max_words palabras que caben en `p_words`
+ * @return palabras del registro, o 0 si no hay ninguno o no cabe
+ */
+uint32_t 	logger_read (uint32_t *p_words, uint32_t max_words);
+
+/**
+ * @brief Devuelve los registros perdidos por no caber en el buffer desde la ultima llamada, y pone la cuenta a 0
+ *
+ * @return registros perdidos
+ */
+uint32_t 	logger_take_dropped (void);
+
+/**
+ * @brief Vacia el buffer. Se llama en los ratos libres, antes de dormir.
+ *
+ * Con `LOGGER_BINARY` (por defecto) cada registro sale tal cual por `port_system_log_write()`, sin parar el nucleo, y
+ * el texto lo reconstruye en el ordenador `tools/log_decode.py` a partir del ELF. Sin el, cada registro se imprime con
+ * `printf` y su formato, que con semihosting para el nucleo en cada registro.
+ */
+void 	logger_flush (void);
+
+#endif /* LOGGER_H_ */
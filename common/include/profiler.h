@@ -0,0 +1,71 @@
+/**
+ * @file profiler.h
+ * @brief Header for profiler.c file. Perfilador estadistico: histograma de las direcciones de programa interrumpidas por una interrupcion periodica.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-20
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define PROFILER_HZ 997 /*!< Frecuencia de muestreo por defecto: primo, para no ir al paso de los periodos en milisegundos de las FSM */
+#define PROFILER_BUCKET_SHIFT 5 /*!< Cada intervalo del histograma son 2^5 = 32 bytes de programa */
+#define PROFILER_BUCKETS 4096 /*!< Intervalos del histograma: cubren 128 KB de programa desde el inicio de la flash */
+#define PROFILER_MAGIC 0x464F5250U /*!< "PROF": marca el histograma en un volcado de la memoria */
+
+/* Typedefs --------------------------------------------------------------------*/
+/**
+ * @brief Histograma del perfilador. Todo en una estructura para poder volcarlo desde el depurador con
+ * `dump binary value profile.bin profiler_hist` y leerlo con `tools/profile_report.py`
+ */
+typedef struct
+{
+	uint32_t magic; //`PROFILER_MAGIC`
+	uint32_t code_base; //direccion del primer intervalo
+	uint32_t bucket_shift; //`PROFILER_BUCKET_SHIFT`
+	uint32_t num_buckets; //`PROFILER_BUCKETS`
+	uint32_t samples; //muestras tomadas
+	uint32_t out_of_range; //muestras fuera de los intervalos (codigo en RAM o mas alla de los 128 KB)
+	uint32_t buckets[PROFILER_BUCKETS]; //muestras en cada intervalo
+} profiler_hist_t;
+
+/* Function prototypes and explanation -------------------------------------------------*/
+/**
+ * @brief Vacia el histograma y arranca el muestreo
+ *
+ * @param hz frecuencia de muestreo, p. ej. `PROFILER_HZ`
+ */
+void 	profiler_start (uint32_t hz);
+
+/**
+ * @brief Para el muestreo. El histograma se conserva
+ */
+void 	profiler_stop (void);
+
+/**
+ * @brief Suma una muestra al histograma. La llama la rutina de interrupcion del perfilador
+ *
+ * @param pc direccion de la instruccion interrumpida
+ */
+void 	profiler_sample (uint32_t pc);
+
+/**
+ * @brief Vacia el histograma
+ */
+void 	profiler_reset (void);
+
+/**
+ * @brief Devuelve el histograma
+ *
+ * @return histograma
+ */
+const profiler_hist_t * 	profiler_get_hist (void);
+
+#endif /* PROFILER_H_ */
@@ -0,0 +1,82 @@
+/**
+ * @file scheduler.h
+ * @brief Header for scheduler.c file.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-02
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Other includes */
+#include "fsm.h"
+#include "fsm_stats.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define SCHEDULER_MAX_TASKS 8	  /*!< Numero maximo de FSM que se pueden registrar */
+#define SCHEDULER_MAX_SWEEPS 8	  /*!< Numero maximo de pasadas por ronda. Si se alcanza, la siguiente ronda empieza sin dormir */
+
+/* Typedefs --------------------------------------------------------------------*/
+/**
+ * @brief Funcion que devuelve el siguiente plazo de una FSM
+ *
+ * @param p_fsm FSM de la tarea
+ * @param p_deadline_ms Donde se devuelve el plazo (en ms desde el arranque)
+ * @return true si la FSM tiene un plazo pendiente, false si solo depende de eventos
+ */
+typedef bool (*scheduler_deadline_func_t)(fsm_t *p_fsm, uint32_t *p_deadline_ms);
+
+/* Function prototypes and explanation -------------------------------------------------*/
+/**
+ * @brief Registra una FSM en el planificador
+ *
+ * Una FSM se dispara cuando se publica alguno de los eventos de `events_in`, cuando vence su plazo o cuando
+ * en su ultimo disparo ha cambiado de estado (puede tener otra transicion habilitada).
+ * Los eventos del hardware son los `PORT_SYSTEM_EVENT_*`; el resto de bits son eventos software entre FSM.
+ *
+ * @param p_fsm FSM a disparar
+ * @param priority Prioridad. En cada pasada se disparan las FSM pendientes de menor a mayor valor
+ * @param events_in Eventos que hacen que la FSM tenga que dispararse
+ * @param events_out_always Eventos que se publican cada vez que se dispara la FSM (p. ej. porque sus transiciones sobre el mismo estado dan ordenes a otras FSM)
+ * @param events_out_on_change Eventos que se publican solo cuando la FSM cambia de estado
+ * @param get_deadline Funcion que devuelve el siguiente plazo de la FSM, o NULL si solo depende de eventos
+ * @return true si se ha registrado, false si ya hay `SCHEDULER_MAX_TASKS` FSM
+ */
+bool 	scheduler_add_task (fsm_t *p_fsm, uint8_t priority, uint32_t events_in, uint32_t events_out_always, uint32_t events_out_on_change, scheduler_deadline_func_t get_deadline);
+
+#ifdef USE_FSM_STATS
+/**
+ * @brief Asocia a una FSM ya registrada los contadores comunes que se actualizan en cada disparo
+ * @param p_fsm FSM registrada con `scheduler_add_task()`
+ * @param p_stats contadores de la FSM, p. ej. el campo `fsm` de lo que devuelve su `*_get_stats()`
+ * @return false si la FSM no esta registrada
+ */
+bool 	scheduler_set_stats (fsm_t *p_fsm, fsm_stats_t *p_stats);
+#endif
+
+/**
+ * @brief Elige el modo en el que duerme el planificador cuando no queda ninguna FSM pendiente
+ *
+ * @note Con un plazo pendiente se duerme siempre en modo Sleep, porque los timers no cuentan en modo Stop.
+ * @param enable true para dormir en modo Stop (`port_system_deep_sleep()`), false para dormir en modo Sleep
+ */
+void 	scheduler_set_deep_sleep (bool enable);
+
+/**
+ * @brief Ejecuta una ronda del planificador
+ *
+ * Recoge los eventos del hardware, dispara por orden de prioridad las FSM que tienen algo que hacer (repitiendo
+ * pasadas mientras alguna cambie de estado) y, si ya no queda ninguna pendiente, saca los registros del logger,
+ * programa el despertar con el plazo mas proximo y duerme hasta el siguiente evento. Es el unico sitio donde se
+ * duerme: las FSM no duermen en sus acciones.
+ */
+void 	scheduler_run (void);
+
+#endif /* SCHEDULER_H_ */
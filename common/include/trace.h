@@ -0,0 +1,143 @@
+/**
+ * @file trace.h
+ * @brief Header for trace.c file. Traza de los disparos de las FSM y de las interrupciones en un buffer circular en RAM, exportable al formato de trazas de Chrome/Perfetto.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-18
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdio.h>
+#include "fsm.h"
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Enums */
+/**
+* @brief tipos de registro de la traza
+*/
+enum TRACE_TYPES {
+  TRACE_TYPE_FSM = 0, /*!< Disparo de una FSM, con su duracion */
+  TRACE_TYPE_ISR_ENTER, /*!< Entrada en una rutina de interrupcion */
+  TRACE_TYPE_ISR_EXIT, /*!< Salida de una rutina de interrupcion */
+};
+
+/**
+* @brief rutinas de interrupcion que se marcan en la traza
+*/
+enum TRACE_ISRS {
+  TRACE_ISR_TIM11 = 0, /*!< Base de tiempos */
+  TRACE_ISR_EXTI15_10, /*!< Boton */
+  TRACE_ISR_TIM10, /*!< Fin del debounce del boton */
+  TRACE_ISR_TIM2, /*!< Eco del ultrasonidos */
+  TRACE_ISR_TIM3, /*!< Trigger del ultrasonidos */
+  TRACE_ISR_TIM5, /*!< Tiempo entre medidas del ultrasonidos */
+  TRACE_ISR_NUM
+};
+
+/* Defines */
+#define TRACE_BUFFER_RECORDS 256 /*!< Registros del buffer circular (potencia de 2). Se quedan los mas recientes */
+#define TRACE_MAGIC 0x54524345U /*!< "TRCE": marca el buffer en un volcado de la memoria */
+#define TRACE_GUARD_NONE 0xFFU /*!< Disparo sin ninguna transicion de la tabla entre los dos estados */
+#define TRACE_GUARD_UNKNOWN 0xFEU /*!< Disparo en el que no se puede saber que transicion se ha tomado: de un estado al mismo o con varias transiciones entre los dos estados */
+#define TRACE_MAX_FSMS 8 /*!< FSM con nombre en la exportacion */
+
+/**
+ * @brief Macros de las rutinas de interrupcion, del planificador y de `main.c`. Sin `USE_TRACE` no generan codigo
+ */
+#ifdef USE_TRACE
+#define TRACE_ISR_ENTER(isr_id) trace_record(TRACE_TYPE_ISR_ENTER, (isr_id))
+#define TRACE_ISR_EXIT(isr_id) trace_record(TRACE_TYPE_ISR_EXIT, (isr_id))
+#define TRACE_FSM_BEGIN(start_us) uint32_t start_us = port_system_get_micros()
+#define TRACE_FSM_END(fsm_id, start_us, p_fsm, from_state) trace_fsm_fire((fsm_id), (start_us), (p_fsm), (from_state))
+#define TRACE_SET_FSM_NAME(fsm_id, p_name) trace_set_fsm_name((fsm_id), (p_name))
+#else
+#define TRACE_ISR_ENTER(isr_id) ((void)0)
+#define TRACE_ISR_EXIT(isr_id) ((void)0)
+#define TRACE_FSM_BEGIN(start_us)
+#define TRACE_FSM_END(fsm_id, start_us, p_fsm, from_state) ((void)0)
+#define TRACE_SET_FSM_NAME(fsm_id, p_name) ((void)0)
+#endif
+
+/* Typedefs --------------------------------------------------------------------*/
+/**
+ * @brief Registro de la traza
+ */
+typedef struct
+{
+	uint32_t ts_us; //instante en microsegundos: el principio del disparo o el de la marca
+	uint32_t dur_us; //duracion del disparo (0 en las marcas de interrupcion)
+	uint8_t type; //`TRACE_TYPES`
+	uint8_t id; //prioridad de la FSM en el planificador o `TRACE_ISRS`
+	uint8_t from; //estado antes del disparo
+	uint8_t to; //estado despues del disparo
+	uint8_t guard; //indice en la tabla de la transicion, `TRACE_GUARD_NONE` o `TRACE_GUARD_UNKNOWN`
+	uint8_t reserved[3];
+} trace_record_t;
+
+/**
+ * @brief Buffer de la traza. Todo en una estructura para poder volcarlo desde el depurador con
+ * `dump binary value trace.bin trace_ring` y exportarlo con `tools/trace_export.py`
+ */
+typedef struct
+{
+	uint32_t magic; //`TRACE_MAGIC`
+	uint32_t head; //registros escritos desde el arranque
+	uint32_t num_records; //`TRACE_BUFFER_RECORDS`
+	uint32_t record_size; //`sizeof(trace_record_t)`
+	trace_record_t records[TRACE_BUFFER_RECORDS];
+} trace_ring_t;
+
+/* Function prototypes and explanation -------------------------------------------------*/
+/**
+ * @brief Guarda una marca de entrada o salida de una rutina de interrupcion con el instante actual, sobrescribiendo el registro mas antiguo si el buffer esta lleno
+ *
+ * @note Se puede llamar desde las rutinas de interrupcion: el hueco se reserva con una operacion atomica.
+ * @param type `TRACE_TYPE_ISR_ENTER` o `TRACE_TYPE_ISR_EXIT`
+ * @param id `TRACE_ISRS`
+ */
+void 	trace_record (uint8_t type, uint8_t id);
+
+/**
+ * @brief Guarda el disparo de una FSM. Busca en la tabla la transicion del estado de origen al de destino, si es la unica posible
+ *
+ * @param fsm_id prioridad de la FSM en el planificador
+ * @param start_us instante antes de `fsm_fire()`
+ * @param p_fsm FSM ya disparada
+ * @param from_state estado antes del disparo
+ */
+void 	trace_fsm_fire (uint8_t fsm_id, uint32_t start_us, const fsm_t *p_fsm, int32_t from_state);
+
+/**
+ * @brief Vacia la traza
+ */
+void 	trace_reset (void);
+
+/**
+ * @brief Da nombre a una FSM en la exportacion
+ *
+ * @param fsm_id prioridad de la FSM en el planificador
+ * @param p_name nombre, que tiene que seguir existiendo al exportar
+ */
+void 	trace_set_fsm_name (uint8_t fsm_id, const char *p_name);
+
+/**
+ * @brief Devuelve el buffer de la traza
+ *
+ * @return buffer de la traza
+ */
+const trace_ring_t * 	trace_get_ring (void);
+
+/**
+ * @brief Escribe la traza en el formato JSON de eventos de Chrome/Perfetto, del registro mas antiguo al mas reciente.
+ * Cada FSM es un hilo con un evento por disparo y cada rutina de interrupcion otro con un evento por ejecucion
+ *
+ * @param p_file fichero de salida
+ */
+void 	trace_export_chrome (FILE *p_file);
+
+#endif /* TRACE_H_ */
@@ -0,0 +1,43 @@
+/**
+ * @file ultrasound_echo.h
+ * @brief Header for ultrasound_echo.c file.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-24
+ */
+
+#ifndef ULTRASOUND_ECHO_H_
+#define ULTRASOUND_ECHO_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define ULTRASOUND_ECHO_SPEED_OF_SOUND_MS 343 /*!< Velocidad del sonido en m/s */
+#define ULTRASOUND_ECHO_TIMER_TICKS 65536 /*!< Ticks del timer del eco entre dos desbordamientos */
+
+/* Function prototypes and explanation -------------------------------------------------*/
+/**
+ * @brief Convierte la duracion de un eco en distancia
+ *
+ * El timer del eco cuenta microsegundos. El sonido va y vuelve, asi que la distancia es la mitad del recorrido.
+ *
+ * @param init_tick tick del flanco de subida del eco
+ * @param end_tick tick del flanco de bajada del eco
+ * @param overflows desbordamientos del timer entre los dos flancos
+ * @return distancia en centimetros
+ */
+uint32_t 	ultrasound_echo_to_cm (uint32_t init_tick, uint32_t end_tick, uint32_t overflows);
+
+/**
+ * @brief Devuelve la mediana de un grupo de distancias
+ *
+ * @param p_distances_cm distancias en centimetros. Se ordenan de menor a mayor
+ * @param num numero de distancias (impar)
+ * @return distancia mediana en centimetros
+ */
+uint32_t 	ultrasound_echo_median_cm (uint32_t *p_distances_cm, uint32_t num);
+
+#endif /* ULTRASOUND_ECHO_H_ */
@@ -0,0 +1,101 @@
+/**
+ * @file zones.h
+ * @brief Header for zones.c file.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-13
+ */
+
+#ifndef ZONES_H_
+#define ZONES_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Enums */
+/**
+* @brief zonas de distancia, de la mas cercana a la mas lejana. `ZONE_NONE` es fuera de rango
+*/
+enum ZONES {
+  ZONE_DANGER = 0,
+  ZONE_WARNING,
+  ZONE_NO_PROBLEM,
+  ZONE_INFO,
+  ZONE_OK,
+  ZONE_NONE
+};
+
+/* Defines */
+/**
+* @brief distancias por defecto a las que cambia de zona
+*/
+#define DANGER_MIN_CM 0
+#define WARNING_MIN_CM 25
+#define NO_PROBLEM_MIN_CM 50
+#define INFO_MIN_CM 150
+#define OK_MIN_CM 175
+#define OK_MAX_CM 200
+
+#define ZONES_NUM ZONE_NONE /*!< Numero de zonas dentro del rango */
+#define ZONES_RANGE_MAX_CM 400 /*!< Distancia maxima de la tabla: el alcance del HC-SR04 */
+#define ZONES_HYSTERESIS_CM 3 /*!< Banda de histeresis por defecto a cada lado de un limite */
+
+/* Function prototypes and explanation -------------------------------------------------*/
+/**
+ * @brief Cambia los limites de las zonas y la histeresis
+ *
+ * Recalcula la tabla de una zona por centimetro, asi que cada clasificacion es una lectura de la tabla.
+ *
+ * @param p_max_cm distancia maxima (incluida) de cada una de las `ZONES_NUM` zonas, en orden creciente. La primera empieza en 0
+ * @param hysteresis_cm distancia que hay que pasar un limite para cambiar de zona
+ * @return false si los limites no son crecientes o el ultimo mas la histeresis pasa de `ZONES_RANGE_MAX_CM`. Entonces no cambia nada
+ */
+bool 	zones_set_limits (const uint32_t *p_max_cm, uint32_t hysteresis_cm);
+
+/**
+ * @brief Devuelve la zona de una distancia, sin histeresis
+ *
+ * @param distance_cm distancia en centimetros
+ * @return zona, o `ZONE_NONE` fuera de rango
+ */
+uint32_t 	zones_lookup (int32_t distance_cm);
+
+/**
+ * @brief Devuelve la zona de una distancia con histeresis respecto a la zona anterior
+ *
+ * La zona solo cambia cuando la distancia se aleja mas de la histeresis del limite de la zona anterior, asi una
+ * distancia que oscila en un limite no cambia de zona en cada medida.
+ *
+ * @param distance_cm distancia en centimetros
+ * @param prev_zone zona de la medida anterior (`ZONE_NONE` si no hay)
+ * @return zona
+ */
+uint32_t 	zones_classify (int32_t distance_cm, uint32_t prev_zone);
+
+/**
+ * @brief Devuelve la distancia minima de una zona
+ *
+ * @param zone zona dentro del rango
+ * @return distancia en centimetros
+ */
+uint32_t 	zones_get_min_cm (uint32_t zone);
+
+/**
+ * @brief Devuelve la distancia maxima (incluida) de una zona
+ *
+ * @param zone zona dentro del rango
+ * @return distancia en centimetros
+ */
+uint32_t 	zones_get_max_cm (uint32_t zone);
+
+/**
+ * @brief Devuelve un contador que cambia cada vez que cambian los limites, para recalcular lo que dependa de ellos
+ *
+ * @return contador de cambios
+ */
+uint32_t 	zones_get_generation (void);
+
+#endif /* ZONES_H_ */
@@ -0,0 +1,57 @@
+/**
+ * @file boot_timeline.c
+ * @brief Instantes de cada etapa del arranque, desde el reset hasta la primera distancia en el display.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-23
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include "port_system.h"
+#include "logger.h"
+#include "boot_timeline.h"
+
+/* Global variables */
+uint32_t 	boot_timeline_us [BOOT_STAGE_NUM]; /*!< Instante de cada etapa. Global para leerlo desde el depurador */
+
+static uint32_t 	boot_timeline_reached = 0; /*!< Bit de cada etapa por la que ya se ha pasado */
+static uint32_t 	boot_timeline_micros_ref = 0; /*!< `port_system_get_micros()` al acabar `port_system_init()` */
+
+/* Private functions -----------------------------------------------------------*/
+/**
+ * @brief Registra todas las etapas, con el tiempo de cada una desde la anterior
+ */
+static void 	_log_timeline (void){
+#if LOGGER_LEVEL <= LOGGER_LEVEL_INFO
+	uint32_t prev_us = 0;
+	for (uint32_t stage = 0; stage < BOOT_STAGE_NUM; stage++){
+		if (!(boot_timeline_reached & (1U << stage))) continue;
+		uint32_t us = boot_timeline_us[stage];
+		LOGGER_INFO("[BOOT] etapa %ld: %ld us (+%ld us)\n", stage, us, us - prev_us);
+		prev_us = us;
+	}
+#endif
+}
+
+/* Public functions -----------------------------------------------------------*/
+void 	boot_timeline_mark (uint32_t stage){
+	if (stage >= BOOT_STAGE_NUM || (boot_timeline_reached & (1U << stage))) return;
+
+	if (!(boot_timeline_reached & (1U << BOOT_STAGE_SYSTEM_INIT))){
+		//El contador de ciclos arranca en SystemInit y el reloj no cambia hasta aqui
+		boot_timeline_us[stage] = port_system_get_cycles() / port_system_get_cycles_per_us();
+		boot_timeline_micros_ref = port_system_get_micros();
+	}else{
+		boot_timeline_us[stage] = boot_timeline_us[BOOT_STAGE_SYSTEM_INIT] + (port_system_get_micros() - boot_timeline_micros_ref);
+	}
+	boot_timeline_reached |= 1U << stage;
+
+	if (stage == BOOT_STAGE_FIRST_DISTANCE)
+		_log_timeline();
+}
+
+uint32_t 	boot_timeline_get_us (uint32_t stage){
+	if (stage >= BOOT_STAGE_NUM || !(boot_timeline_reached & (1U << stage))) return BOOT_TIMELINE_NOT_REACHED;
+	return boot_timeline_us[stage];
+}
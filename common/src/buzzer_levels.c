@@ -0,0 +1,38 @@
+/**
+ * @file buzzer_levels.c
+ * @brief Patron del buzzer para cada zona, con los modos continuo y noche. No depende del hardware.
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutierrez Fontán
+ * @date 2025-06-24
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include "buzzer_levels.h"
+
+/* Global variables */
+/**
+* @brief patron de cada zona, indexado por la zona
+*/
+static const buzzer_pattern_t 	buzzer_zone_patterns [ZONES_NUM + 1] = {
+	[ZONE_DANGER] = {DO, 0, 0, PORT_BUZZER_PATTERN_FOREVER, BUZZER_VOLUME_DANGER},
+	[ZONE_WARNING] = {RE, 150, 150, PORT_BUZZER_PATTERN_FOREVER, BUZZER_VOLUME_WARNING},
+	[ZONE_NO_PROBLEM] = {MI, 275, 275, PORT_BUZZER_PATTERN_FOREVER, BUZZER_VOLUME_NO_PROBLEM},
+	[ZONE_INFO] = {FA, 400, 400, PORT_BUZZER_PATTERN_FOREVER, BUZZER_VOLUME_INFO},
+	[ZONE_OK] = {SOL, 525, 525, PORT_BUZZER_PATTERN_FOREVER, BUZZER_VOLUME_OK},
+	[ZONE_NONE] = {0, 0, 0, PORT_BUZZER_PATTERN_FOREVER, 0},
+};
+
+/* Public functions -----------------------------------------------------------*/
+void 	buzzer_levels_compute (buzzer_pattern_t *p_pattern, uint32_t zone, bool pulsed, bool night){
+	if (zone > ZONE_NONE)
+		zone = ZONE_NONE;
+	*p_pattern = buzzer_zone_patterns[zone];
+	if (!pulsed){
+		p_pattern->on_ms = 0;
+		p_pattern->off_ms = 0;
+	}
+	if (night){
+		p_pattern->volume = (p_pattern->volume * BUZZER_NIGHT_VOLUME_PERCENT + 50) / 100;
+	}
+}
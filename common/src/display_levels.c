@@ -0,0 +1,77 @@
+/**
+ * @file display_levels.c
+ * @brief Niveles del display: tabla del degradado entre los colores de las zonas y fotogramas de la respiracion. No depende del hardware.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-24
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <math.h>
+#include "display_levels.h"
+
+/* Defines --------------------------------------------------------------------*/
+#define DISPLAY_PI 3.14159265358979323846 /*!< Numero pi, para la respiracion */
+
+/* Private functions -----------------------------------------------------------*/
+/**
+ * @brief Interpola un canal entre dos niveles con correccion gamma
+ *
+ * Los niveles son ciclos de trabajo, lineales en intensidad. Se interpola en el espacio perceptual (nivel^(1/gamma))
+ * y se vuelve a pasar a ciclo de trabajo, asi el degradado se ve uniforme y en los centros de zona queda el color exacto.
+ *
+ * @param from nivel en el color de origen
+ * @param to nivel en el color de destino
+ * @param t posicion entre los dos colores (0 a 1)
+ * @return nivel interpolado
+ */
+static uint8_t 	_gamma_lerp (uint8_t from, uint8_t to, double t){
+	double p_from = pow((double)from / PORT_DISPLAY_RGB_MAX_VALUE, 1.0 / DISPLAY_LEVELS_GAMMA);
+	double p_to = pow((double)to / PORT_DISPLAY_RGB_MAX_VALUE, 1.0 / DISPLAY_LEVELS_GAMMA);
+	double level = pow(p_from + (p_to - p_from) * t, DISPLAY_LEVELS_GAMMA);
+	return (uint8_t)round(level * PORT_DISPLAY_RGB_MAX_VALUE);
+}
+
+/**
+ * @brief Centro de una zona, donde el degradado tiene el color exacto de la zona
+ *
+ * @param zone zona dentro del rango
+ * @return distancia en centimetros
+ */
+static int32_t 	_zone_center_cm (uint32_t zone){
+	return (int32_t)(zones_get_min_cm(zone) + zones_get_max_cm(zone)) / 2;
+}
+
+/* Public functions -----------------------------------------------------------*/
+void 	display_levels_build_gradient (rgb_color_t *p_lut, const rgb_color_t *p_zone_colors){
+	uint32_t i = 0;
+	for (int32_t cm = 0; cm <= ZONES_RANGE_MAX_CM; cm++){
+		while (i + 1 < ZONES_NUM && cm > _zone_center_cm(i + 1))
+			i++;
+
+		int32_t from_cm = _zone_center_cm(i);
+		if (cm <= from_cm || i + 1 >= ZONES_NUM){
+			//Antes del primer centro o despues del ultimo el color se mantiene
+			p_lut[cm] = p_zone_colors[i];
+			continue;
+		}
+
+		const rgb_color_t *p_from = &p_zone_colors[i];
+		const rgb_color_t *p_to = &p_zone_colors[i + 1];
+		double t = (double)(cm - from_cm) / (double)(_zone_center_cm(i + 1) - from_cm);
+		p_lut[cm] = (rgb_color_t){
+			_gamma_lerp(p_from->r, p_to->r, t),
+			_gamma_lerp(p_from->g, p_to->g, t),
+			_gamma_lerp(p_from->b, p_to->b, t),
+		};
+	}
+}
+
+void 	display_levels_breathe (rgb_color_t *p_frames, uint32_t num_frames, rgb_color_t color){
+	for (uint32_t i = 0; i < num_frames; i++){
+		double brightness = (1.0 - cos((2.0 * DISPLAY_PI * i) / num_frames)) / 2.0;
+		double scale = pow(brightness, DISPLAY_LEVELS_GAMMA);
+		p_frames[i] = (rgb_color_t){(uint8_t)round(color.r * scale), (uint8_t)round(color.g * scale), (uint8_t)round(color.b * scale)};
+	}
+}
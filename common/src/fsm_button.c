@@ -17,7 +17,8 @@
 #include "fsm_button.h"
 
 /**
-* @brief Tiene un fsm_t, un tiempo de rebote del boton, cuando es el proximo timeout, el numero de ticks pulsado, la duracion y el id del boton
+* @brief Tiene un fsm_t, un tiempo de rebote del boton, cuando es el proximo timeout, el numero de ticks pulsado, la duracion, el id del boton
+* , los umbrales de pulsacion mantenida (su duracion y los que ya se han atendido en la pulsacion en curso) y si el debounce lo hace el hardware
 */
 struct  fsm_button_t
 {
@@ -27,7 +28,39 @@ struct  fsm_button_t
 	uint32_t 	tick_pressed;
 	uint32_t 	duration;
 	uint32_t 	button_id;
+	uint32_t 	hold_ms [FSM_BUTTON_MAX_HOLD_THRESHOLDS];
+	uint32_t 	num_holds;
+	uint32_t 	hold_reset_mask;
+	bool 	hw_debounce;
+#ifdef USE_FSM_STATS
+	fsm_button_stats_t 	stats;
+#endif
 };
+
+/* Private functions -----------------------------------------------------------*/
+/**
+ * @brief Devuelve el instante del ultimo flanco: el que marco la interrupcion con el debounce por hardware o el actual sin el
+ * 
+ * @param p_fsm Estructura de boton
+ * @return tiempo en ms
+ */
+static uint32_t 	_edge_ms (fsm_button_t *p_fsm){
+	if (p_fsm->hw_debounce)
+		return port_button_get_edge_ms(p_fsm->button_id);
+	return port_system_get_millis();
+}
+
+/**
+ * @brief Devuelve cuanto lleva pulsado el boton o, si ya se ha soltado, cuanto duro la ultima pulsacion
+ * 
+ * @param p_fsm Estructura de boton
+ * @return tiempo en ms
+ */
+static uint32_t 	_held_ms (fsm_button_t *p_fsm){
+	if (p_fsm->f.current_state == BUTTON_PRESSED_WAIT || p_fsm->f.current_state == BUTTON_PRESSED)
+		return port_system_get_millis() - p_fsm->tick_pressed;
+	return p_fsm->duration;
+}
 /* State machine input or transition functions */
 
 /**
@@ -66,7 +99,8 @@ static bool 	check_button_released (fsm_t *p_this){
 
 static bool 	check_timeout (fsm_t *p_this){
 	fsm_button_t *p_fsm = (fsm_button_t *)(p_this);
-	return (port_system_get_millis()>(p_fsm->next_timeout));
+	//Con el debounce por hardware los flancos ya llegan filtrados
+	return p_fsm->hw_debounce || (port_system_get_millis()>(p_fsm->next_timeout));
 }
 
 /* State machine output or action functions */
@@ -79,8 +113,11 @@ static bool 	check_timeout (fsm_t *p_this){
 
 static void 	do_store_tick_pressed (fsm_t *p_this){
 	fsm_button_t *p_fsm = (fsm_button_t *)(p_this);
-	p_fsm->tick_pressed = port_system_get_millis();
+	p_fsm->tick_pressed = _edge_ms(p_fsm);
+	FSM_STATS_INC(p_fsm, presses);
 	p_fsm->next_timeout = (p_fsm->tick_pressed) +(p_fsm->debounce_time_ms);
+	//Pulsacion nueva: todos los umbrales vuelven a estar pendientes
+	p_fsm->hold_reset_mask = 0;
 }
 
 /**
@@ -91,7 +128,7 @@ static void 	do_store_tick_pressed (fsm_t *p_this){
 
 static void 	do_set_duration (fsm_t *p_this){
 	fsm_button_t *p_fsm = (fsm_button_t *)(p_this);
-	p_fsm->duration = (port_system_get_millis()-(p_fsm->tick_pressed));
+	p_fsm->duration = (_edge_ms(p_fsm)-(p_fsm->tick_pressed));
 	p_fsm->next_timeout = (p_fsm->tick_pressed) +(p_fsm->debounce_time_ms);
 }
 
@@ -127,7 +164,14 @@ void fsm_button_init(fsm_button_t *p_fsm_button, uint32_t debounce_time, uint32_
 	p_fsm_button->debounce_time_ms = debounce_time;
 	p_fsm_button->button_id = button_id;
 	p_fsm_button->tick_pressed =0;
+	p_fsm_button->next_timeout = 0;
 	p_fsm_button->duration = 0;
+#ifdef USE_FSM_STATS
+	p_fsm_button->stats = (fsm_button_stats_t){0};
+#endif
+	p_fsm_button->num_holds = 0;
+	p_fsm_button->hold_reset_mask = 0;
+	p_fsm_button->hw_debounce = false;
 	
 	port_button_init(button_id);
 }
@@ -172,9 +216,72 @@ uint32_t 	fsm_button_get_debounce_time_ms (fsm_button_t *p_fsm){
 	return p_fsm->debounce_time_ms;
 }
 
+uint32_t 	fsm_button_get_next_timeout (fsm_button_t *p_fsm){
+	return p_fsm->next_timeout;
+}
+
+bool 	fsm_button_get_next_deadline (fsm_button_t *p_fsm, uint32_t *p_deadline_ms){
+	if (p_fsm->hw_debounce || (p_fsm->f.current_state != BUTTON_PRESSED_WAIT && p_fsm->f.current_state != BUTTON_RELEASED_WAIT))
+		return false;
+	/* check_timeout exige superar estrictamente next_timeout */
+	*p_deadline_ms = p_fsm->next_timeout + 1;
+	return true;
+}
+
+ 
+uint32_t 	fsm_button_add_hold_threshold (fsm_button_t *p_fsm, uint32_t hold_ms){
+	if (p_fsm->num_holds >= FSM_BUTTON_MAX_HOLD_THRESHOLDS)
+		return FSM_BUTTON_MAX_HOLD_THRESHOLDS;
+	p_fsm->hold_ms[p_fsm->num_holds] = hold_ms;
+	return p_fsm->num_holds++;
+}
+
+bool 	fsm_button_check_hold_threshold (fsm_button_t *p_fsm, uint32_t threshold_id){
+	if (threshold_id >= p_fsm->num_holds || (p_fsm->hold_reset_mask & (1U << threshold_id)))
+		return false;
+	return _held_ms(p_fsm) >= p_fsm->hold_ms[threshold_id];
+}
+
+void 	fsm_button_reset_hold_threshold (fsm_button_t *p_fsm, uint32_t threshold_id){
+	if (threshold_id < p_fsm->num_holds)
+		p_fsm->hold_reset_mask |= (1U << threshold_id);
+}
+
+bool 	fsm_button_get_next_hold_deadline (fsm_button_t *p_fsm, uint32_t *p_deadline_ms){
+	if (p_fsm->f.current_state != BUTTON_PRESSED_WAIT && p_fsm->f.current_state != BUTTON_PRESSED)
+		return false;
+	bool found = false;
+	for (uint32_t i = 0; i < p_fsm->num_holds; i++){
+		//Un umbral alcanzado sigue venciendo hasta que quien lo atiende lo resetea
+		if (p_fsm->hold_reset_mask & (1U << i))
+			continue;
+		uint32_t deadline_ms = p_fsm->tick_pressed + p_fsm->hold_ms[i];
+		if (!found || (int32_t)(deadline_ms - *p_deadline_ms) < 0){
+			*p_deadline_ms = deadline_ms;
+			found = true;
+		}
+	}
+	return found;
+}
  
 bool 	fsm_button_check_activity (fsm_button_t *p_fsm){
 	if (p_fsm->f.current_state == BUTTON_RELEASED)
-		return false;
+		//La ventana del debounce por hardware tiene que acabar antes de dormir en STOP, que para el timer
+		return p_fsm->hw_debounce && port_button_get_debouncing(p_fsm->button_id);
 	return true;
 }
+
+void 	fsm_button_set_hw_debounce (fsm_button_t *p_fsm, bool enable){
+	p_fsm->hw_debounce = enable;
+	port_button_set_hw_debounce(p_fsm->button_id, enable ? p_fsm->debounce_time_ms : 0);
+}
+
+bool 	fsm_button_get_hw_debounce (fsm_button_t *p_fsm){
+	return p_fsm->hw_debounce;
+}
+
+#ifdef USE_FSM_STATS
+fsm_button_stats_t * 	fsm_button_get_stats (fsm_button_t *p_fsm){
+	return &p_fsm->stats;
+}
+#endif
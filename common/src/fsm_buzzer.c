@@ -17,19 +17,24 @@
 
 /* HW dependent includes */
 /**
-* @brief Tiene una fsm_t, la distancia y la nota que suena a esa distancia, el estado, idle (si esta pausado o no), si esta pulsado o no, el id del buzzer, un contador y el tiempo de sonido
+* @brief Tiene una fsm_t, la distancia y su zona, la nota que suena a esa distancia, el estado, idle (si esta pausado o no), si esta pulsado o no, si esta en modo noche, si ya se ha inicializado el hardware, el id del buzzer y el patron que esta sonando
 */
 struct  fsm_buzzer_t
 {
 	fsm_t 	f;
 	int32_t 	distance_cm;
+	uint32_t 	zone;
 	bool 	new_nota;
 	bool 	status;
 	bool 	idle;
 	bool	pulsed;
+	bool	night;
+	bool	hw_ready;
 	uint32_t 	buzzer_id;
-	uint32_t 	counter;
-	uint32_t	max;
+	buzzer_pattern_t 	pattern;
+#ifdef USE_FSM_STATS
+	fsm_buzzer_stats_t 	stats;
+#endif
 };
 /* Project includes */
 
@@ -37,38 +42,40 @@ struct  fsm_buzzer_t
 
 /* Private functions -----------------------------------------------------------*/
 /**
-* @brief calcula la frecuencia a la que tiene que sonar el buzzer
-* @param p_nota nota que tiene que sonar
-* @param max tiempo que pasa encendido o apagado durante un sonido
-* @param distance_cm distancia de la nueva medicion
+* @brief inicializa el hardware del buzzer la primera vez que tiene que sonar o callarse, para no retrasar el arranque
+* @param p_fsm fsm del buzzer
 */
-void 	_compute_buzzer_levels (buzzer_t *p_nota,uint32_t *max, int32_t distance_cm){
-	if (distance_cm>= DANGER_MIN_CM && distance_cm<=WARNING_MIN_CM){
-		*p_nota = (buzzer_t){DO};
-		*max = 0;
-		return;
-	}
-	if (distance_cm> WARNING_MIN_CM && distance_cm<=NO_PROBLEM_MIN_CM){
-		*p_nota = (buzzer_t){RE};
-		*max = 5;
-		return;
-	}
-	if (distance_cm> NO_PROBLEM_MIN_CM && distance_cm<=INFO_MIN_CM){
-		*p_nota = (buzzer_t){MI};
-		*max = 10;
-		return;
-	}
-	if (distance_cm> INFO_MIN_CM && distance_cm<=OK_MIN_CM){
-		*p_nota = (buzzer_t){FA};
-		*max = 15;
-		return;
-	}
-	if (distance_cm> OK_MIN_CM && distance_cm<=OK_MAX_CM){
-		*p_nota = (buzzer_t){SOL};
-		*max = 20;
+static void 	_hw_init (fsm_buzzer_t *p_fsm){
+	if (p_fsm->hw_ready) return;
+	port_buzzer_init(p_fsm->buzzer_id);
+	p_fsm->hw_ready = true;
+}
+
+/**
+* @brief manda un patron al hardware si es distinto del que esta sonando
+* @param p_fsm fsm del buzzer
+* @param pattern patron que tiene que sonar
+*/
+static void 	_play_pattern (fsm_buzzer_t *p_fsm, buzzer_pattern_t pattern){
+	if (pattern.freq == p_fsm->pattern.freq && pattern.on_ms == p_fsm->pattern.on_ms
+		&& pattern.off_ms == p_fsm->pattern.off_ms && pattern.repeat == p_fsm->pattern.repeat
+		&& pattern.volume == p_fsm->pattern.volume)
 		return;
-	}
-	*p_nota = BUZZER_OFF;
+	p_fsm->pattern = pattern;
+	_hw_init(p_fsm);
+	port_buzzer_play_pattern(p_fsm->buzzer_id, pattern);
+	FSM_STATS_INC(p_fsm, reconfigs);
+}
+
+/**
+* @brief silencia el buzzer
+* @param p_fsm fsm del buzzer
+*/
+static void 	_silence (fsm_buzzer_t *p_fsm){
+	p_fsm->pattern = (buzzer_pattern_t){0, 0, 0, PORT_BUZZER_PATTERN_FOREVER, 0};
+	_hw_init(p_fsm);
+	port_buzzer_set_freq(p_fsm->buzzer_id,BUZZER_OFF);
+	FSM_STATS_INC(p_fsm, reconfigs);
 }
 /* State machine input or transition functions */
 /**
@@ -98,37 +105,6 @@ static bool check_buzzer_off (fsm_t *p_this){
 	fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
 	return !(p_fsm -> status);
 }
-/**
-* @brief comprueba que el buzzer ha esperado suficiente tiempo para volver a sonar
-* @param p_this fsm_t del buzzer
-* @return si ha llegado al tiempo suficiente 
-*/
-static bool check_buzzer_off_time(fsm_t *p_this){
-	fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
-	p_fsm->counter = get_port_buzzer_counter(p_fsm->buzzer_id);
-	if (p_fsm->counter>(p_fsm->max)){
-		port_buzzer_counter_reset(p_fsm->buzzer_id);
-		//printf("ON");
-		return true;
-	}
-	return false;
-}
-/**
-* @brief comprueba que el buzzer ha sonado suficiente tiempo para volver a callarse
-* @param p_this fsm_t del buzzer
-* @return si ha llegado al tiempo suficiente  
-*/
-static bool check_buzzer_on_time (fsm_t *p_this){
-	fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
-	p_fsm->counter = get_port_buzzer_counter(p_fsm->buzzer_id);
-	if ((p_fsm->pulsed)&&(p_fsm->max!=0)&&(p_fsm->counter>(p_fsm->max))){
-		port_buzzer_counter_reset(p_fsm->buzzer_id);
-		//printf("OFF");
-		return true;
-	}
-	return false;
-}
-
 /* State machine output or action functions */
 /**
 * @brief hace que el buzzer se encienda
@@ -136,19 +112,17 @@ static bool check_buzzer_on_time (fsm_t *p_this){
 */
 static void 	do_buzzer_set_on (fsm_t *p_this){
 	fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
-	port_buzzer_set_freq(p_fsm->buzzer_id,BUZZER_OFF);
+	_silence(p_fsm);
 }
  /**
-* @brief hace que el buzzer tenga una nueva nota
+* @brief hace que el buzzer tenga una nueva nota. El patron solo se cambia en el hardware al cambiar de zona o de modo
 * @param p_this fsm_t del buzzer
 */
 static void 	do_buzzer_set_nota (fsm_t *p_this){
 	fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
-	buzzer_t nota;
-	uint32_t max_value;
-	_compute_buzzer_levels(&nota, &max_value, p_fsm->distance_cm);
-	port_buzzer_set_freq(p_fsm->buzzer_id,nota);
-	p_fsm->max = max_value;
+	buzzer_pattern_t pattern;
+	buzzer_levels_compute(&pattern, p_fsm->zone, p_fsm->pulsed, p_fsm->night);
+	_play_pattern(p_fsm, pattern);
 	p_fsm->new_nota = false;
 	p_fsm->idle = true;
 }
@@ -160,7 +134,7 @@ static void 	do_buzzer_set_nota (fsm_t *p_this){
  */
 static void 	do_buzzer_set_off (fsm_t *p_this){
 	fsm_buzzer_t *p_fsm = (fsm_buzzer_t *)(p_this);
-	port_buzzer_set_freq(p_fsm->buzzer_id,BUZZER_OFF);
+	_silence(p_fsm);
 	p_fsm->idle = false;
 }
 
@@ -171,11 +145,8 @@ static void 	do_buzzer_set_off (fsm_t *p_this){
 */
 static fsm_trans_t 	fsm_trans_buzzer [] = {
 	{QUIETO_PARAO_BUZZER,check_buzzer_active,PIPIPIPI_BUZZER,do_buzzer_set_on},
-	{PIPIPIPI_BUZZER,check_buzzer_on_time,CALLAITO_BUZZER,do_buzzer_set_on},
 	{PIPIPIPI_BUZZER,check_buzzer_set_new_nota,PIPIPIPI_BUZZER,do_buzzer_set_nota},
 	{PIPIPIPI_BUZZER,check_buzzer_off,QUIETO_PARAO_BUZZER,do_buzzer_set_off},
-	{CALLAITO_BUZZER,check_buzzer_off_time,PIPIPIPI_BUZZER,do_buzzer_set_nota},
-	{CALLAITO_BUZZER,check_buzzer_off,QUIETO_PARAO_BUZZER,do_buzzer_set_off},
 	{-1,NULL,-1,NULL}
 };
 
@@ -187,15 +158,20 @@ static fsm_trans_t 	fsm_trans_buzzer [] = {
 */
 static void 	fsm_buzzer_init (fsm_buzzer_t *p_fsm_buzzer, uint32_t buzzer_id){
 	fsm_init((fsm_t *)p_fsm_buzzer,fsm_trans_buzzer);
+#ifdef USE_FSM_STATS
+	p_fsm_buzzer->stats = (fsm_buzzer_stats_t){0};
+#endif
 	p_fsm_buzzer ->buzzer_id = buzzer_id;
 	p_fsm_buzzer ->distance_cm = -1;
+	p_fsm_buzzer ->zone = ZONE_NONE;
 	p_fsm_buzzer ->idle = false;
 	p_fsm_buzzer ->status = false;
 	p_fsm_buzzer ->new_nota = false;
 	p_fsm_buzzer ->pulsed = true;
-	p_fsm_buzzer ->max = 10;
-	p_fsm_buzzer ->counter = 0;
-	port_buzzer_init(buzzer_id);
+	p_fsm_buzzer ->night = false;
+	p_fsm_buzzer ->hw_ready = false;
+	p_fsm_buzzer ->pattern = (buzzer_pattern_t){0, 0, 0, PORT_BUZZER_PATTERN_FOREVER, 0};
+	//El hardware se inicializa con el primer patron, en `_hw_init()`
 }
 
 void 	fsm_buzzer_destroy (fsm_buzzer_t *p_fsm){
@@ -219,16 +195,28 @@ uint32_t 	fsm_buzzer_get_distance (fsm_buzzer_t *p_fsm){
 }
 
 void 	fsm_buzzer_set_distance (fsm_buzzer_t *p_fsm, uint32_t distance_cm){
+	fsm_buzzer_set_zone(p_fsm, distance_cm, zones_lookup((int32_t)distance_cm));
+}
+
+void 	fsm_buzzer_set_zone (fsm_buzzer_t *p_fsm, uint32_t distance_cm, uint32_t zone){
 	p_fsm->distance_cm = distance_cm;
+	p_fsm->zone = zone;
 	p_fsm -> new_nota = true;
 }
 
 void fsm_buzzer_pulsed_state(fsm_buzzer_t *p_fsm){
 	p_fsm -> pulsed = true;
+	p_fsm -> new_nota = true;
 }
 
 void fsm_buzzer_continuous_state(fsm_buzzer_t *p_fsm){
 	p_fsm -> pulsed = false;
+	p_fsm -> new_nota = true;
+}
+
+void 	fsm_buzzer_set_night_mode (fsm_buzzer_t *p_fsm, bool night){
+	p_fsm -> night = night;
+	p_fsm -> new_nota = true;
 }
 
 bool 	fsm_buzzer_get_status (fsm_buzzer_t *p_fsm){
@@ -255,3 +243,20 @@ fsm_buzzer_t *fsm_buzzer_new(uint32_t buzzer_id)
     return p_fsm_buzzer;
 }
 
+void 	fsm_buzzer_suspend (fsm_buzzer_t *p_fsm){
+	//Al suspender se para el patron: al reanudar hay que volver a mandarlo
+	p_fsm->pattern = (buzzer_pattern_t){0, 0, 0, PORT_BUZZER_PATTERN_FOREVER, 0};
+	if (!p_fsm->hw_ready) return;
+	port_buzzer_suspend(p_fsm->buzzer_id);
+}
+
+void 	fsm_buzzer_resume (fsm_buzzer_t *p_fsm){
+	if (!p_fsm->hw_ready) return;
+	port_buzzer_resume(p_fsm->buzzer_id);
+}
+
+#ifdef USE_FSM_STATS
+fsm_buzzer_stats_t * 	fsm_buzzer_get_stats (fsm_buzzer_t *p_fsm){
+	return &p_fsm->stats;
+}
+#endif
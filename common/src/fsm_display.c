@@ -14,56 +14,205 @@
 #include "port_system.h"
 #include "fsm.h"
 #include "fsm_display.h"
+#include "boot_timeline.h"
+#include "display_levels.h"
 /* HW dependent includes */
 
 /**
-* @brief Tiene un fsm_t, la distancia en centimetros guardada del display, un booleano que indica si hay un nuevo color disponible
-* un booleano que indica el estado del display, un booleano para indicar si esta en pausa el display y el ID del diaplay.
+* @brief Tiene un fsm_t, la distancia en centimetros guardada del display y su zona, un booleano que indica si hay un nuevo color disponible
+* un booleano que indica el estado del display, un booleano para indicar si esta en pausa el display, si se usa el modo degradado,
+* si se muestra en la barra de LEDs, si ya se ha inicializado el hardware, si hay animaciones, si se ha pedido el barrido de encendido, la animacion que se esta reproduciendo (tipo, fotogramas, color y fin del barrido), sus fotogramas y el ID del diaplay.
 */
 struct  fsm_display_t
 {
 	fsm_t 	f;
 	int32_t 	distance_cm;
+	uint32_t 	zone;
 	bool 	new_color;
 	bool 	status;
 	bool 	idle;
+	bool 	gradient;
+	bool 	bar;
+	bool 	hw_ready;
+	bool 	animations;
+	bool 	sweep_pending;
+	uint32_t 	anim_kind;
+	uint32_t 	anim_num_frames;
+	rgb_color_t 	anim_color;
+	uint32_t 	sweep_end_ms;
+	rgb_color_t 	anim_frames [PORT_DISPLAY_ANIM_MAX_FRAMES];
 	uint32_t 	display_id;
+#ifdef USE_FSM_STATS
+	fsm_display_stats_t 	stats;
+#endif
 };
 /* Project includes */
 
-/* Typedefs --------------------------------------------------------------------*/
+/* Defines --------------------------------------------------------------------*/
+
+/**
+* @brief tipos de animacion del display
+*/
+enum DISPLAY_ANIMATION {
+	DISPLAY_ANIM_NONE = 0,
+	DISPLAY_ANIM_SWEEP,
+	DISPLAY_ANIM_BREATHE,
+	DISPLAY_ANIM_BLINK
+};
+
+/* Global variables */
+/**
+ * @brief Color de cada zona, indexado por la zona. En modo degradado es el color del centro de la zona y entre dos centros se interpola
+ */
+static const rgb_color_t 	zone_colors [ZONES_NUM + 1] = {
+	[ZONE_DANGER] = COLOR_RED,
+	[ZONE_WARNING] = COLOR_YELLOW,
+	[ZONE_NO_PROBLEM] = COLOR_GREEN,
+	[ZONE_INFO] = COLOR_TURQUOISE,
+	[ZONE_OK] = COLOR_BLUE,
+	[ZONE_NONE] = COLOR_OFF,
+};
+
+static rgb_color_t 	gradient_lut [DISPLAY_LEVELS_GRADIENT_SIZE]; /*!< Color del degradado para cada centimetro, calculado en `_build_gradient_lut()` */
+static bool 	gradient_lut_ready = false; /*!< Si ya se ha calculado `gradient_lut` (es compartida por todos los displays) */
+static uint32_t 	gradient_lut_generation = 0; /*!< Limites de las zonas con los que se calculo `gradient_lut` */
 
 /* Private functions -----------------------------------------------------------*/
+/**
+ * @brief Calcula la tabla del degradado, un color por centimetro entre 0 y `ZONES_RANGE_MAX_CM`
+ *
+ * @note Solo se calcula al activar el degradado o las animaciones y cuando cambian los limites de las zonas:
+ * despues cada actualizacion del display es una lectura de la tabla.
+ */
+static void 	_build_gradient_lut (void){
+	if (gradient_lut_ready && gradient_lut_generation == zones_get_generation()) return;
+
+	display_levels_build_gradient(gradient_lut, zone_colors);
+	gradient_lut_ready = true;
+	gradient_lut_generation = zones_get_generation();
+}
 
 /**
- * @brief Calcula el color del display a partir de la distancia
+ * @brief Limita una distancia al final de la zona `ZONE_OK`: con la histeresis la zona puede seguir dentro de rango un poco mas alla
  *
- * @param p_color Estructura del color rgb
- * @param distance_cm Distancia en centimentros del ultrasound
+ * @param distance_cm Distancia en centimetros
+ * @return distancia limitada
  */
-void 	_compute_display_levels (rgb_color_t *p_color, int32_t distance_cm){
-	if (distance_cm>= DANGER_MIN_CM && distance_cm<=WARNING_MIN_CM){
-		*p_color = COLOR_RED;
-		return;
-	}
-	if (distance_cm> WARNING_MIN_CM && distance_cm<=NO_PROBLEM_MIN_CM){
-		*p_color = COLOR_YELLOW;
-		return;
-	}
-	if (distance_cm> NO_PROBLEM_MIN_CM && distance_cm<=INFO_MIN_CM){
-		*p_color = COLOR_GREEN;
+static int32_t 	_clamp_to_range (int32_t distance_cm){
+	int32_t max_cm = (int32_t)zones_get_max_cm(ZONE_OK);
+	return (distance_cm > max_cm) ? max_cm : distance_cm;
+}
+
+/**
+ * @brief Periodo de parpadeo para una distancia: proporcional a la distancia, en pasos de `FSM_DISPLAY_BLINK_STEP_MS`
+ *
+ * @param distance_cm Distancia en centimetros, fuera de la zona de peligro
+ * @return periodo en ms
+ */
+static uint32_t 	_blink_period_ms (int32_t distance_cm){
+	int32_t min_cm = (int32_t)zones_get_max_cm(ZONE_DANGER);
+	int32_t max_cm = (int32_t)zones_get_max_cm(ZONE_OK);
+	distance_cm = _clamp_to_range(distance_cm);
+	if (distance_cm < min_cm)
+		distance_cm = min_cm;
+	uint32_t period_ms = FSM_DISPLAY_BLINK_MIN_MS + ((uint32_t)(distance_cm - min_cm) * (FSM_DISPLAY_BLINK_MAX_MS - FSM_DISPLAY_BLINK_MIN_MS)) / (uint32_t)(max_cm - min_cm);
+	return (period_ms / FSM_DISPLAY_BLINK_STEP_MS) * FSM_DISPLAY_BLINK_STEP_MS;
+}
+
+/**
+ * @brief Inicializa el hardware del display (y la barra si se usa) la primera vez que se va a mostrar algo
+ *
+ * Asi el arranque no espera por los temporizadores del display antes de la primera medida.
+ *
+ * @param p_fsm Estructura de fsm del display
+ */
+static void 	_hw_init (fsm_display_t *p_fsm){
+	if (p_fsm->hw_ready) return;
+	port_display_init(p_fsm->display_id);
+	if (p_fsm->bar)
+		port_display_bar_init(p_fsm->display_id);
+	p_fsm->hw_ready = true;
+}
+
+/**
+ * @brief Calcula los fotogramas de una animacion y la manda al hardware si ha cambiado
+ *
+ * @param p_fsm Estructura de fsm del display
+ * @param kind tipo de animacion
+ * @param color color de la animacion (no se usa en el barrido)
+ * @param period_ms duracion de la animacion
+ */
+static void 	_play_animation (fsm_display_t *p_fsm, uint32_t kind, rgb_color_t color, uint32_t period_ms){
+	uint32_t num_frames = period_ms / PORT_DISPLAY_ANIM_FRAME_MS;
+	if (num_frames > PORT_DISPLAY_ANIM_MAX_FRAMES)
+		num_frames = PORT_DISPLAY_ANIM_MAX_FRAMES;
+	if (kind == p_fsm->anim_kind && num_frames == p_fsm->anim_num_frames
+		&& color.r == p_fsm->anim_color.r && color.g == p_fsm->anim_color.g && color.b == p_fsm->anim_color.b)
 		return;
+
+	if (kind == DISPLAY_ANIM_BREATHE){
+		display_levels_breathe(p_fsm->anim_frames, num_frames, color);
+	}else{
+		for (uint32_t i = 0; i < num_frames; i++){
+			rgb_color_t *p_frame = &p_fsm->anim_frames[i];
+			if (kind == DISPLAY_ANIM_SWEEP){
+				//De lejos a cerca por el degradado de las zonas y el ultimo fotograma apagado
+				if (i + 1 == num_frames){
+					*p_frame = COLOR_OFF;
+				}else{
+					uint32_t max_cm = zones_get_max_cm(ZONE_OK);
+					*p_frame = gradient_lut[max_cm - (i * max_cm) / (num_frames - 1)];
+				}
+			}else{
+				*p_frame = (i < num_frames / 2) ? color : COLOR_OFF;
+			}
+		}
 	}
-	if (distance_cm> INFO_MIN_CM && distance_cm<=OK_MIN_CM){
-		*p_color = COLOR_TURQUOISE;
-		return;
+
+	p_fsm->anim_kind = kind;
+	p_fsm->anim_num_frames = num_frames;
+	p_fsm->anim_color = color;
+	_hw_init(p_fsm);
+	port_display_animate(p_fsm->display_id, p_fsm->anim_frames, num_frames, kind != DISPLAY_ANIM_SWEEP);
+	FSM_STATS_INC(p_fsm, reconfigs);
+}
+
+/**
+ * @brief Pinta la distancia en la barra de LEDs: cuanto mas cerca, mas LEDs encendidos, todos del color de la distancia
+ *
+ * @param p_fsm Estructura de fsm del display
+ * @param color color de la distancia (apagado fuera de rango)
+ */
+static void 	_render_bar (fsm_display_t *p_fsm, rgb_color_t color){
+	_hw_init(p_fsm);
+	uint32_t num_leds = port_display_bar_get_num_leds(p_fsm->display_id);
+	rgb_color_t *p_frame = port_display_bar_get_frame_buffer(p_fsm->display_id);
+	uint32_t lit = 0;
+	if (p_fsm->zone != ZONE_NONE){
+		//Un LED al final de ZONE_OK y la barra entera a 0 cm
+		uint32_t max_cm = zones_get_max_cm(ZONE_OK);
+		lit = 1 + ((max_cm - (uint32_t)_clamp_to_range(p_fsm->distance_cm)) * (num_leds - 1)) / max_cm;
 	}
-	if (distance_cm> OK_MIN_CM && distance_cm<=OK_MAX_CM){
-		*p_color = COLOR_BLUE;
-		return;
+	for (uint32_t i = 0; i < num_leds; i++){
+		p_frame[i] = (i < lit) ? color : COLOR_OFF;
 	}
-	*p_color = COLOR_OFF;
+	port_display_bar_show(p_fsm->display_id);
+	FSM_STATS_INC(p_fsm, reconfigs);
+}
+
+/**
+ * @brief Muestra un color fijo, parando la animacion que hubiera
+ *
+ * @param p_fsm Estructura de fsm del display
+ * @param color color a mostrar
+ */
+static void 	_show_color (fsm_display_t *p_fsm, rgb_color_t color){
+	p_fsm->anim_kind = DISPLAY_ANIM_NONE;
+	_hw_init(p_fsm);
+	port_display_set_rgb(p_fsm->display_id,color);
+	FSM_STATS_INC(p_fsm, reconfigs);
 }
+
 /* State machine input or transition functions */
 
 /**
@@ -107,7 +256,19 @@ static bool check_off (fsm_t *p_this){
  */
 static void 	do_set_on (fsm_t *p_this){
 	fsm_display_t *p_fsm = (fsm_display_t *)(p_this);
-	port_display_set_rgb(p_fsm->display_id,COLOR_OFF);
+	if (p_fsm->bar){
+		_render_bar(p_fsm,COLOR_OFF);
+		return;
+	}
+	if (p_fsm->animations && p_fsm->sweep_pending){
+		//Solo al encender el urbanite: las medidas que lleguen durante el barrido no lo cortan, salvo las de peligro
+		p_fsm->sweep_pending = false;
+		p_fsm->sweep_end_ms = port_system_get_millis() + FSM_DISPLAY_SWEEP_MS;
+		_build_gradient_lut();
+		_play_animation(p_fsm, DISPLAY_ANIM_SWEEP, COLOR_OFF, FSM_DISPLAY_SWEEP_MS);
+		return;
+	}
+	_show_color(p_fsm,COLOR_OFF);
 }
 
 /**
@@ -118,8 +279,31 @@ static void 	do_set_on (fsm_t *p_this){
 static void 	do_set_color (fsm_t *p_this){
 	fsm_display_t *p_fsm = (fsm_display_t *)(p_this);
 	rgb_color_t color;
-	_compute_display_levels(&color,p_fsm->distance_cm);
-	port_display_set_rgb(p_fsm->display_id,color);
+	uint32_t zone = (p_fsm->zone > ZONE_NONE) ? ZONE_NONE : p_fsm->zone;
+	bool in_range = (zone != ZONE_NONE);
+	if (p_fsm->gradient && in_range){
+		_build_gradient_lut();
+		color = gradient_lut[_clamp_to_range(p_fsm->distance_cm)];
+	}else{
+		color = zone_colors[zone];
+	}
+
+	if (p_fsm->bar){
+		_render_bar(p_fsm,color);
+	}else if (!p_fsm->animations){
+		_show_color(p_fsm,color);
+	}else if (zone != ZONE_DANGER && p_fsm->anim_kind == DISPLAY_ANIM_SWEEP && (int32_t)(port_system_get_millis() - p_fsm->sweep_end_ms) < 0){
+		//Todavia se esta reproduciendo el barrido de encendido. El peligro no espera a que acabe
+	}else if (!in_range){
+		_show_color(p_fsm,color);
+	}else if (zone == ZONE_DANGER){
+		_play_animation(p_fsm, DISPLAY_ANIM_BREATHE, color, FSM_DISPLAY_BREATHE_MS);
+	}else{
+		_play_animation(p_fsm, DISPLAY_ANIM_BLINK, color, _blink_period_ms(p_fsm->distance_cm));
+	}
+	//Con el barrido de encendido en marcha la distancia todavia no se ve
+	if (in_range && p_fsm->anim_kind != DISPLAY_ANIM_SWEEP)
+		BOOT_TIMELINE_MARK(BOOT_STAGE_FIRST_DISTANCE);
 	p_fsm->new_color = false;
 	p_fsm->idle = true;
 }
@@ -131,7 +315,11 @@ static void 	do_set_color (fsm_t *p_this){
  */
 static void 	do_set_off (fsm_t *p_this){
 	fsm_display_t *p_fsm = (fsm_display_t *)(p_this);
-	port_display_set_rgb(p_fsm->display_id,COLOR_OFF);
+	if (p_fsm->bar){
+		_render_bar(p_fsm,COLOR_OFF);
+	}else{
+		_show_color(p_fsm,COLOR_OFF);
+	}
 	p_fsm->idle = false;
 }
 
@@ -152,12 +340,25 @@ static fsm_trans_t 	fsm_trans_display [] = {
 */
 static void 	fsm_display_init (fsm_display_t *p_fsm_display, uint32_t display_id){
 	fsm_init((fsm_t *)p_fsm_display,fsm_trans_display);
+#ifdef USE_FSM_STATS
+	p_fsm_display->stats = (fsm_display_stats_t){0};
+#endif
 	p_fsm_display ->display_id = display_id;
 	p_fsm_display ->distance_cm = -1;
+	p_fsm_display ->zone = ZONE_NONE;
 	p_fsm_display ->idle = false;
 	p_fsm_display ->status = false;
 	p_fsm_display ->new_color = false;
-	port_display_init(display_id);
+	p_fsm_display ->gradient = false;
+	p_fsm_display ->bar = false;
+	p_fsm_display ->hw_ready = false;
+	p_fsm_display ->animations = false;
+	p_fsm_display ->sweep_pending = false;
+	p_fsm_display ->anim_kind = DISPLAY_ANIM_NONE;
+	p_fsm_display ->anim_num_frames = 0;
+	p_fsm_display ->anim_color = COLOR_OFF;
+	p_fsm_display ->sweep_end_ms = 0;
+	//El hardware se inicializa al mostrar el primer color, en `_hw_init()`
 }
  
 void 	fsm_display_destroy (fsm_display_t *p_fsm){
@@ -181,7 +382,12 @@ uint32_t 	fsm_display_get_distance (fsm_display_t *p_fsm){
 }
 
 void 	fsm_display_set_distance (fsm_display_t *p_fsm, uint32_t distance_cm){
+	fsm_display_set_zone(p_fsm, distance_cm, zones_lookup((int32_t)distance_cm));
+}
+
+void 	fsm_display_set_zone (fsm_display_t *p_fsm, uint32_t distance_cm, uint32_t zone){
 	p_fsm->distance_cm = distance_cm;
+	p_fsm->zone = zone;
 	p_fsm -> new_color = true;
 }
 
@@ -209,3 +415,64 @@ fsm_display_t *fsm_display_new(uint32_t display_id)
     fsm_display_init(p_fsm_display, display_id); /* Initialize the FSM */
     return p_fsm_display;
 }
+
+void 	fsm_display_set_gradient (fsm_display_t *p_fsm, bool gradient){
+	if (gradient)
+		_build_gradient_lut();
+	//Se aplica con la siguiente distancia
+	p_fsm->gradient = gradient;
+}
+
+void 	fsm_display_set_animations (fsm_display_t *p_fsm, bool animations){
+	//El barrido recorre el degradado
+	if (animations)
+		_build_gradient_lut();
+	p_fsm->animations = animations;
+}
+
+void 	fsm_display_request_sweep (fsm_display_t *p_fsm){
+	p_fsm->sweep_pending = true;
+}
+
+void 	fsm_display_set_bar (fsm_display_t *p_fsm, bool bar){
+	if (bar == p_fsm->bar) return;
+	if (!p_fsm->hw_ready){
+		//Todavia no se ha mostrado nada: `_hw_init()` inicializara lo que toque
+		p_fsm->bar = bar;
+		return;
+	}
+	if (bar){
+		//El LED RGB se apaga y deja de usarse
+		_show_color(p_fsm,COLOR_OFF);
+		port_display_bar_init(p_fsm->display_id);
+	}else{
+		_render_bar(p_fsm,COLOR_OFF);
+	}
+	p_fsm->bar = bar;
+}
+
+bool 	fsm_display_get_gradient (fsm_display_t *p_fsm){
+	return p_fsm->gradient;
+}
+
+void 	fsm_display_suspend (fsm_display_t *p_fsm){
+	//Al suspender se para la animacion: al reanudar hay que volver a mandarla
+	p_fsm->anim_kind = DISPLAY_ANIM_NONE;
+	if (!p_fsm->hw_ready) return;
+	port_display_suspend(p_fsm->display_id);
+	if (p_fsm->bar)
+		port_display_bar_suspend(p_fsm->display_id);
+}
+
+void 	fsm_display_resume (fsm_display_t *p_fsm){
+	if (!p_fsm->hw_ready) return;
+	port_display_resume(p_fsm->display_id);
+	if (p_fsm->bar)
+		port_display_bar_resume(p_fsm->display_id);
+}
+
+#ifdef USE_FSM_STATS
+fsm_display_stats_t * 	fsm_display_get_stats (fsm_display_t *p_fsm){
+	return &p_fsm->stats;
+}
+#endif
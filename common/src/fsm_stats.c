@@ -0,0 +1,32 @@
+/**
+ * @file fsm_stats.c
+ * @brief Contadores de funcionamiento comunes a todas las FSM: disparos, transiciones tomadas, guardas evaluadas y tiempo en cada estado.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-21
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "fsm_stats.h"
+
+/* Public functions -----------------------------------------------------------*/
+void 	fsm_stats_fire (fsm_stats_t *p_stats, const fsm_t *p_fsm, int32_t from_state, uint32_t now_ms){
+	int32_t to_state = p_fsm->current_state;
+	p_stats->fires++;
+
+	const fsm_trans_t *p_t = p_fsm->p_tt;
+	for (uint32_t i = 0; p_t[i].orig_state >= 0; i++){
+		if (p_t[i].orig_state != from_state)
+			continue;
+		p_stats->guard_evals++;
+		if (p_t[i].dest_state == to_state){
+			if (i < FSM_STATS_MAX_EDGES)
+				p_stats->edges[i]++;
+			break;
+		}
+	}
+
+	if (from_state >= 0 && from_state < FSM_STATS_MAX_STATES)
+		p_stats->state_ms[from_state] += now_ms - p_stats->last_fire_ms;
+	p_stats->last_fire_ms = now_ms;
+}
@@ -8,13 +8,13 @@
 
 /* Includes ------------------------------------------------------------------*/
 /* Standard C includes */
-#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 #include "port_ultrasound.h"
 #include "port_system.h"
 #include "fsm.h"
 #include "fsm_ultrasound.h"
+#include "ultrasound_echo.h"
 /* HW dependent includes */
 #include <stdio.h>
 /* Project includes */
@@ -32,20 +32,12 @@ struct  	fsm_ultrasound_t
 	uint32_t 	ultrasound_id;
 	uint32_t 	distance_arr [FSM_ULTRASOUND_NUM_MEASUREMENTS];
 	uint32_t 	distance_idx;
+#ifdef USE_FSM_STATS
+	fsm_ultrasound_stats_t 	stats;
+#endif
 };
 
 /* Private functions -----------------------------------------------------------*/
-// Comparison function for qsort
-/**
-* @brief hace la resta entre dos valores 
-* @param a valor al que se resta
-* @param b valor a restar
-* @return la resta de ambos valores
-*/
-int _compare(const void *a, const void *b){
-    return (*(uint32_t *)a - *(uint32_t *)b);
-}
-
 /* State machine input or transition functions */
 /**
  * @brief Verifique si el sensor de ultrasonido está activo y listo para iniciar una nueva medición.
@@ -156,24 +148,26 @@ static void 	do_stop_trigger (fsm_t *p_this){
  */
 static void 	do_set_distance (fsm_t *p_this){
 	fsm_ultrasound_t *p_fsm = (fsm_ultrasound_t *)(p_this);
-	double init = (double)port_ultrasound_get_echo_init_tick(p_fsm->ultrasound_id);
-	double end = (double)port_ultrasound_get_echo_end_tick(p_fsm->ultrasound_id);
-	double over = (double)port_ultrasound_get_echo_overflows(p_fsm->ultrasound_id);
+	uint32_t distancia = ultrasound_echo_to_cm(port_ultrasound_get_echo_init_tick(p_fsm->ultrasound_id),
+		port_ultrasound_get_echo_end_tick(p_fsm->ultrasound_id), port_ultrasound_get_echo_overflows(p_fsm->ultrasound_id));
 
-	//printf("init: %d end:%d over:%d\n", (int)init, (int)end, (int)over);
-
-	double tiempo = (end + over*(65535+1)-init);
-	double v_son = 343;
-
-	double distancia = (uint32_t)round(tiempo*v_son/20000);
-	
 	p_fsm->distance_arr[p_fsm->distance_idx] = distancia;
+	FSM_STATS_INC(p_fsm, echoes);
+	if (distancia > FSM_ULTRASOUND_MAX_RANGE_CM)
+		FSM_STATS_INC(p_fsm, echo_timeouts);
 
 	if ((p_fsm->distance_idx) == 4){
-		qsort(p_fsm->distance_arr, FSM_ULTRASOUND_NUM_MEASUREMENTS, sizeof(uint32_t), _compare);
-
-		p_fsm->distance_cm = p_fsm->distance_arr[2];
+		p_fsm->distance_cm = ultrasound_echo_median_cm(p_fsm->distance_arr, FSM_ULTRASOUND_NUM_MEASUREMENTS);
 		p_fsm->new_measurement = true;
+		FSM_STATS_INC(p_fsm, measurements);
+#ifdef USE_FSM_STATS
+		for (uint32_t i = 0; i < FSM_ULTRASOUND_NUM_MEASUREMENTS; i++){
+			uint32_t d = p_fsm->distance_arr[i];
+			uint32_t diff = (d > p_fsm->distance_cm) ? d - p_fsm->distance_cm : p_fsm->distance_cm - d;
+			if (diff > FSM_ULTRASOUND_OUTLIER_CM)
+				FSM_STATS_INC(p_fsm, outliers);
+		}
+#endif
 	}
 	p_fsm->distance_idx = (p_fsm->distance_idx + 1) % FSM_ULTRASOUND_NUM_MEASUREMENTS;
 	port_ultrasound_stop_echo_timer(p_fsm->ultrasound_id);
@@ -224,6 +218,9 @@ void fsm_ultrasound_init(fsm_ultrasound_t *p_fsm_ultrasound, uint32_t ultrasound
 	memset(p_fsm_ultrasound->distance_arr,0,FSM_ULTRASOUND_NUM_MEASUREMENTS*sizeof(uint32_t));
 	p_fsm_ultrasound->status = false;
 	p_fsm_ultrasound->new_measurement = false;
+#ifdef USE_FSM_STATS
+	p_fsm_ultrasound->stats = (fsm_ultrasound_stats_t){0};
+#endif
     port_ultrasound_init(ultrasound_id);
 }
 
@@ -296,3 +293,17 @@ void fsm_ultrasound_set_state(fsm_ultrasound_t *p_fsm, int8_t state)
 bool 	fsm_ultrasound_check_activity (fsm_ultrasound_t *p_fsm){
 	return false;
 }
+
+void 	fsm_ultrasound_suspend (fsm_ultrasound_t *p_fsm){
+	port_ultrasound_suspend(p_fsm->ultrasound_id);
+}
+
+void 	fsm_ultrasound_resume (fsm_ultrasound_t *p_fsm){
+	port_ultrasound_resume(p_fsm->ultrasound_id);
+}
+
+#ifdef USE_FSM_STATS
+fsm_ultrasound_stats_t * 	fsm_ultrasound_get_stats (fsm_ultrasound_t *p_fsm){
+	return &p_fsm->stats;
+}
+#endif
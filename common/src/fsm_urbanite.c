@@ -9,33 +9,51 @@
 /* Includes ------------------------------------------------------------------*/
 /* Standard C includes */
 #include <stdlib.h>
-#include <stdio.h>
 #include "port_system.h"
+#include "logger.h"
 #include "fsm.h"
+#include "scheduler.h"
 #include "fsm_urbanite.h"
+#include "zones.h"
+#include "boot_timeline.h"
 /* HW dependent includes */
 
 /* Project includes */
 
 /* Typedefs --------------------------------------------------------------------*/
 /**
-* @brief tiene el fsm_t, la estructura del boton, el tiempo de apagado, el tiempo de pausa, si esta pausado o no, el estado, la estructura del ultrasonids, el display y el buzzer
+* @brief tiene el fsm_t, la estructura del boton, el tiempo de apagado y su umbral de pulsacion mantenida, el tiempo de pausa, si esta pausado o no, el estado, la zona de la ultima medida, la estructura del ultrasonids, el display y el buzzer
 */
 struct fsm_urbanite_t
 {
 	fsm_t f;
 	fsm_button_t *p_fsm_button;
 	uint32_t on_off_press_time_ms;
+	uint32_t on_off_hold_id;
 	uint32_t pause_display_time_ms;
 	bool is_paused;
 	uint32_t state;
+	uint32_t zone;
 	fsm_ultrasound_t *p_fsm_ultrasound_rear;
 	fsm_display_t *p_fsm_display_rear;
 	fsm_buzzer_t *p_fsm_buzzer_rear;
+#ifdef USE_FSM_STATS
+	fsm_urbanite_stats_t stats;
+#endif
 };
 
 /* Private functions -----------------------------------------------------------*/
 /** 
+* @brief suspende el hardware del ultrasonidos, el display y el buzzer mientras la Urbanite esta apagada
+* @note el boton no se suspende: es el que enciende la Urbanite y el que la despierta del modo Stop
+* @param p_fsm estructura del urbanite
+*/
+static void 	_suspend_peripherals (fsm_urbanite_t *p_fsm){
+	fsm_ultrasound_suspend(p_fsm->p_fsm_ultrasound_rear);
+	fsm_display_suspend(p_fsm->p_fsm_display_rear);
+	fsm_buzzer_suspend(p_fsm->p_fsm_buzzer_rear);
+}
+/** 
 * @brief comprueba la actividad
 * @param p_this estuctura fsm_t
 * @return si esta activo
@@ -51,15 +69,13 @@ static bool 	check_activity (fsm_t *p_this){
 }//Check if any of the elements of the system is active.
 /** 
 * @brief comprueba si esta encendido
+* @note se cumple en cuanto el boton lleva pulsado el tiempo de encendido, sin esperar a que se suelte
 * @param p_this estuctura fsm_t
 * @return si esta encendido
 */
 static bool 	check_on (fsm_t *p_this){
 	fsm_urbanite_t *p_fsm = (fsm_urbanite_t *)(p_this);
-	uint32_t duration = fsm_button_get_duration(p_fsm->p_fsm_button);
-	if (duration>0 && duration>(p_fsm->on_off_press_time_ms))
-		return true;
-	return false;
+	return fsm_button_check_hold_threshold(p_fsm->p_fsm_button, p_fsm->on_off_hold_id);
 }//Check if the button has been pressed for the required time to turn ON the Urbanite system.
  /** 
 * @brief comprueba si esta apagado
@@ -113,33 +129,47 @@ static bool 	check_activity_in_measure (fsm_t *p_this){
 static void 	do_start_up_measure (fsm_t *p_this){
 	fsm_urbanite_t *p_fsm = (fsm_urbanite_t *)(p_this);
 	fsm_button_reset_duration(p_fsm->p_fsm_button);
+	fsm_button_reset_hold_threshold(p_fsm->p_fsm_button, p_fsm->on_off_hold_id);
+	fsm_ultrasound_resume(p_fsm->p_fsm_ultrasound_rear);
+	fsm_display_resume(p_fsm->p_fsm_display_rear);
+	fsm_buzzer_resume(p_fsm->p_fsm_buzzer_rear);
 	fsm_ultrasound_start(p_fsm->p_fsm_ultrasound_rear);
+	p_fsm->zone = ZONE_NONE;
+	fsm_display_request_sweep(p_fsm->p_fsm_display_rear);
 	fsm_display_set_status(p_fsm->p_fsm_display_rear,true);
 	fsm_buzzer_set_status(p_fsm->p_fsm_buzzer_rear,true);
-	printf("[URBANITE][%ld] Urbanite system ON\n", port_system_get_millis());
+	FSM_STATS_INC(p_fsm, switch_ons);
+	BOOT_TIMELINE_MARK(BOOT_STAGE_URBANITE_ON);
+	LOGGER_INFO("[URBANITE][%ld] Urbanite system ON\n", port_system_get_millis());
 }//Turn the Urbanite system ON.
  /** 
-* @brief pasa al display la distancia medida
+* @brief pasa al display y al buzzer la distancia medida y su zona, clasificada una sola vez con histeresis
 * @param p_this estuctura fsm_t
 */
 static void 	do_display_distance (fsm_t *p_this){
 	fsm_urbanite_t *p_fsm = (fsm_urbanite_t *)(p_this);
 	uint32_t distance_cm =  fsm_ultrasound_get_distance(p_fsm->p_fsm_ultrasound_rear);
+	p_fsm->zone = zones_classify((int32_t)distance_cm, p_fsm->zone);
+	FSM_STATS_INC(p_fsm, distances);
 	if(p_fsm->is_paused){
-		if(distance_cm < WARNING_MIN_CM/2){
-			fsm_display_set_distance(p_fsm->p_fsm_display_rear,distance_cm);
-			fsm_buzzer_set_distance(p_fsm->p_fsm_buzzer_rear,distance_cm);
+		if(distance_cm < zones_get_max_cm(ZONE_DANGER)/2){
+			fsm_display_resume(p_fsm->p_fsm_display_rear);
+			fsm_buzzer_resume(p_fsm->p_fsm_buzzer_rear);
+			fsm_display_set_zone(p_fsm->p_fsm_display_rear,distance_cm,p_fsm->zone);
+			fsm_buzzer_set_zone(p_fsm->p_fsm_buzzer_rear,distance_cm,p_fsm->zone);
 			fsm_display_set_status(p_fsm->p_fsm_display_rear,true);
 			fsm_buzzer_set_status(p_fsm->p_fsm_buzzer_rear,true);
 		}else{
 			fsm_display_set_status(p_fsm->p_fsm_display_rear,false);
 			fsm_buzzer_set_status(p_fsm->p_fsm_buzzer_rear,false);
+			fsm_display_suspend(p_fsm->p_fsm_display_rear);
+			fsm_buzzer_suspend(p_fsm->p_fsm_buzzer_rear);
 		}
 	}else{
-		fsm_display_set_distance(p_fsm->p_fsm_display_rear,distance_cm);
-		fsm_buzzer_set_distance(p_fsm->p_fsm_buzzer_rear,distance_cm);
+		fsm_display_set_zone(p_fsm->p_fsm_display_rear,distance_cm,p_fsm->zone);
+		fsm_buzzer_set_zone(p_fsm->p_fsm_buzzer_rear,distance_cm,p_fsm->zone);
 	}
-	printf("[URBANITE][%ld] Distance: %ld cm\n", port_system_get_millis(), distance_cm);
+	LOGGER_INFO("[URBANITE][%ld] Distance: %ld cm\n", port_system_get_millis(), distance_cm);
 }//Display the distance measured by the ultrasound sensor.
  /** 
 * @brief pauda el display
@@ -149,6 +179,7 @@ static void 	do_pause_display (fsm_t *p_this){
 	fsm_urbanite_t *p_fsm = (fsm_urbanite_t *)(p_this);
 	fsm_button_reset_duration(p_fsm->p_fsm_button);
 	p_fsm->state = (p_fsm->state + 1) % NUM_STATES;
+	FSM_STATS_INC(p_fsm, mode_changes);
 
 	if (p_fsm->state == STATE_PAUSED)
 		p_fsm->is_paused = true;
@@ -160,17 +191,24 @@ static void 	do_pause_display (fsm_t *p_this){
 	else
 		fsm_buzzer_continuous_state(p_fsm->p_fsm_buzzer_rear);
 
+	if (p_fsm->is_paused){
+		fsm_display_suspend(p_fsm->p_fsm_display_rear);
+		fsm_buzzer_suspend(p_fsm->p_fsm_buzzer_rear);
+	}else{
+		fsm_display_resume(p_fsm->p_fsm_display_rear);
+		fsm_buzzer_resume(p_fsm->p_fsm_buzzer_rear);
+	}
 	fsm_display_set_status(p_fsm->p_fsm_display_rear,!(p_fsm->is_paused));
 	fsm_buzzer_set_status(p_fsm->p_fsm_buzzer_rear,!(p_fsm->is_paused));
 	
 	if (p_fsm->state == STATE_PAUSED)
-		printf("[URBANITE][%ld] Urbanite system display PAUSE\n", port_system_get_millis());
+		LOGGER_INFO("[URBANITE][%ld] Urbanite system display PAUSE\n", port_system_get_millis());
 	if (p_fsm->state == STATE_PULSED){
-		printf("[URBANITE][%ld] Urbanite system display RESUME\n", port_system_get_millis());
-		printf("[URBANITE][%ld] Urbanite system PULSED display\n", port_system_get_millis());
+		LOGGER_INFO("[URBANITE][%ld] Urbanite system display RESUME\n", port_system_get_millis());
+		LOGGER_INFO("[URBANITE][%ld] Urbanite system PULSED display\n", port_system_get_millis());
 	}
 	if (p_fsm->state == STATE_CONTINUOUS)
-		printf("[URBANITE][%ld] Urbanite system CONTINUOUS display\n", port_system_get_millis());
+		LOGGER_INFO("[URBANITE][%ld] Urbanite system CONTINUOUS display\n", port_system_get_millis());
 }//Pause or resume the display system.
  /** 
 * @brief pausa el urbanite
@@ -179,40 +217,40 @@ static void 	do_pause_display (fsm_t *p_this){
 static void 	do_stop_urbanite (fsm_t *p_this){
 	fsm_urbanite_t *p_fsm = (fsm_urbanite_t *)(p_this);
 	fsm_button_reset_duration(p_fsm->p_fsm_button);
+	fsm_button_reset_hold_threshold(p_fsm->p_fsm_button, p_fsm->on_off_hold_id);
 	fsm_ultrasound_stop(p_fsm->p_fsm_ultrasound_rear);
 	fsm_display_set_status(p_fsm->p_fsm_display_rear,false);
 	fsm_buzzer_set_status(p_fsm->p_fsm_buzzer_rear,false);
+	_suspend_peripherals(p_fsm);
 	p_fsm->is_paused = false;
-	printf("[URBANITE][%ld] Urbanite system OFF\n", port_system_get_millis());
+	LOGGER_INFO("[URBANITE][%ld] Urbanite system OFF\n", port_system_get_millis());
+
+	//Al apagar ya ha pasado por todos los modos: el pico de la pila y del heap sirve para ajustar la RAM reservada
+	port_system_memory_t memory;
+	port_system_get_memory(&memory);
+	LOGGER_INFO("[URBANITE] Memoria: pila %ld B, heap %ld B, margen %ld B\n", memory.stack_peak, memory.heap_peak, memory.margin);
+#ifdef USE_FSM_STATS
+	fsm_ultrasound_stats_t *p_us_stats = fsm_ultrasound_get_stats(p_fsm->p_fsm_ultrasound_rear);
+	LOGGER_INFO("[URBANITE] Ultrasonidos: %ld medidas, %ld ecos sin volver, %ld atipicos\n", p_us_stats->measurements, p_us_stats->echo_timeouts, p_us_stats->outliers);
+	LOGGER_INFO("[URBANITE] Cambios: display %ld, buzzer %ld\n", fsm_display_get_stats(p_fsm->p_fsm_display_rear)->reconfigs, fsm_buzzer_get_stats(p_fsm->p_fsm_buzzer_rear)->reconfigs);
+#endif
 }//Turn the Urbanite system OFF.
 /** 
-* @brief pasa a low power mode
+* @brief pasa a low power mode (modo Stop): el planificador dormira en Stop mientras no haya plazos pendientes
+* @note con la Urbanite apagada y sin actividad el boton esta en BUTTON_RELEASED, asi que no hay plazos por software y solo despierta la EXTI del boton
 * @param p_this estuctura fsm_t
 */
 static void 	do_sleep_off (fsm_t *p_this){
-	port_system_sleep();
+	scheduler_set_deep_sleep(true);
 }//Start the low power mode while the Urbanite is OFF.
 /** 
-* @brief pasa a low power mode
+* @brief sale del low power mode (modo Stop): con actividad el planificador vuelve a dormir en modo Sleep, porque los timers no cuentan en Stop
 * @param p_this estuctura fsm_t
 */
-static void 	do_sleep_while_off (fsm_t *p_this){
-	port_system_sleep();
-}//Start the low power mode while the Urbanite is awakened by a debug breakpoint or similar in the SLEEP_WHILE_OFF state.
- /** 
-* @brief pasa a low power mode
-* @param p_this estuctura fsm_t
-*/
-static void 	do_sleep_while_on (fsm_t *p_this){
-	port_system_sleep();
-}//Start the low power mode while the Urbanite is awakened by a debug breakpoint or similar in the SLEEP_WHILE_ON state.
- /** 
-* @brief pasa a low power mode
-* @param p_this estuctura fsm_t
-*/
-static void 	do_sleep_while_measure (fsm_t *p_this){
-	port_system_sleep();
-}//Start the low power mode while the Urbanite is measuring the distance and it is waiting for a new measurement.
+static void 	do_wake_while_off (fsm_t *p_this){
+	scheduler_set_deep_sleep(false);
+	LOGGER_DEBUG("[URBANITE] Despertar de Stop: %ld us\n", port_system_get_wake_us());
+}//Leave the low power mode while the Urbanite is OFF.
 /**
 * @brief maquina de estados del urbanite
 */
@@ -221,12 +259,13 @@ fsm_trans_t 	fsm_trans_urbanite [] = {
 	{MEASURE,check_off,OFF,do_stop_urbanite},
 	{MEASURE,check_pause_display,MEASURE,do_pause_display},
 	{MEASURE,check_new_measure,MEASURE,do_display_distance},
-	{MEASURE,check_no_activity,SLEEP_WHILE_ON,do_sleep_while_measure},
+	{MEASURE,check_no_activity,SLEEP_WHILE_ON,NULL},
+	{SLEEP_WHILE_ON,check_on,MEASURE,NULL},
 	{SLEEP_WHILE_ON,check_activity_in_measure,MEASURE,NULL},
-	{SLEEP_WHILE_ON,check_no_activity,SLEEP_WHILE_ON,do_sleep_while_on},
+	{SLEEP_WHILE_ON,check_no_activity,SLEEP_WHILE_ON,NULL},
 	{OFF,check_no_activity,SLEEP_WHILE_OFF,do_sleep_off},
-	{SLEEP_WHILE_OFF,check_activity,OFF,NULL},
-	{SLEEP_WHILE_OFF,check_no_activity,SLEEP_WHILE_OFF,do_sleep_while_off},
+	{SLEEP_WHILE_OFF,check_activity,OFF,do_wake_while_off},
+	{SLEEP_WHILE_OFF,check_no_activity,SLEEP_WHILE_OFF,NULL},
 	{-1,NULL,-1,NULL}
 };
  /**
@@ -241,14 +280,21 @@ fsm_trans_t 	fsm_trans_urbanite [] = {
  */
 static void 	fsm_urbanite_init (fsm_urbanite_t *p_fsm_urbanite, fsm_button_t *p_fsm_button, uint32_t on_off_press_time_ms, uint32_t pause_display_time_ms, fsm_ultrasound_t *p_fsm_ultrasound_rear, fsm_display_t *p_fsm_display_rear, fsm_buzzer_t *p_fsm_buzzer_rear){
 	fsm_init(&p_fsm_urbanite->f, fsm_trans_urbanite);
+#ifdef USE_FSM_STATS
+	p_fsm_urbanite->stats = (fsm_urbanite_stats_t){0};
+#endif
 	p_fsm_urbanite->p_fsm_button = p_fsm_button;
 	p_fsm_urbanite->on_off_press_time_ms = on_off_press_time_ms;
+	p_fsm_urbanite->on_off_hold_id = fsm_button_add_hold_threshold(p_fsm_button, on_off_press_time_ms);
 	p_fsm_urbanite->pause_display_time_ms = pause_display_time_ms;
 	p_fsm_urbanite->p_fsm_ultrasound_rear = p_fsm_ultrasound_rear;
 	p_fsm_urbanite->p_fsm_display_rear = p_fsm_display_rear;
 	p_fsm_urbanite->p_fsm_buzzer_rear = p_fsm_buzzer_rear;
 	p_fsm_urbanite->is_paused = false;
 	p_fsm_urbanite->state = STATE_PULSED;
+	p_fsm_urbanite->zone = ZONE_NONE;
+	/* La Urbanite arranca apagada */
+	_suspend_peripherals(p_fsm_urbanite);
 }//Create a new Urbanite FSM.
  
 fsm_urbanite_t * 	fsm_urbanite_new (fsm_button_t *p_fsm_button, uint32_t on_off_press_time_ms, uint32_t pause_display_time_ms, fsm_ultrasound_t *p_fsm_ultrasound_rear, fsm_display_t *p_fsm_display_rear,fsm_buzzer_t *p_fsm_buzzer_rear){
@@ -264,3 +310,17 @@ void 	fsm_urbanite_fire (fsm_urbanite_t *p_fsm_urbanite){
 void 	fsm_urbanite_destroy (fsm_urbanite_t *p_fsm){
 	free(&p_fsm->f);
 }//Destroy an Urbanite FSM.
+
+fsm_t * 	fsm_urbanite_get_inner_fsm (fsm_urbanite_t *p_fsm){
+	return &(p_fsm->f);
+}//Get the inner FSM of the Urbanite.
+
+bool 	fsm_urbanite_get_next_deadline (fsm_urbanite_t *p_fsm, uint32_t *p_deadline_ms){
+	return fsm_button_get_next_hold_deadline(p_fsm->p_fsm_button, p_deadline_ms);
+}//Get the instant at which the button reaches the next hold threshold.
+
+#ifdef USE_FSM_STATS
+fsm_urbanite_stats_t * 	fsm_urbanite_get_stats (fsm_urbanite_t *p_fsm){
+	return &p_fsm->stats;
+}
+#endif
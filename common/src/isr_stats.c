@@ -0,0 +1,140 @@
+/**
+ * @file isr_stats.c
+ * @brief Histogramas logaritmicos de la latencia, la duracion y el tiempo expropiado de cada rutina de interrupcion.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-19
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <string.h>
+#include "port_system.h"
+#include "isr_stats.h"
+
+/* Typedefs --------------------------------------------------------------------*/
+/**
+ * @brief Rutina activa, en la pila de rutinas anidadas
+ */
+typedef struct
+{
+	uint32_t start_cycles; //ciclos al entrar
+	uint32_t preempted_cycles; //ciclos de las rutinas anidadas que ya han salido
+} isr_stats_frame_t;
+
+/* Global variables */
+isr_stats_t 	isr_stats [TRACE_ISR_NUM]; /*!< Estadisticas de cada rutina. Global para leerlas desde el depurador */
+
+static isr_stats_frame_t 	isr_stats_frames [ISR_STATS_MAX_NESTING]; /*!< Rutinas activas, de la mas externa a la mas interna */
+static volatile uint32_t 	isr_stats_depth = 0; /*!< Rutinas activas */
+static const char 	*isr_stats_names [TRACE_ISR_NUM] = {"TIM11", "EXTI15_10", "TIM10", "TIM2", "TIM3", "TIM5"}; /*!< Nombre de cada rutina de `TRACE_ISRS` */
+
+/* Private functions -----------------------------------------------------------*/
+/**
+ * @brief Suma un valor a un histograma
+ *
+ * @param p_hist histograma
+ * @param value valor en ciclos
+ */
+static void 	_hist_add (isr_stats_hist_t *p_hist, uint32_t value){
+	if (p_hist->count == 0 || value < p_hist->min)
+		p_hist->min = value;
+	if (value > p_hist->max)
+		p_hist->max = value;
+	p_hist->count++;
+	p_hist->sum += value;
+	p_hist->buckets[isr_stats_bucket(value)]++;
+}
+
+/**
+ * @brief Escribe un histograma: minimo, media y maximo, y las cubetas no vacias con su rango en microsegundos
+ *
+ * @param p_file fichero de salida
+ * @param p_label nombre del histograma
+ * @param p_hist histograma
+ * @param cycles_per_us ciclos por microsegundo
+ */
+static void 	_dump_hist (FILE *p_file, const char *p_label, const isr_stats_hist_t *p_hist, uint32_t cycles_per_us){
+	if (p_hist->count == 0)
+		return;
+	fprintf(p_file, "  %-10s n=%lu min=%lu avg=%lu max=%lu ciclos\n", p_label, (unsigned long)p_hist->count,
+			(unsigned long)p_hist->min, (unsigned long)(p_hist->sum / p_hist->count), (unsigned long)p_hist->max);
+	for (uint32_t b = 0; b < ISR_STATS_BUCKETS; b++){
+		if (p_hist->buckets[b] == 0)
+			continue;
+		uint32_t low = (b == 0) ? 0 : 1UL << (b - 1U);
+		fprintf(p_file, "    >= %7lu ciclos (%5lu us): %lu\n", (unsigned long)low, (unsigned long)(low / cycles_per_us),
+				(unsigned long)p_hist->buckets[b]);
+	}
+}
+
+/* Public functions -----------------------------------------------------------*/
+void 	isr_stats_enter (uint8_t isr_id, uint32_t latency_cycles){
+	uint32_t now = port_system_get_cycles();
+	//Se reserva el nivel antes de escribirlo: una rutina que entre en medio usa el siguiente y sale antes
+	uint32_t depth = isr_stats_depth;
+	isr_stats_depth = depth + 1U;
+	if (isr_id >= TRACE_ISR_NUM)
+		return;
+
+	isr_stats_t *p_stats = &isr_stats[isr_id];
+	uint32_t sp = (uint32_t)(uintptr_t)__builtin_frame_address(0);
+	if (p_stats->stack_min_sp == 0 || sp < p_stats->stack_min_sp)
+		p_stats->stack_min_sp = sp;
+	p_stats->nesting[(depth < ISR_STATS_MAX_NESTING) ? depth : ISR_STATS_MAX_NESTING - 1U]++;
+	if (latency_cycles != ISR_STATS_LATENCY_UNKNOWN)
+		_hist_add(&p_stats->latency, latency_cycles);
+	if (depth < ISR_STATS_MAX_NESTING){
+		isr_stats_frames[depth].start_cycles = now;
+		isr_stats_frames[depth].preempted_cycles = 0;
+	}
+}
+
+void 	isr_stats_exit (uint8_t isr_id){
+	uint32_t now = port_system_get_cycles();
+	uint32_t depth = isr_stats_depth;
+	if (depth == 0)
+		return;
+	depth--;
+	if (depth < ISR_STATS_MAX_NESTING && isr_id < TRACE_ISR_NUM){
+		isr_stats_t *p_stats = &isr_stats[isr_id];
+		uint32_t total = now - isr_stats_frames[depth].start_cycles;
+		uint32_t preempted = isr_stats_frames[depth].preempted_cycles;
+		_hist_add(&p_stats->duration, total - preempted);
+		if (preempted > 0)
+			_hist_add(&p_stats->preempted, preempted);
+		//Todo el tiempo de esta rutina, anidadas incluidas, se lo ha quitado a la que expropio
+		if (depth > 0 && depth <= ISR_STATS_MAX_NESTING)
+			isr_stats_frames[depth - 1U].preempted_cycles += total;
+	}
+	isr_stats_depth = depth;
+}
+
+const isr_stats_t * 	isr_stats_get (uint8_t isr_id){
+	return (isr_id < TRACE_ISR_NUM) ? &isr_stats[isr_id] : NULL;
+}
+
+void 	isr_stats_reset (void){
+	memset(isr_stats, 0, sizeof(isr_stats));
+}
+
+void 	isr_stats_dump (FILE *p_file){
+	uint32_t cycles_per_us = port_system_get_cycles_per_us();
+	port_system_memory_t memory;
+	port_system_get_memory(&memory);
+	for (uint32_t i = 0; i < TRACE_ISR_NUM; i++){
+		const isr_stats_t *p_stats = &isr_stats[i];
+		if (p_stats->duration.count == 0)
+			continue;
+		fprintf(p_file, "%s: anidamiento", isr_stats_names[i]);
+		for (uint32_t d = 0; d < ISR_STATS_MAX_NESTING; d++){
+			fprintf(p_file, " %lu", (unsigned long)p_stats->nesting[d]);
+		}
+		if (memory.stack_top != 0)
+			fprintf(p_file, ", pila al entrar hasta %lu bytes", (unsigned long)(memory.stack_top - p_stats->stack_min_sp));
+		fprintf(p_file, "\n");
+		_dump_hist(p_file, "latencia", &p_stats->latency, cycles_per_us);
+		_dump_hist(p_file, "duracion", &p_stats->duration, cycles_per_us);
+		_dump_hist(p_file, "expropiada", &p_stats->preempted, cycles_per_us);
+	}
+}
@@ -0,0 +1,90 @@
+/**
+ * @file logger.c
+ * @brief Registro diferido en binario en un buffer circular en RAM, que se vacia antes de dormir.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-16
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdio.h>
+#include "port_system.h"
+#include "logger.h"
+
+/* Defines ----------------------------------------------------------*/
+#define LOGGER_BUFFER_MASK (LOGGER_BUFFER_WORDS - 1U) /*!< Mascara de los indices del buffer */
+#define LOGGER_RECORD_MAX_WORDS (LOGGER_HEADER_WORDS + LOGGER_MAX_ARGS) /*!< Palabras del registro mas largo */
+
+/* Global variables */
+static uint32_t 	logger_buffer [LOGGER_BUFFER_WORDS]; /*!< Buffer circular de registros */
+static uint32_t 	logger_head = 0; /*!< Palabras escritas desde el arranque: indice de escritura sin mascara */
+static uint32_t 	logger_tail = 0; /*!< Palabras leidas desde el arranque: indice de lectura sin mascara */
+static uint32_t 	logger_dropped = 0; /*!< Registros perdidos por no caber */
+
+/* Private functions -----------------------------------------------------------*/
+/**
+ * @brief Saca todos los registros del buffer por la salida elegida al compilar
+ */
+static void 	_drain (void){
+	uint32_t record[LOGGER_RECORD_MAX_WORDS] = {0};
+	uint32_t words;
+	while ((words = logger_read(record, LOGGER_RECORD_MAX_WORDS)) > 0){
+#ifdef LOGGER_BINARY
+		port_system_log_write(record, words);
+#else
+		//Los formatos usan %ld y %lu: los argumentos se pasan como long. Los que no usa el formato se ignoran
+		const char *p_fmt = (const char *)(uintptr_t)record[1];
+		printf(p_fmt, (long)record[2], (long)record[3], (long)record[4], (long)record[5], (long)record[6], (long)record[7]);
+#endif
+	}
+}
+
+/* Public functions -----------------------------------------------------------*/
+bool 	logger_write (uint32_t level, const char *p_fmt, const uint32_t *p_args, uint32_t num_args){
+	if (num_args > LOGGER_MAX_ARGS)
+		num_args = LOGGER_MAX_ARGS;
+	uint32_t words = LOGGER_HEADER_WORDS + num_args;
+	if (LOGGER_BUFFER_WORDS - (logger_head - logger_tail) < words){
+		logger_dropped++;
+		return false;
+	}
+
+	uint32_t head = logger_head;
+	logger_buffer[head++ & LOGGER_BUFFER_MASK] = LOGGER_HEADER(level, num_args);
+	logger_buffer[head++ & LOGGER_BUFFER_MASK] = (uint32_t)(uintptr_t)p_fmt;
+	for (uint32_t i = 0; i < num_args; i++){
+		logger_buffer[head++ & LOGGER_BUFFER_MASK] = p_args[i];
+	}
+	logger_head = head;
+	return true;
+}
+
+uint32_t 	logger_read (uint32_t *p_words, uint32_t max_words){
+	if (logger_tail == logger_head)
+		return 0;
+	uint32_t words = LOGGER_HEADER_WORDS + (logger_buffer[logger_tail & LOGGER_BUFFER_MASK] & 0xFFU);
+	if (words > max_words)
+		return 0;
+	for (uint32_t i = 0; i < words; i++){
+		p_words[i] = logger_buffer[(logger_tail + i) & LOGGER_BUFFER_MASK];
+	}
+	logger_tail += words;
+	return words;
+}
+
+uint32_t 	logger_take_dropped (void){
+	uint32_t dropped = logger_dropped;
+	logger_dropped = 0;
+	return dropped;
+}
+
+void 	logger_flush (void){
+	_drain();
+	//Con el buffer ya vacio el aviso de registros perdidos siempre cabe
+	uint32_t dropped = logger_take_dropped();
+	if (dropped > 0){
+		LOGGER_WARN("[LOGGER] %lu registros perdidos\n", dropped);
+		_drain();
+	}
+}
@@ -0,0 +1,46 @@
+/**
+ * @file profiler.c
+ * @brief Perfilador estadistico: histograma de las direcciones de programa interrumpidas por una interrupcion periodica.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-20
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <string.h>
+#include "port_system.h"
+#include "profiler.h"
+
+/* Global variables */
+profiler_hist_t 	profiler_hist = {.magic = PROFILER_MAGIC, .bucket_shift = PROFILER_BUCKET_SHIFT, .num_buckets = PROFILER_BUCKETS}; /*!< Histograma. Global para encontrarlo en el ELF al volcar la memoria */
+
+/* Public functions -----------------------------------------------------------*/
+void 	profiler_start (uint32_t hz){
+	profiler_reset();
+	profiler_hist.code_base = port_system_profiler_start(hz);
+}
+
+void 	profiler_stop (void){
+	port_system_profiler_stop();
+}
+
+void 	profiler_sample (uint32_t pc){
+	//Las instrucciones Thumb van en direcciones pares: el bit 0 no es parte de la direccion
+	uint32_t bucket = ((pc & ~1U) - profiler_hist.code_base) >> PROFILER_BUCKET_SHIFT;
+	profiler_hist.samples++;
+	if (bucket < PROFILER_BUCKETS)
+		profiler_hist.buckets[bucket]++;
+	else
+		profiler_hist.out_of_range++;
+}
+
+void 	profiler_reset (void){
+	profiler_hist.samples = 0;
+	profiler_hist.out_of_range = 0;
+	memset(profiler_hist.buckets, 0, sizeof(profiler_hist.buckets));
+}
+
+const profiler_hist_t * 	profiler_get_hist (void){
+	return &profiler_hist;
+}
@@ -0,0 +1,181 @@
+/**
+ * @file scheduler.c
+ * @brief Cooperative scheduler for the FSMs of the system. Each FSM is fired only when it has something to do.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-02
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdlib.h>
+#include "port_system.h"
+#include "fsm.h"
+#include "scheduler.h"
+#include "logger.h"
+#include "trace.h"
+#include "fsm_stats.h"
+
+/* Typedefs --------------------------------------------------------------------*/
+/**
+* @brief tiene la FSM, su prioridad, los eventos que la despiertan, los que publica, la funcion de plazo y si esta pendiente de dispararse
+*/
+typedef struct
+{
+	fsm_t 	*p_fsm;
+	uint8_t 	priority;
+	uint32_t 	events_in;
+	uint32_t 	events_out_always;
+	uint32_t 	events_out_on_change;
+	scheduler_deadline_func_t 	get_deadline;
+	bool 	due;
+#ifdef USE_FSM_STATS
+	fsm_stats_t 	*p_stats;
+#endif
+} scheduler_task_t;
+
+/* Global variables */
+static scheduler_task_t 	tasks_arr [SCHEDULER_MAX_TASKS];
+static uint32_t 	num_tasks = 0;
+static bool 	deep_sleep = false; /*!< Si al dormir se entra en modo Stop en lugar de en modo Sleep */
+
+/* Private functions -----------------------------------------------------------*/
+/**
+* @brief marca como pendientes las FSM suscritas a alguno de los eventos
+* @param events mascara de eventos publicados
+*/
+static void 	_post (uint32_t events){
+	if (events == 0) return;
+	for (uint32_t i = 0; i < num_tasks; i++){
+		if (tasks_arr[i].events_in & events)
+			tasks_arr[i].due = true;
+	}
+}
+
+/**
+* @brief marca como pendientes las FSM cuyo plazo ya ha vencido
+* @param now_ms instante actual
+*/
+static void 	_check_deadlines (uint32_t now_ms){
+	uint32_t deadline_ms;
+	for (uint32_t i = 0; i < num_tasks; i++){
+		scheduler_task_t *p_task = &tasks_arr[i];
+		if (p_task->get_deadline && p_task->get_deadline(p_task->p_fsm, &deadline_ms) && ((int32_t)(now_ms - deadline_ms) >= 0))
+			p_task->due = true;
+	}
+}
+
+/**
+* @brief busca el plazo mas proximo de todas las FSM
+* @param p_deadline_ms donde se devuelve el plazo mas proximo
+* @return true si alguna FSM tiene un plazo pendiente
+*/
+static bool 	_next_deadline (uint32_t *p_deadline_ms){
+	bool found = false;
+	uint32_t deadline_ms;
+	for (uint32_t i = 0; i < num_tasks; i++){
+		scheduler_task_t *p_task = &tasks_arr[i];
+		if (!p_task->get_deadline || !p_task->get_deadline(p_task->p_fsm, &deadline_ms))
+			continue;
+		/* Comparacion con signo para que funcione al dar la vuelta el contador de milisegundos */
+		if (!found || (int32_t)(deadline_ms - *p_deadline_ms) < 0){
+			*p_deadline_ms = deadline_ms;
+			found = true;
+		}
+	}
+	return found;
+}
+
+/**
+* @brief hace una pasada por las FSM pendientes en orden de prioridad
+* @return si se ha disparado alguna FSM
+*/
+static bool 	_sweep (void){
+	bool fired = false;
+	for (uint32_t i = 0; i < num_tasks; i++){
+		scheduler_task_t *p_task = &tasks_arr[i];
+		if (!p_task->due)
+			continue;
+		p_task->due = false;
+		fired = true;
+
+		int32_t state = p_task->p_fsm->current_state;
+		TRACE_FSM_BEGIN(start_us);
+		fsm_fire(p_task->p_fsm);
+		TRACE_FSM_END(p_task->priority, start_us, p_task->p_fsm, state);
+#ifdef USE_FSM_STATS
+		if (p_task->p_stats)
+			fsm_stats_fire(p_task->p_stats, p_task->p_fsm, state, port_system_get_millis());
+#endif
+		if (p_task->p_fsm->current_state != state){
+			/* Desde el nuevo estado puede haber otra transicion habilitada */
+			p_task->due = true;
+			_post(p_task->events_out_on_change);
+		}
+		_post(p_task->events_out_always);
+	}
+	return fired;
+}
+
+/* Public functions -----------------------------------------------------------*/
+bool 	scheduler_add_task (fsm_t *p_fsm, uint8_t priority, uint32_t events_in, uint32_t events_out_always, uint32_t events_out_on_change, scheduler_deadline_func_t get_deadline){
+	if (num_tasks >= SCHEDULER_MAX_TASKS)
+		return false;
+
+	/* Insercion ordenada por prioridad: las pasadas recorren el array en orden */
+	uint32_t idx = num_tasks;
+	while (idx > 0 && tasks_arr[idx - 1].priority > priority){
+		tasks_arr[idx] = tasks_arr[idx - 1];
+		idx--;
+	}
+	tasks_arr[idx] = (scheduler_task_t){
+		.p_fsm = p_fsm,
+		.priority = priority,
+		.events_in = events_in,
+		.events_out_always = events_out_always,
+		.events_out_on_change = events_out_on_change,
+		.get_deadline = get_deadline,
+		.due = true, /* Todas se disparan una vez al arrancar */
+	};
+	num_tasks++;
+	return true;
+}
+
+#ifdef USE_FSM_STATS
+bool 	scheduler_set_stats (fsm_t *p_fsm, fsm_stats_t *p_stats){
+	for (uint32_t i = 0; i < num_tasks; i++){
+		if (tasks_arr[i].p_fsm == p_fsm){
+			tasks_arr[i].p_stats = p_stats;
+			return true;
+		}
+	}
+	return false;
+}
+#endif
+
+void 	scheduler_set_deep_sleep (bool enable){
+	deep_sleep = enable;
+}
+
+void 	scheduler_run (void){
+	_post(port_system_take_events());
+	_check_deadlines(port_system_get_millis());
+
+	for (uint32_t sweep = 0; sweep < SCHEDULER_MAX_SWEEPS; sweep++){
+		if (!_sweep()){
+			/* No queda nada pendiente: se sacan los registros y se duerme hasta el siguiente evento o plazo */
+			logger_flush();
+			uint32_t deadline_ms = 0;
+			if (_next_deadline(&deadline_ms)){
+				/* Los timers no cuentan en Stop: con un plazo pendiente solo se puede dormir en Sleep */
+				port_system_set_wakeup_ms(deadline_ms);
+				port_system_sleep();
+			}else if (deep_sleep){
+				port_system_deep_sleep();
+			}else{
+				port_system_sleep();
+			}
+			return;
+		}
+	}
+}
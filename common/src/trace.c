@@ -0,0 +1,160 @@
+/**
+ * @file trace.c
+ * @brief Traza de los disparos de las FSM y de las interrupciones en un buffer circular en RAM, exportable al formato de trazas de Chrome/Perfetto.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-18
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <string.h>
+#include "port_system.h"
+#include "trace.h"
+
+/* Defines ----------------------------------------------------------*/
+#define TRACE_BUFFER_MASK (TRACE_BUFFER_RECORDS - 1U) /*!< Mascara de los indices del buffer */
+#define TRACE_PID_FSM 1 /*!< Proceso de las FSM en la exportacion */
+#define TRACE_PID_ISR 2 /*!< Proceso de las rutinas de interrupcion en la exportacion */
+
+/* Global variables */
+trace_ring_t 	trace_ring = {.magic = TRACE_MAGIC, .num_records = TRACE_BUFFER_RECORDS, .record_size = sizeof(trace_record_t)}; /*!< Buffer de la traza. Global para encontrarlo en el ELF al volcar la memoria */
+
+static const char 	*trace_fsm_names [TRACE_MAX_FSMS] = {0}; /*!< Nombre de cada FSM, segun su prioridad, para la exportacion */
+static const char 	*trace_isr_names [TRACE_ISR_NUM] = {"TIM11", "EXTI15_10", "TIM10", "TIM2", "TIM3", "TIM5"}; /*!< Nombre de cada rutina de `TRACE_ISRS` */
+
+/* Private functions -----------------------------------------------------------*/
+/**
+ * @brief Busca en la tabla de transiciones la que ha llevado de un estado a otro
+ *
+ * `fsm_fire()` no dice que transicion ha tomado, asi que solo se da su indice cuando es la unica posible: una sola
+ * transicion entre dos estados distintos. Entre un estado y el mismo no se sabe si se ha tomado una transicion a si
+ * mismo o ninguna, y con varias transiciones entre los dos estados no se sabe que guarda se ha cumplido.
+ *
+ * @param p_fsm FSM
+ * @param from estado de origen
+ * @param to estado de destino
+ * @return indice en la tabla, `TRACE_GUARD_NONE` si no hay ninguna o `TRACE_GUARD_UNKNOWN` si no se puede saber cual
+ */
+static uint8_t 	_guard_index (const fsm_t *p_fsm, int32_t from, int32_t to){
+	const fsm_trans_t *p_t = p_fsm->p_tt;
+	uint8_t guard = TRACE_GUARD_NONE;
+	for (uint32_t i = 0; p_t[i].orig_state >= 0 && i < TRACE_GUARD_UNKNOWN; i++){
+		if (p_t[i].orig_state != from || p_t[i].dest_state != to)
+			continue;
+		if (guard != TRACE_GUARD_NONE || from == to)
+			return TRACE_GUARD_UNKNOWN;
+		guard = (uint8_t)i;
+	}
+	return guard;
+}
+
+/**
+ * @brief Escribe el indice de la transicion de un disparo en la exportacion
+ *
+ * @param p_file fichero de salida
+ * @param guard indice en la tabla, `TRACE_GUARD_NONE` o `TRACE_GUARD_UNKNOWN`
+ */
+static void 	_export_guard (FILE *p_file, uint8_t guard){
+	if (guard == TRACE_GUARD_NONE)
+		fprintf(p_file, "null");
+	else if (guard == TRACE_GUARD_UNKNOWN)
+		fprintf(p_file, "\"unknown\"");
+	else
+		fprintf(p_file, "%u", guard);
+}
+
+/**
+ * @brief Escribe el nombre de un hilo en la exportacion
+ *
+ * @param p_file fichero de salida
+ * @param pid proceso
+ * @param tid hilo
+ * @param p_name nombre
+ */
+static void 	_export_thread_name (FILE *p_file, uint32_t pid, uint32_t tid, const char *p_name){
+	fprintf(p_file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%lu,\"tid\":%lu,\"args\":{\"name\":\"%s\"}},\n",
+			(unsigned long)pid, (unsigned long)tid, p_name);
+}
+
+/**
+ * @brief Guarda un registro en el buffer, sobrescribiendo el mas antiguo si esta lleno
+ *
+ * @note Una interrupcion puede grabar a la vez: cada llamada reserva su hueco con una operacion atomica antes de escribirlo.
+ * @param type `TRACE_TYPES`
+ * @param id FSM o rutina de interrupcion
+ * @param from estado antes del disparo
+ * @param to estado despues del disparo
+ * @param guard indice de la transicion
+ * @param ts_us instante del registro
+ * @param dur_us duracion del disparo
+ */
+static void 	_write (uint8_t type, uint8_t id, uint8_t from, uint8_t to, uint8_t guard, uint32_t ts_us, uint32_t dur_us){
+	uint32_t idx = __atomic_fetch_add(&trace_ring.head, 1U, __ATOMIC_RELAXED) & TRACE_BUFFER_MASK;
+	trace_record_t *p_rec = &trace_ring.records[idx];
+	p_rec->ts_us = ts_us;
+	p_rec->dur_us = dur_us;
+	p_rec->type = type;
+	p_rec->id = id;
+	p_rec->from = from;
+	p_rec->to = to;
+	p_rec->guard = guard;
+}
+
+/* Public functions -----------------------------------------------------------*/
+void 	trace_record (uint8_t type, uint8_t id){
+	_write(type, id, 0, 0, 0, port_system_get_micros(), 0);
+}
+
+void 	trace_fsm_fire (uint8_t fsm_id, uint32_t start_us, const fsm_t *p_fsm, int32_t from_state){
+	int32_t to_state = p_fsm->current_state;
+	uint32_t dur_us = port_system_get_micros() - start_us;
+	_write(TRACE_TYPE_FSM, fsm_id, (uint8_t)from_state, (uint8_t)to_state, _guard_index(p_fsm, from_state, to_state), start_us, dur_us);
+}
+
+void 	trace_reset (void){
+	trace_ring.head = 0;
+	memset(trace_ring.records, 0, sizeof(trace_ring.records));
+}
+
+void 	trace_set_fsm_name (uint8_t fsm_id, const char *p_name){
+	if (fsm_id < TRACE_MAX_FSMS)
+		trace_fsm_names[fsm_id] = p_name;
+}
+
+const trace_ring_t * 	trace_get_ring (void){
+	return &trace_ring;
+}
+
+void 	trace_export_chrome (FILE *p_file){
+	uint32_t head = trace_ring.head;
+	uint32_t first = (head > TRACE_BUFFER_RECORDS) ? head - TRACE_BUFFER_RECORDS : 0;
+
+	fprintf(p_file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(p_file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"FSM\"}},\n", TRACE_PID_FSM);
+	fprintf(p_file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"ISR\"}},\n", TRACE_PID_ISR);
+	for (uint32_t i = 0; i < TRACE_MAX_FSMS; i++){
+		if (trace_fsm_names[i])
+			_export_thread_name(p_file, TRACE_PID_FSM, i, trace_fsm_names[i]);
+	}
+	for (uint32_t i = 0; i < TRACE_ISR_NUM; i++){
+		_export_thread_name(p_file, TRACE_PID_ISR, i, trace_isr_names[i]);
+	}
+
+	for (uint32_t n = first; n < head; n++){
+		const trace_record_t *p_rec = &trace_ring.records[n & TRACE_BUFFER_MASK];
+		if (p_rec->type == TRACE_TYPE_FSM){
+			fprintf(p_file, "{\"name\":\"%u->%u\",\"ph\":\"X\",\"ts\":%lu,\"dur\":%lu,\"pid\":%d,\"tid\":%u,\"args\":{\"from\":%u,\"to\":%u,\"guard\":",
+					p_rec->from, p_rec->to, (unsigned long)p_rec->ts_us, (unsigned long)p_rec->dur_us, TRACE_PID_FSM, p_rec->id,
+					p_rec->from, p_rec->to);
+			_export_guard(p_file, p_rec->guard);
+			fprintf(p_file, "}},\n");
+		}else{
+			const char *p_name = (p_rec->id < TRACE_ISR_NUM) ? trace_isr_names[p_rec->id] : "ISR";
+			fprintf(p_file, "{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%lu,\"pid\":%d,\"tid\":%u},\n",
+					p_name, (p_rec->type == TRACE_TYPE_ISR_ENTER) ? "B" : "E", (unsigned long)p_rec->ts_us, TRACE_PID_ISR, p_rec->id);
+		}
+	}
+	//JSON no admite la coma final: se cierra con un evento de metadatos vacio
+	fprintf(p_file, "{\"name\":\"trace_end\",\"ph\":\"M\",\"pid\":%d,\"args\":{}}\n]}\n", TRACE_PID_FSM);
+}
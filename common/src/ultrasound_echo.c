@@ -0,0 +1,37 @@
+/**
+ * @file ultrasound_echo.c
+ * @brief Conversion de los ecos del ultrasonidos a distancia y mediana de las medidas. No depende del hardware.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-24
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <math.h>
+#include <stdlib.h>
+#include "ultrasound_echo.h"
+
+/* Private functions -----------------------------------------------------------*/
+// Comparison function for qsort
+/**
+* @brief hace la resta entre dos valores 
+* @param a valor al que se resta
+* @param b valor a restar
+* @return la resta de ambos valores
+*/
+static int 	_compare (const void *a, const void *b){
+    return (*(uint32_t *)a - *(uint32_t *)b);
+}
+
+/* Public functions -----------------------------------------------------------*/
+uint32_t 	ultrasound_echo_to_cm (uint32_t init_tick, uint32_t end_tick, uint32_t overflows){
+	double tiempo = ((double)end_tick + (double)overflows * ULTRASOUND_ECHO_TIMER_TICKS - (double)init_tick);
+	//us * m/s = 1e-4 cm, ida y vuelta
+	return (uint32_t)round(tiempo * ULTRASOUND_ECHO_SPEED_OF_SOUND_MS / 20000);
+}
+
+uint32_t 	ultrasound_echo_median_cm (uint32_t *p_distances_cm, uint32_t num){
+	qsort(p_distances_cm, num, sizeof(uint32_t), _compare);
+	return p_distances_cm[num / 2];
+}
@@ -0,0 +1,79 @@
+/**
+ * @file zones.c
+ * @brief Zonas de distancia que comparten el display y el buzzer, con una tabla de una zona por centimetro e histeresis.
+ * @author Eneko Emilio Sendin Gallastegi
+ * @author Rodrigo Gutierrez Fontan
+ * @date 2025-06-13
+ */
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include "zones.h"
+
+/* Global variables */
+static uint32_t 	zones_max_cm [ZONES_NUM] = {WARNING_MIN_CM, NO_PROBLEM_MIN_CM, INFO_MIN_CM, OK_MIN_CM, OK_MAX_CM}; /*!< Distancia maxima (incluida) de cada zona */
+static uint32_t 	zones_hysteresis_cm = ZONES_HYSTERESIS_CM; /*!< Banda de histeresis a cada lado de un limite */
+static uint8_t 	zones_lut [ZONES_RANGE_MAX_CM + 1]; /*!< Zona de cada centimetro, calculada en `_build_lut()` */
+static bool 	zones_lut_ready = false; /*!< Si ya se ha calculado `zones_lut` */
+static uint32_t 	zones_generation = 0; /*!< Cambia con cada cambio de limites */
+
+/* Private functions -----------------------------------------------------------*/
+/**
+ * @brief Calcula la tabla de una zona por centimetro entre 0 y `ZONES_RANGE_MAX_CM`
+ */
+static void 	_build_lut (void){
+	uint32_t zone = 0;
+	for (uint32_t cm = 0; cm <= ZONES_RANGE_MAX_CM; cm++){
+		while (zone < ZONES_NUM && cm > zones_max_cm[zone])
+			zone++;
+		zones_lut[cm] = (uint8_t)zone;
+	}
+	zones_lut_ready = true;
+}
+
+/* Public functions -----------------------------------------------------------*/
+bool 	zones_set_limits (const uint32_t *p_max_cm, uint32_t hysteresis_cm){
+	for (uint32_t i = 1; i < ZONES_NUM; i++){
+		if (p_max_cm[i] <= p_max_cm[i - 1]) return false;
+	}
+	if (p_max_cm[ZONES_NUM - 1] + hysteresis_cm > ZONES_RANGE_MAX_CM) return false;
+
+	for (uint32_t i = 0; i < ZONES_NUM; i++){
+		zones_max_cm[i] = p_max_cm[i];
+	}
+	zones_hysteresis_cm = hysteresis_cm;
+	_build_lut();
+	zones_generation++;
+	return true;
+}
+
+uint32_t 	zones_lookup (int32_t distance_cm){
+	if (!zones_lut_ready)
+		_build_lut();
+	if (distance_cm < 0 || distance_cm > ZONES_RANGE_MAX_CM) return ZONE_NONE;
+	return zones_lut[distance_cm];
+}
+
+uint32_t 	zones_classify (int32_t distance_cm, uint32_t prev_zone){
+	uint32_t zone = zones_lookup(distance_cm);
+	if (zone == prev_zone || distance_cm < 0 || prev_zone > ZONE_NONE) return zone;
+
+	//La tabla es creciente: la zona anterior sigue valiendo si esta entre las zonas de los extremos de la banda
+	int32_t low_cm = distance_cm - (int32_t)zones_hysteresis_cm;
+	uint32_t low = zones_lookup(low_cm < 0 ? 0 : low_cm);
+	uint32_t high = zones_lookup(distance_cm + (int32_t)zones_hysteresis_cm);
+	if (prev_zone >= low && prev_zone <= high) return prev_zone;
+	return zone;
+}
+
+uint32_t 	zones_get_min_cm (uint32_t zone){
+	return (zone == 0) ? DANGER_MIN_CM : zones_max_cm[zone - 1] + 1;
+}
+
+uint32_t 	zones_get_max_cm (uint32_t zone){
+	return zones_max_cm[zone];
+}
+
+uint32_t 	zones_get_generation (void){
+	return zones_generation;
+}
@@ -23,10 +23,56 @@
 #include "fsm_display.h"
 #include "fsm_buzzer.h"
 #include "fsm_urbanite.h"
+#include "scheduler.h"
+#include "trace.h"
+#include "profiler.h"
+#include "boot_timeline.h"
 
 /* Defines ------------------------------------------------------------------*/
 #define 	URBANITE_ON_OFF_PRESS_TIME_MS 1000
 #define 	URBANITE_PAUSE_DISPLAY_TIME_MS 100
+#define 	DISPLAY_GRADIENT_MODE true		/*!< Color del display en degradado continuo (true) o por zonas (false) */
+#define 	DISPLAY_ANIMATIONS true			/*!< Barrido al encender, respiracion en peligro y parpadeo segun la distancia */
+#define 	DISPLAY_BAR_MODE false			/*!< Distancia en la barra de LEDs WS2812 (true) o en el LED RGB (false) */
+#define 	BUZZER_NIGHT_MODE false			/*!< Buzzer con el volumen reducido */
+#define 	BUTTON_HW_DEBOUNCE true			/*!< Debounce del boton con la interrupcion enmascarada y un timer de un solo disparo (true) o en la FSM (false) */
+
+/* Eventos software entre FSM (los bits bajos son los PORT_SYSTEM_EVENT_* del hardware) */
+#define 	EVENT_BUTTON_CHANGED (1U << 8)		/*!< El boton ha cambiado de estado (pulsado, soltado, fin de debounce) */
+#define 	EVENT_ULTRASOUND_CHANGED (1U << 9)	/*!< El ultrasonidos ha avanzado en la medida (p. ej. hay una distancia nueva) */
+#define 	EVENT_URBANITE_ORDER (1U << 10)		/*!< El urbanite ha podido dar ordenes al ultrasonidos, display o buzzer */
+
+/* Prioridades: la cadena medida -> urbanite -> buzzer/display se resuelve en una sola pasada */
+#define 	PRIORITY_BUTTON 0
+#define 	PRIORITY_ULTRASOUND 1
+#define 	PRIORITY_URBANITE 2
+#define 	PRIORITY_BUZZER 3
+#define 	PRIORITY_DISPLAY 4
+
+/**
+ * @brief Plazo del boton para el planificador
+ *
+ * @param p_fsm fsm_t del boton
+ * @param p_deadline_ms Donde se devuelve el plazo
+ * @return Si hay plazo pendiente
+ */
+static bool _button_deadline(fsm_t *p_fsm, uint32_t *p_deadline_ms)
+{
+	return fsm_button_get_next_deadline((fsm_button_t *)p_fsm, p_deadline_ms);
+}
+
+/**
+ * @brief Plazo del urbanite para el planificador: cuando el boton llega al tiempo de encendido o apagado
+ *
+ * @param p_fsm FSM del urbanite
+ * @param p_deadline_ms Donde se devuelve el plazo
+ * @return true si el boton esta pulsado y todavia no se ha atendido el tiempo de encendido o apagado
+ */
+static bool _urbanite_deadline(fsm_t *p_fsm, uint32_t *p_deadline_ms)
+{
+	return fsm_urbanite_get_next_deadline((fsm_urbanite_t *)p_fsm, p_deadline_ms);
+}
+
 /**
  * @brief  The application entry point.
  * @retval int
@@ -35,24 +81,65 @@ int main(void)
 {
     /* Init board */
     port_system_init();
+	BOOT_TIMELINE_MARK(BOOT_STAGE_SYSTEM_INIT);
 
 	//Check if buzzer is active
 	//port_buzzer_init(PORT_PARKING_BUZZER_ID);
 
 	fsm_button_t *p_fsm_button = fsm_button_new(PORT_PARKING_BUTTON_DEBOUNCE_TIME_MS,PORT_PARKING_BUTTON_ID);
+	fsm_button_set_hw_debounce(p_fsm_button, BUTTON_HW_DEBOUNCE);
+	BOOT_TIMELINE_MARK(BOOT_STAGE_FSM_BUTTON);
 	fsm_display_t *p_fsm_display = fsm_display_new(PORT_REAR_PARKING_DISPLAY_ID);
+	fsm_display_set_gradient(p_fsm_display, DISPLAY_GRADIENT_MODE);
+	fsm_display_set_animations(p_fsm_display, DISPLAY_ANIMATIONS);
+	fsm_display_set_bar(p_fsm_display, DISPLAY_BAR_MODE);
+	BOOT_TIMELINE_MARK(BOOT_STAGE_FSM_DISPLAY);
 	fsm_buzzer_t *p_fsm_buzzer = fsm_buzzer_new(PORT_PARKING_BUZZER_ID);
+	fsm_buzzer_set_night_mode(p_fsm_buzzer, BUZZER_NIGHT_MODE);
+	BOOT_TIMELINE_MARK(BOOT_STAGE_FSM_BUZZER);
 	fsm_ultrasound_t *p_fsm_ultrasound = fsm_ultrasound_new(PORT_REAR_PARKING_SENSOR_ID);
+	BOOT_TIMELINE_MARK(BOOT_STAGE_FSM_ULTRASOUND);
 	fsm_urbanite_t *p_fsm_urbanite = fsm_urbanite_new(p_fsm_button,URBANITE_ON_OFF_PRESS_TIME_MS,URBANITE_PAUSE_DISPLAY_TIME_MS,p_fsm_ultrasound,p_fsm_display,p_fsm_buzzer);
+	BOOT_TIMELINE_MARK(BOOT_STAGE_FSM_URBANITE);
+
+	/* Cada FSM solo se dispara cuando tiene algo que hacer */
+	scheduler_add_task(fsm_button_get_inner_fsm(p_fsm_button), PRIORITY_BUTTON,
+					   PORT_SYSTEM_EVENT_BUTTON, 0, EVENT_BUTTON_CHANGED, _button_deadline);
+	scheduler_add_task(fsm_ultrasound_get_inner_fsm(p_fsm_ultrasound), PRIORITY_ULTRASOUND,
+					   PORT_SYSTEM_EVENT_ULTRASOUND | EVENT_URBANITE_ORDER, 0, EVENT_ULTRASOUND_CHANGED, NULL);
+	/* El fin de la ventana del debounce por hardware no cambia el boton, pero deja al urbanite dormir en STOP */
+	scheduler_add_task(fsm_urbanite_get_inner_fsm(p_fsm_urbanite), PRIORITY_URBANITE,
+					   PORT_SYSTEM_EVENT_BUTTON | EVENT_BUTTON_CHANGED | EVENT_ULTRASOUND_CHANGED, EVENT_URBANITE_ORDER, 0, _urbanite_deadline);
+	scheduler_add_task(fsm_buzzer_get_inner_fsm(p_fsm_buzzer), PRIORITY_BUZZER,
+					   EVENT_URBANITE_ORDER, 0, 0, NULL);
+	scheduler_add_task(fsm_display_get_inner_fsm(p_fsm_display), PRIORITY_DISPLAY,
+					   EVENT_URBANITE_ORDER, 0, 0, NULL);
+
+	/* La traza identifica cada FSM por su prioridad */
+	TRACE_SET_FSM_NAME(PRIORITY_BUTTON, "button");
+	TRACE_SET_FSM_NAME(PRIORITY_ULTRASOUND, "ultrasound");
+	TRACE_SET_FSM_NAME(PRIORITY_URBANITE, "urbanite");
+	TRACE_SET_FSM_NAME(PRIORITY_BUZZER, "buzzer");
+	TRACE_SET_FSM_NAME(PRIORITY_DISPLAY, "display");
+
+#ifdef USE_FSM_STATS
+	scheduler_set_stats(fsm_button_get_inner_fsm(p_fsm_button), &fsm_button_get_stats(p_fsm_button)->fsm);
+	scheduler_set_stats(fsm_ultrasound_get_inner_fsm(p_fsm_ultrasound), &fsm_ultrasound_get_stats(p_fsm_ultrasound)->fsm);
+	scheduler_set_stats(fsm_urbanite_get_inner_fsm(p_fsm_urbanite), &fsm_urbanite_get_stats(p_fsm_urbanite)->fsm);
+	scheduler_set_stats(fsm_buzzer_get_inner_fsm(p_fsm_buzzer), &fsm_buzzer_get_stats(p_fsm_buzzer)->fsm);
+	scheduler_set_stats(fsm_display_get_inner_fsm(p_fsm_display), &fsm_display_get_stats(p_fsm_display)->fsm);
+#endif
+
+#ifdef USE_PROFILER
+	profiler_start(PROFILER_HZ);
+#endif
+
+	BOOT_TIMELINE_MARK(BOOT_STAGE_SCHEDULER);
 
     /* Infinite loop */
     while (1)
     {
-		fsm_button_fire(p_fsm_button);
-		fsm_ultrasound_fire(p_fsm_ultrasound);
-		fsm_buzzer_fire(p_fsm_buzzer);
-		fsm_display_fire(p_fsm_display);
-		fsm_urbanite_fire(p_fsm_urbanite);
+		scheduler_run();
     } // End of while(1)
 
 	fsm_button_destroy(p_fsm_button);
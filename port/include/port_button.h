@@ -88,4 +88,40 @@ void 	port_button_clear_pending_interrupt (uint32_t button_id);
  */
  
 void 	port_button_disable_interrupts (uint32_t button_id);
+
+/**
+ * @brief Activa o desactiva el debounce por hardware del boton.
+ *
+ * Tras cada flanco aceptado la interrupcion del boton se enmascara y un timer de un solo disparo la rearma pasado
+ * `debounce_ms`, asi que los rebotes no llegan a la CPU y los flancos llegan ya filtrados y con su instante
+ * (`port_button_get_edge_ms()`). No depende de que nadie consulte el tiempo del sistema mientras dura la ventana.
+ *
+ * @param button_id ID del boton
+ * @param debounce_ms duracion de la ventana en ms, 0 para desactivarlo
+ */
+void 	port_button_set_hw_debounce (uint32_t button_id, uint32_t debounce_ms);
+
+/**
+ * @brief Devuelve si el boton tiene el debounce por hardware activado
+ *
+ * @param button_id ID del boton
+ * @return true si esta activado
+ */
+bool 	port_button_get_hw_debounce (uint32_t button_id);
+
+/**
+ * @brief Devuelve el instante del ultimo cambio de `port_button_set_pressed()`
+ *
+ * @param button_id ID del boton
+ * @return tiempo del sistema en ms
+ */
+uint32_t 	port_button_get_edge_ms (uint32_t button_id);
+
+/**
+ * @brief Devuelve si la ventana del debounce por hardware esta abierta (la interrupcion del boton esta enmascarada)
+ *
+ * @param button_id ID del boton
+ * @return true mientras dura la ventana
+ */
+bool 	port_button_get_debouncing (uint32_t button_id);
 #endif
\ No newline at end of file
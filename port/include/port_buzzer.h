@@ -10,6 +10,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include <stdint.h>
+#include <stdbool.h>
 /* Standard C includes */
 /* Defines and enums ----------------------------------------------------------*/
 /* Enums */
@@ -22,6 +23,22 @@
 
 #define BUZZER_OFF (buzzer_t){0}
 
+/**
+ * @brief Numero de pitidos de un patron que se repite sin fin
+ */
+#define PORT_BUZZER_PATTERN_FOREVER 0
+
+/**
+ * @brief Maximo de pasos (tramos de pitido o de silencio) de un patron. Cada tramo ocupa un paso por cada 256 periodos del tono
+ * y la subida y la bajada de cada pitido ocupan `PORT_BUZZER_ENVELOPE_STEPS` pasos cada una
+ */
+#define PORT_BUZZER_PATTERN_MAX_STEPS 64
+
+/**
+ * @brief Volumen maximo de un patron: el ciclo de trabajo del 50%
+ */
+#define PORT_BUZZER_VOLUME_MAX 100
+
 /**
  * @brief frecuencia en Hz de notas musicales
  */
@@ -44,6 +61,18 @@ typedef struct
 	uint32_t freq; //frecuencia de la nota en Hz
 } buzzer_t;
 
+/**
+ * @brief Patron de pitidos: un tono que suena `on_ms`, calla `off_ms` y se repite `repeat` veces con el volumen `volume`
+ */
+typedef struct
+{
+	uint32_t freq; //frecuencia del tono en Hz (0 silencio)
+	uint32_t on_ms; //duracion de cada pitido (0 o `off_ms` a 0: tono continuo)
+	uint32_t off_ms; //silencio despues de cada pitido
+	uint32_t repeat; //numero de pitidos (`PORT_BUZZER_PATTERN_FOREVER` para repetirlo sin fin)
+	uint32_t volume; //volumen de 0 (silencio) a `PORT_BUZZER_VOLUME_MAX`
+} buzzer_pattern_t;
+
 /* Function prototypes and explanation -------------------------------------------------*/
 
 /**
@@ -56,27 +85,40 @@ void port_buzzer_init (uint32_t buzzer_id);
 
 /**
  * @brief Función que modifica frecuencia de pulsador
+ * @note No para el timer: el nuevo tono entra al acabar el periodo en curso y la frecuencia 0 deja el PWM en marcha con el
+ * ciclo de trabajo a 0. Las notas de `DO` a `DO_ALTO` estan precalculadas para el reloj actual. El tono suena con el volumen
+ * maximo y sin envolvente; para un tono con volumen hay que usar `port_buzzer_play_pattern()`.
  * @param buzzer_id ID del objeto buzzer.
  * @param buzzer objeto buzzer con una frecuencia y un tiempo de pulso.
  */
 void port_buzzer_set_freq (uint32_t buzzer_id, buzzer_t buzzer);
 
 /**
- * @brief Función que incrementa el contador de la estructura buzzer.
+ * @brief Reproduce un patron de pitidos sin intervencion de la CPU.
+ *
+ * El patron se carga una vez y lo reproduce el hardware: la duracion de cada tramo se cuenta en periodos del tono
+ * y el silencio se hace con un ciclo de trabajo de 0, por lo que el sistema puede dormir mientras suena. El volumen y la
+ * subida y bajada de cada pitido (ver `port_buzzer_envelope_build()`) tambien son ciclos de trabajo que escribe el DMA. Un
+ * patron finito acaba en silencio y un tono continuo empieza con la subida. El patron termina con la siguiente llamada a esta funcion, a `port_buzzer_set_freq()` o a
+ * `port_buzzer_suspend()`.
+ *
  * @param buzzer_id ID del objeto buzzer.
+ * @param pattern patron a reproducir. Sin frecuencia o sin volumen es silencio y sin `on_ms` u `off_ms` es un tono continuo.
+ * @return false si el buzzer esta suspendido o el patron necesita mas de `PORT_BUZZER_PATTERN_MAX_STEPS` pasos.
  */
-void port_buzzer_counter_add(uint32_t buzzer_id);
+bool port_buzzer_play_pattern (uint32_t buzzer_id, buzzer_pattern_t pattern);
 
 /**
- * @brief Función que reinicia el contador de la estructura buzzer.
+ * @brief Suspende el hardware del buzzer: para el patron y el PWM, quita el reloj del timer y aparca el pin en modo analogico.
+ * @note Mientras esta suspendido `port_buzzer_set_freq()` y `port_buzzer_play_pattern()` no tienen efecto. Llamarla con el buzzer ya suspendido no hace nada.
  * @param buzzer_id ID del objeto buzzer.
  */
-void port_buzzer_counter_reset(uint32_t buzzer_id);
+void port_buzzer_suspend (uint32_t buzzer_id);
 
 /**
- * @brief Función que devuelve el valor del contador de la estructura buzzer.
+ * @brief Reanuda el hardware del buzzer suspendido con `port_buzzer_suspend()`.
+ * @note El buzzer vuelve en silencio.
  * @param buzzer_id ID del objeto buzzer.
- * @return entero con el valor actual del contador del pulsador.
  */
-uint32_t get_port_buzzer_counter(uint32_t buzzer_id);
+void port_buzzer_resume (uint32_t buzzer_id);
 #endif /* PORT_BUZZER_SYSTEM_H_ */
\ No newline at end of file
@@ -0,0 +1,63 @@
+/**
+ * @file port_buzzer_envelope.h
+ * @brief Header for port_buzzer_envelope.c file. Paso de un patron de pitidos a pasos con volumen y envolvente.
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutierrez Fontán
+ * @date 2025-06-12
+ */
+#ifndef PORT_BUZZER_ENVELOPE_H_
+#define PORT_BUZZER_ENVELOPE_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include "port_buzzer.h"
+
+/* Defines ----------------------------------------------------------*/
+#define PORT_BUZZER_STEP_MAX_PERIODS 256 /*!< Periodos del tono por paso: el contador de repeticiones de TIM8 es de 8 bits */
+
+#define PORT_BUZZER_LEVEL_MAX 256 /*!< Nivel de un paso con el volumen maximo y sin envolvente: el ciclo de trabajo del 50% */
+
+#define PORT_BUZZER_ENVELOPE_STEPS 4 /*!< Pasos de la subida y de la bajada de cada pitido */
+
+#define PORT_BUZZER_ENVELOPE_MS 40 /*!< Duracion de la subida y de la bajada de cada pitido */
+
+/* Typedefs --------------------------------------------------------------------*/
+/**
+ * @brief Paso de un patron: el tono suena `periods` periodos con el nivel `level`
+ */
+typedef struct
+{
+	uint16_t periods; //periodos del tono, de 1 a `PORT_BUZZER_STEP_MAX_PERIODS`
+	uint16_t level; //nivel de 0 (silencio) a `PORT_BUZZER_LEVEL_MAX`
+} port_buzzer_step_t;
+
+/* Function prototypes and explanation -------------------------------------------------*/
+/**
+ * @brief Pasa un patron a pasos medidos en periodos del tono.
+ *
+ * Cada pitido sube en `PORT_BUZZER_ENVELOPE_STEPS` pasos, se mantiene y baja en otros tantos, con los niveles de una tabla
+ * precalculada escalados por el volumen del patron. Si el pitido es corto la subida y la bajada se acortan y, si no
+ * caben, el pitido no tiene envolvente. Los tramos de mas de `PORT_BUZZER_STEP_MAX_PERIODS` periodos se parten en varios
+ * pasos. Un patron finito acaba con dos pasos de silencio y un tono continuo con dos pasos del nivel del tono: el ultimo
+ * paso se queda para siempre. Cualquier patron que no se repite sin fin tiene al menos 3 pasos.
+ * No depende del hardware, por lo que se puede probar en el ordenador.
+ *
+ * @param pattern patron con frecuencia distinta de 0. Sin `on_ms` u `off_ms` es un tono continuo.
+ * @param p_steps pasos de salida.
+ * @param max_steps pasos que caben en `p_steps`.
+ * @param p_loop se pone a true si los pasos se repiten sin fin.
+ * @return numero de pasos, o 0 si no caben.
+ */
+uint32_t port_buzzer_envelope_build (buzzer_pattern_t pattern, port_buzzer_step_t *p_steps, uint32_t max_steps, bool *p_loop);
+
+/**
+ * @brief Convierte el nivel de un paso en el valor del registro de comparacion del PWM.
+ * @param ccr_on valor del registro con el ciclo de trabajo del 50%.
+ * @param level nivel del paso.
+ * @return valor del registro.
+ */
+uint16_t port_buzzer_envelope_ccr (uint16_t ccr_on, uint16_t level);
+
+#endif /* PORT_BUZZER_ENVELOPE_H_ */
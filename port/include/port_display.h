@@ -10,6 +10,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include <stdint.h>
+#include <stdbool.h>
 /* Standard C includes */
 /* Defines and enums ----------------------------------------------------------*/
 /* Enums */
@@ -20,11 +21,27 @@
 */
 #define PORT_REAR_PARKING_DISPLAY_ID   0
 
+/** 
+ * @brief ID de la barra de LEDs. Coincide con el del display al que sustituye
+*/
+#define PORT_REAR_PARKING_BAR_ID   PORT_REAR_PARKING_DISPLAY_ID
+
+/** 
+ * @brief Numero de LEDs de la barra
+*/
+#define PORT_DISPLAY_BAR_NUM_LEDS 8
+
 /** 
  * @brief Valor máximo del valor rgb
 */
 #define PORT_DISPLAY_RGB_MAX_VALUE 255
 
+/** 
+ * @brief Duracion de cada fotograma de una animacion (un periodo del PWM) y maximo de fotogramas por animacion
+*/
+#define PORT_DISPLAY_ANIM_FRAME_MS 20
+#define PORT_DISPLAY_ANIM_MAX_FRAMES 100
+
 /** 
  * @brief ciclo de trabajo sobre 255 de cada color
 */
@@ -62,4 +79,80 @@ void port_display_init (uint32_t display_id);
  */
 void port_display_set_rgb (uint32_t display_id, rgb_color_t color);
 
+/**
+ * @brief Reproduce una animacion en el display sin intervencion de la CPU.
+ *
+ * Cada fotograma dura `PORT_DISPLAY_ANIM_FRAME_MS` (un periodo del PWM) y lo escribe el hardware en los registros
+ * de comparacion al acabar cada periodo, por lo que el sistema puede dormir mientras se reproduce.
+ * La animacion termina con la siguiente llamada a `port_display_set_rgb()`, a esta funcion o a `port_display_suspend()`.
+ * Si ya hay una animacion con el mismo numero de fotogramas y el mismo modo, solo se cambian los colores y se
+ * mantiene la fase.
+ *
+ * @param display_id ID del objeto display.
+ * @param p_frames colores de los fotogramas. Tienen que seguir siendo validos mientras dure la animacion.
+ * @param num_frames numero de fotogramas (1 a `PORT_DISPLAY_ANIM_MAX_FRAMES`).
+ * @param loop true para repetir la animacion, false para reproducirla una vez y quedarse en el ultimo fotograma.
+ * @return false si el numero de fotogramas no es valido o el display esta suspendido.
+ */
+bool port_display_animate (uint32_t display_id, const rgb_color_t *p_frames, uint32_t num_frames, bool loop);
+
+/**
+ * @brief Suspende el hardware de un display: apaga las salidas PWM, quita el reloj del timer y aparca los pines en modo analogico.
+ * @note Mientras esta suspendido `port_display_set_rgb()` no tiene efecto. Llamarla con el display ya suspendido no hace nada.
+ * @param display_id ID del objeto display.
+ */
+void port_display_suspend (uint32_t display_id);
+
+/**
+ * @brief Reanuda el hardware de un display suspendido con `port_display_suspend()`.
+ * @note El display vuelve apagado; el color se fija con la siguiente llamada a `port_display_set_rgb()`.
+ * @param display_id ID del objeto display.
+ */
+void port_display_resume (uint32_t display_id);
+
+/**
+ * @brief Configura el hardware de una barra de LEDs direccionables (WS2812) y la deja apagada.
+ * @param bar_id ID de la barra.
+ */
+void port_display_bar_init (uint32_t bar_id);
+
+/**
+ * @brief Devuelve el numero de LEDs de una barra.
+ * @param bar_id ID de la barra.
+ * @return numero de LEDs, o 0 si el ID no es valido.
+ */
+uint32_t port_display_bar_get_num_leds (uint32_t bar_id);
+
+/**
+ * @brief Devuelve el frame buffer de una barra: un color por LED, empezando por el mas cercano al microcontrolador.
+ * @note Escribir en el no cambia los LEDs hasta la siguiente llamada a `port_display_bar_show()`.
+ * @param bar_id ID de la barra.
+ * @return puntero a `port_display_bar_get_num_leds()` colores.
+ */
+rgb_color_t * port_display_bar_get_frame_buffer (uint32_t bar_id);
+
+/**
+ * @brief Manda el frame buffer a la barra.
+ *
+ * Codifica el frame buffer en la trama del WS2812 y la envia por DMA, sin que la CPU genere los bits. Si todavia se
+ * esta enviando la trama anterior, espera a que acabe. Al volver el frame buffer ya se puede modificar.
+ *
+ * @param bar_id ID de la barra.
+ * @return false si la barra esta suspendida (no se envia nada).
+ */
+bool port_display_bar_show (uint32_t bar_id);
+
+/**
+ * @brief Suspende el hardware de una barra: espera a que acabe la trama en curso, quita el reloj del SPI y deja el pin de datos a nivel bajo.
+ * @note Los LEDs conservan el ultimo color; para apagarlos hay que mandar antes un frame buffer a cero.
+ * @param bar_id ID de la barra.
+ */
+void port_display_bar_suspend (uint32_t bar_id);
+
+/**
+ * @brief Reanuda el hardware de una barra suspendida con `port_display_bar_suspend()`.
+ * @param bar_id ID de la barra.
+ */
+void port_display_bar_resume (uint32_t bar_id);
+
 #endif /* PORT_DISPLAY_SYSTEM_H_ */
\ No newline at end of file
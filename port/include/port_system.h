@@ -11,6 +11,34 @@
 /* Includes del sistema */
 #include <stdint.h>
 
+/* Defines ----------------------------------------------------------*/
+#define PORT_SYSTEM_EVENT_BUTTON 0x01U	   /*!< Evento publicado por la interrupcion del boton */
+#define PORT_SYSTEM_EVENT_ULTRASOUND 0x02U /*!< Evento publicado por las interrupciones de los timers del ultrasonidos */
+#define PORT_SYSTEM_EVENT_WAKEUP 0x08U	   /*!< Evento publicado al llegar el despertar programado con `port_system_set_wakeup_ms()` */
+#define PORT_SYSTEM_EVENTS_HW_MASK 0xFFU   /*!< Bits reservados para eventos del hardware. El resto quedan libres para eventos software */
+
+/* Typedefs ----------------------------------------------------------*/
+/**
+ * @brief Uso de la RAM de la pila principal y del heap desde el arranque
+ */
+typedef struct
+{
+	uint32_t stack_top;	 /*!< Direccion del tope de la pila (SP inicial). La pila crece hacia abajo */
+	uint32_t stack_peak; /*!< Bytes de pila usados en el peor momento, interrupciones incluidas */
+	uint32_t heap_peak;	 /*!< Bytes que ha pedido `malloc()` al sistema. El heap no devuelve memoria, asi que es su maximo */
+	uint32_t margin;	 /*!< Bytes que nunca se han tocado entre el final del heap y lo mas hondo de la pila */
+} port_system_memory_t;
+
+/* Enums ----------------------------------------------------------*/
+/**
+ * @brief Perfiles de reloj del sistema
+ */
+typedef enum
+{
+	PORT_SYSTEM_CLOCK_LOW_POWER = 0, /*!< Reloj interno a 16 MHz. Menor consumo. Es el perfil de arranque */
+	PORT_SYSTEM_CLOCK_BURST,		 /*!< PLL a 180 MHz. Maxima velocidad para rafagas de trabajo */
+} port_system_clock_profile_t;
+
 /**
  * @brief Initializes the system.
  */
@@ -23,6 +51,33 @@ uint32_t port_system_init(void);
  */
 uint32_t port_system_get_millis(void);
 
+/**
+ * @brief Devuelve los microsegundos desde el arranque.
+ *
+ * Mientras el nucleo esta despierto tiene la resolucion del contador de ciclos. Tras dormir o cambiar de reloj se
+ * reajusta con la base de tiempos, sin ir nunca hacia atras.
+ *
+ * @note Da la vuelta cada unos 71 minutos: las diferencias se calculan con aritmetica sin signo.
+ * @retval microsegundos desde el arranque.
+ */
+uint32_t port_system_get_micros(void);
+
+/**
+ * @brief Devuelve el contador de ciclos del nucleo, para medir el coste de un fragmento de codigo.
+ *
+ * @note Solo cuenta con el nucleo despierto y a la frecuencia del reloj actual: las diferencias solo tienen sentido
+ *       sin dormir ni cambiar de reloj entre las dos lecturas. Da la vuelta en 32 bits (unos 24 s a 180 MHz).
+ * @retval ciclos del nucleo.
+ */
+uint32_t port_system_get_cycles(void);
+
+/**
+ * @brief Devuelve los ciclos de `port_system_get_cycles()` que hay en un microsegundo con el reloj actual.
+ *
+ * @retval ciclos por microsegundo.
+ */
+uint32_t port_system_get_cycles_per_us(void);
+
 /**
  * @brief Sets the number of milliseconds since the system started.
  *
@@ -48,14 +103,126 @@ void port_system_delay_ms(uint32_t ms);
  */
 void port_system_delay_until_ms(uint32_t *t, uint32_t ms);
 
+/**
+ * @brief Programa el siguiente despertar del sistema.
+ *
+ * La base de tiempos no genera un tick periodico: el sistema solo se despierta por las interrupciones de los
+ * perifericos o por el instante programado con esta funcion.
+ *
+ * @param deadline_ms Instante (en milisegundos desde el arranque) en el que se necesita despertar.
+ *
+ * @note Si el instante ya ha pasado, el despertar es inmediato. Si esta demasiado lejos, se despierta antes y
+ *       el llamante debe volver a programarlo.
+ */
+void port_system_set_wakeup_ms(uint32_t deadline_ms);
+
+/**
+ * @brief Publica eventos del hardware. Se llama desde las rutinas de interrupcion.
+ *
+ * @param events Mascara de eventos `PORT_SYSTEM_EVENT_*` a publicar.
+ */
+void port_system_post_events(uint32_t events);
+
+/**
+ * @brief Devuelve los eventos publicados desde la ultima llamada y los borra, de forma atomica.
+ *
+ * @return Mascara de eventos `PORT_SYSTEM_EVENT_*` pendientes.
+ */
+uint32_t port_system_take_events(void);
+
+/**
+ * @brief Saca palabras de registros binarios hacia el ordenador sin parar el nucleo (en la placa, por el puerto 1 del ITM).
+ *
+ * @param p_words Palabras a enviar.
+ * @param num_words Numero de palabras.
+ *
+ * @note Si no hay nadie capturando la salida las palabras se descartan.
+ */
+void port_system_log_write(const uint32_t *p_words, uint32_t num_words);
+
+/**
+ * @brief Cambia el perfil de reloj del sistema en tiempo de ejecucion.
+ *
+ * Ajusta la tension del regulador y los estados de espera de la flash al minimo valido para la nueva frecuencia,
+ * y avisa a los drivers para que recalculen el prescaler y el periodo de sus timers. Todo el cambio se hace con las
+ * interrupciones deshabilitadas, por lo que ninguna ISR ve los timers a medio recalcular.
+ *
+ * @param profile Perfil de reloj a aplicar.
+ *
+ * @note `port_system_get_millis()` y el despertar programado se conservan.
+ * @note Los timers se reinician con el nuevo periodo: una medida del ultrasonidos en curso puede salir erronea.
+ */
+void port_system_set_clock_profile(port_system_clock_profile_t profile);
+
+/**
+ * @brief Devuelve el perfil de reloj activo.
+ *
+ * @return Perfil de reloj activo.
+ */
+port_system_clock_profile_t port_system_get_clock_profile(void);
+
+/**
+ * @brief Mide lo que han llegado a usar la pila principal y el heap desde el arranque.
+ *
+ * `port_system_init()` pinta con un patron la RAM libre entre el heap y la pila; la medida busca hasta donde se
+ * ha borrado. Recorre la zona sin usar, asi que tarda del orden de milisegundos.
+ *
+ * @param p_memory estructura donde se guarda el uso de la memoria.
+ * @note Un pico de la pila que escriba justo el valor del patron se cuenta corto por una palabra.
+ */
+void port_system_get_memory(port_system_memory_t *p_memory);
+
+/**
+ * @brief Arranca la interrupcion periodica del perfilador, que apunta con `profiler_sample()` la direccion de la
+ *        instruccion interrumpida.
+ *
+ * @param hz frecuencia de muestreo. Mejor una que no sea multiplo de los periodos de las FSM, para no muestrear
+ *           siempre el mismo punto de un disparo.
+ * @return direccion de inicio de la memoria de programa, origen de los intervalos del histograma.
+ * @note El muestreo sigue con el cambio de perfil de reloj, pero se para en modo Stop.
+ */
+uint32_t port_system_profiler_start(uint32_t hz);
+
+/**
+ * @brief Para el perfilador y apaga su timer.
+ */
+void port_system_profiler_stop(void);
+
 void port_system_power_stop();
 
 void port_system_power_sleep();
 
+/**
+ * @brief Duerme el sistema (modo Sleep) hasta la siguiente interrupcion.
+ *
+ * @note No duerme si hay eventos publicados con `port_system_post_events()` sin recoger, asi un evento que llega
+ *       justo antes de dormir no se pierde hasta la siguiente interrupcion.
+ * @note La base de tiempos sigue contando durante el sueño, por lo que `port_system_get_millis()` no se retrasa.
+ */
 void port_system_sleep();
 
-void port_system_systick_suspend();
+/**
+ * @brief Duerme el sistema en modo Stop hasta la siguiente interrupcion externa (EXTI), p. ej. el boton.
+ *
+ * Al despertar se restaura el reloj del sistema y se suma a `port_system_get_millis()` el tiempo medido
+ * por el RTC mientras la base de tiempos estaba parada.
+ *
+ * @note Igual que `port_system_sleep()`, no duerme si hay eventos pendientes.
+ * @note Los timers no cuentan en modo Stop: los despertares programados con `port_system_set_wakeup_ms()` no tienen efecto.
+ * @note Si el LSE no esta listo no se compensa el tiempo dormido.
+ */
+void port_system_deep_sleep();
 
-void port_system_systick_resume();
+/**
+ * @brief Devuelve la latencia del ultimo despertar del modo Stop: desde el flanco del boton que lo despierta hasta
+ * tener otra vez el perfil de reloj que habia antes de dormir, con el tiempo ya compensado.
+ *
+ * Incluye el arranque del regulador, de la flash y del HSI por el hardware. El inicio es la marca de tiempo que
+ * el RTC toma en el flanco de bajada de PC13 y el final se lee del mismo RTC, con una resolucion de 61 us.
+ *
+ * @retval microsegundos, o 0 si el sistema no ha entrado todavia en modo Stop, el RTC no estaba en marcha o no
+ *         ha despertado con el flanco del boton.
+ */
+uint32_t port_system_get_wake_us(void);
 
 #endif /* PORT_SYSTEM_H_ */
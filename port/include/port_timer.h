@@ -0,0 +1,35 @@
+/**
+ * @file port_timer.h
+ * @brief Header for port_timer.c file. Calculo del prescaler y del periodo de los timers de 16 bits.
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-24
+ */
+#ifndef PORT_TIMER_H_
+#define PORT_TIMER_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+
+/* Defines ----------------------------------------------------------*/
+#define PORT_TIMER_MAX_TICKS 65536U /*!< Cuentas maximas del PSC y del ARR de un timer de 16 bits */
+
+/* Function prototypes and explanation -------------------------------------------------*/
+/**
+ * @brief Calcula el PSC y el ARR de un timer de 16 bits para un periodo de `timer_clock_hz * num / den` ticks.
+ *
+ * El prescaler es el menor con el que el periodo cabe en 16 bits, redondeando al entero mas cercano como hacian los
+ * drivers con `round()`. Solo usa aritmetica entera: el M4 no tiene FPU de doble precision y cada driver lo calcula al
+ * iniciarse y en cada cambio de reloj.
+ * No depende del hardware, por lo que se puede medir en el ordenador.
+ *
+ * @param timer_clock_hz Frecuencia del reloj del timer.
+ * @param num Numerador del periodo en segundos (p. ej. 10 para 10 us).
+ * @param den Denominador del periodo en segundos (p. ej. 1000000 para 10 us).
+ * @param p_psc Donde se devuelve el prescaler.
+ * @param p_arr Donde se devuelve el periodo.
+ */
+void port_timer_compute_period (uint32_t timer_clock_hz, uint32_t num, uint32_t den, uint32_t *p_psc, uint32_t *p_arr);
+
+#endif /* PORT_TIMER_H_ */
@@ -71,6 +71,20 @@ void 	port_ultrasound_reset_echo_ticks (uint32_t ultrasound_id);
  */
 void 	port_ultrasound_stop_ultrasound (uint32_t ultrasound_id);
 
+/**
+ * @brief Suspende el hardware del sensor: para los timers y sus interrupciones, les quita el reloj y aparca los pines de trigger y echo en modo analogico.
+ * @note Llamarla con el sensor ya suspendido no hace nada.
+ * @param ultrasound_id ID del objeto ultrasound.
+ */
+void 	port_ultrasound_suspend (uint32_t ultrasound_id);
+
+/**
+ * @brief Reanuda el hardware del sensor suspendido con `port_ultrasound_suspend()`.
+ * @note Los timers quedan parados; las medidas se arrancan como siempre.
+ * @param ultrasound_id ID del objeto ultrasound.
+ */
+void 	port_ultrasound_resume (uint32_t ultrasound_id);
+
 /**
  * @brief Obtener la preparación de la señal de disparo.
  * @param ultrasound_id ID del objeto ultrasound.
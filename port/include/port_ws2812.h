@@ -0,0 +1,44 @@
+/**
+ * @file port_ws2812.h
+ * @brief Header for port_ws2812.c file. Codificacion de los colores de una tira de LEDs WS2812 en la trama que envia el SPI.
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-10
+ */
+#ifndef PORT_WS2812_H_
+#define PORT_WS2812_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include "port_display.h"
+
+/* Defines ----------------------------------------------------------*/
+#define PORT_WS2812_SPI_BITS_PER_BIT 3 /*!< Bits del SPI por cada bit del WS2812: un 0 es 100 y un 1 es 110 */
+
+#define PORT_WS2812_BYTES_PER_LED (3 * PORT_WS2812_SPI_BITS_PER_BIT) /*!< Bytes de la trama por LED: 24 bits de color (G, R, B) por 3 */
+
+#define PORT_WS2812_RESET_BYTES 100 /*!< Bytes a cero al final de la trama: mas de 280 us en nivel bajo a 2,8 MHz para que los LEDs muestren el color */
+
+/**
+ * @brief Tamaño en bytes de la trama de una tira de `num_leds` LEDs
+*/
+#define PORT_WS2812_BUFFER_SIZE(num_leds) ((num_leds) * PORT_WS2812_BYTES_PER_LED + PORT_WS2812_RESET_BYTES)
+
+/* Function prototypes and explanation -------------------------------------------------*/
+/**
+ * @brief Codifica los colores de la tira en la trama que envia el SPI.
+ *
+ * Cada LED ocupa `PORT_WS2812_BYTES_PER_LED` bytes en el orden del WS2812 (verde, rojo y azul, del bit mas significativo
+ * al menos significativo) y al final se añaden `PORT_WS2812_RESET_BYTES` bytes a cero. Cada nibble se codifica con una
+ * tabla de 16 entradas, sin operaciones bit a bit por cada bit del color.
+ * No depende del hardware, por lo que se puede probar en el ordenador.
+ *
+ * @param p_pixels colores de los LEDs, empezando por el mas cercano al microcontrolador.
+ * @param num_leds numero de LEDs.
+ * @param p_buffer trama de salida. Tiene que tener al menos `PORT_WS2812_BUFFER_SIZE(num_leds)` bytes.
+ * @return numero de bytes escritos en la trama.
+ */
+uint32_t port_ws2812_encode (const rgb_color_t *p_pixels, uint32_t num_leds, uint8_t *p_buffer);
+
+#endif /* PORT_WS2812_H_ */
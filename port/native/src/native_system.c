@@ -0,0 +1,206 @@
+/**
+ * @file native_system.c
+ * @brief Port layer for the system functions on the host (PLATFORM=native), for benchmarks and tests off the board.
+ *
+ * El tiempo sale de `CLOCK_MONOTONIC`. Los "ciclos" son nanosegundos, asi que `port_system_get_cycles()` se usa
+ * igual que en la placa: diferencias sin signo divididas entre `port_system_get_cycles_per_us()`.
+ *
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutierrez Fontán
+ * @date 2025-06-16
+ */
+
+/* Standard C includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* HW dependent includes */
+#include "port_system.h"
+
+//------------------------------------------------------
+// FILE-SPECIFIC DEFINITIONS
+//------------------------------------------------------
+#define NATIVE_NS_PER_US 1000U /*!< "Ciclos" (nanosegundos) por microsegundo */
+#define NATIVE_LOG_ENV "SDG2_LOG_FILE" /*!< Variable de entorno con el fichero al que van los registros binarios del logger */
+
+//------------------------------------------------------
+// PRIVATE VARIABLES
+//------------------------------------------------------
+static struct timespec start_time; /*!< Instante de `port_system_init()`, origen de los milisegundos y microsegundos */
+static int32_t ms_offset = 0; /*!< Ajuste de `port_system_set_millis()` */
+static uint32_t wakeup_deadline_ms = 0; /*!< Ultimo despertar programado con `port_system_set_wakeup_ms()` */
+static volatile uint32_t pending_events = 0; /*!< Eventos publicados y aun no recogidos con `port_system_take_events()` */
+static port_system_clock_profile_t clock_profile = PORT_SYSTEM_CLOCK_LOW_POWER; /*!< Perfil de reloj, solo se guarda */
+static FILE *p_log_file = NULL; /*!< Fichero de los registros binarios, o NULL para descartarlos */
+
+//------------------------------------------------------
+// PRIVATE FUNCTIONS
+//------------------------------------------------------
+/**
+ * @brief Devuelve los nanosegundos desde `port_system_init()`
+ *
+ * @return nanosegundos, sin truncar
+ */
+static uint64_t _elapsed_ns(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t)(now.tv_sec - start_time.tv_sec) * 1000000000ULL) + (uint64_t)now.tv_nsec - (uint64_t)start_time.tv_nsec;
+}
+
+/**
+ * @brief Duerme el proceso un numero de milisegundos
+ *
+ * @param ms milisegundos
+ */
+static void _sleep_ms(uint32_t ms)
+{
+	struct timespec t = {.tv_sec = ms / 1000U, .tv_nsec = (long)(ms % 1000U) * 1000000L};
+	nanosleep(&t, NULL);
+}
+
+//------------------------------------------------------
+// PUBLIC FUNCTIONS
+//------------------------------------------------------
+uint32_t port_system_init()
+{
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	ms_offset = 0;
+	pending_events = 0;
+
+	const char *p_log_path = getenv(NATIVE_LOG_ENV);
+	if (p_log_path != NULL && p_log_file == NULL)
+	{
+		p_log_file = fopen(p_log_path, "wb");
+	}
+	return 0;
+}
+
+uint32_t port_system_get_millis()
+{
+	return (uint32_t)(_elapsed_ns() / 1000000ULL) + (uint32_t)ms_offset;
+}
+
+uint32_t port_system_get_micros(void)
+{
+	return (uint32_t)(_elapsed_ns() / NATIVE_NS_PER_US) + ((uint32_t)ms_offset * 1000U);
+}
+
+uint32_t port_system_get_cycles(void)
+{
+	return (uint32_t)_elapsed_ns();
+}
+
+uint32_t port_system_get_cycles_per_us(void)
+{
+	return NATIVE_NS_PER_US;
+}
+
+void port_system_set_millis(uint32_t ms)
+{
+	ms_offset = (int32_t)(ms - (uint32_t)(_elapsed_ns() / 1000000ULL));
+}
+
+void port_system_delay_ms(uint32_t ms)
+{
+	_sleep_ms(ms);
+}
+
+void port_system_delay_until_ms(uint32_t *p_t, uint32_t ms)
+{
+	uint32_t until = *p_t + ms;
+	uint32_t now = port_system_get_millis();
+	if (until > now)
+	{
+		port_system_delay_ms(until - now);
+	}
+	*p_t = port_system_get_millis();
+}
+
+void port_system_set_wakeup_ms(uint32_t deadline_ms)
+{
+	wakeup_deadline_ms = deadline_ms;
+}
+
+void port_system_post_events(uint32_t events)
+{
+	__atomic_fetch_or(&pending_events, events, __ATOMIC_SEQ_CST);
+}
+
+uint32_t port_system_take_events(void)
+{
+	return __atomic_exchange_n(&pending_events, 0U, __ATOMIC_SEQ_CST);
+}
+
+void port_system_log_write(const uint32_t *p_words, uint32_t num_words)
+{
+	if (p_log_file == NULL)
+	{
+		return;
+	}
+	fwrite(p_words, sizeof(uint32_t), num_words, p_log_file);
+	fflush(p_log_file);
+}
+
+void port_system_set_clock_profile(port_system_clock_profile_t profile)
+{
+	clock_profile = profile;
+}
+
+port_system_clock_profile_t port_system_get_clock_profile(void)
+{
+	return clock_profile;
+}
+
+void port_system_get_memory(port_system_memory_t *p_memory)
+{
+	/* La pila y el heap del proceso los gestiona el sistema operativo: no se miden */
+	*p_memory = (port_system_memory_t){0};
+}
+
+uint32_t port_system_profiler_start(uint32_t hz)
+{
+	/* Sin interrupcion periodica en el host: el perfilador no toma muestras */
+	(void)hz;
+	return 0;
+}
+
+void port_system_profiler_stop(void)
+{
+}
+
+void port_system_power_stop()
+{
+	port_system_power_sleep();
+}
+
+void port_system_power_sleep()
+{
+	/* Sin interrupciones en el host: se duerme hasta el despertar programado */
+	int32_t delta_ms = (int32_t)(wakeup_deadline_ms - port_system_get_millis());
+	if (delta_ms > 0)
+	{
+		_sleep_ms((uint32_t)delta_ms);
+	}
+	port_system_post_events(PORT_SYSTEM_EVENT_WAKEUP);
+}
+
+void port_system_sleep()
+{
+	if (pending_events == 0)
+	{
+		port_system_power_sleep();
+	}
+}
+
+void port_system_deep_sleep()
+{
+	port_system_sleep();
+}
+
+uint32_t port_system_get_wake_us(void)
+{
+	/* En el ordenador no hay modo Stop */
+	return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file port_buzzer_envelope.c
+ * @brief Paso de un patron de pitidos a pasos con el volumen y la envolvente de cada pitido. Independiente de la plataforma.
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutierrez Fontán
+ * @date 2025-06-12
+ */
+
+/* Standard C includes */
+#include "port_buzzer_envelope.h"
+
+/* Global variables */
+/**
+ * @brief Niveles de la subida con el volumen maximo, en una curva cuadratica: (2i+1)^2 / 64 del nivel maximo. La bajada los recorre al reves
+ */
+static const uint16_t 	buzzer_envelope_lut [PORT_BUZZER_ENVELOPE_STEPS] = {4, 36, 100, 196};
+
+/* Private functions -----------------------------------------------------------*/
+/**
+ * @brief Añade un tramo al patron, partido en pasos de como mucho `PORT_BUZZER_STEP_MAX_PERIODS` periodos
+ * @param p_steps pasos del patron
+ * @param max_steps pasos que caben
+ * @param p_num_steps pasos que ya hay; se actualiza
+ * @param periods periodos del tono que dura el tramo (0 no añade nada)
+ * @param level nivel del tramo
+ * @return false si no caben los pasos
+ */
+static bool 	_envelope_add (port_buzzer_step_t *p_steps, uint32_t max_steps, uint32_t *p_num_steps, uint32_t periods, uint32_t level){
+	while (periods > 0){
+		if (*p_num_steps >= max_steps) return false;
+		uint32_t step = (periods > PORT_BUZZER_STEP_MAX_PERIODS) ? PORT_BUZZER_STEP_MAX_PERIODS : periods;
+		p_steps[*p_num_steps].periods = (uint16_t)step;
+		p_steps[*p_num_steps].level = (uint16_t)level;
+		(*p_num_steps)++;
+		periods -= step;
+	}
+	return true;
+}
+
+/**
+ * @brief Nivel de un paso de la envolvente con el nivel del pitido
+ * @param index paso de la subida
+ * @param level nivel del pitido
+ * @return nivel del paso
+ */
+static uint32_t 	_envelope_level (uint32_t index, uint32_t level){
+	return (buzzer_envelope_lut[index] * level + PORT_BUZZER_LEVEL_MAX / 2U) / PORT_BUZZER_LEVEL_MAX;
+}
+
+/* Public functions -----------------------------------------------------------*/
+uint32_t 	port_buzzer_envelope_build (buzzer_pattern_t pattern, port_buzzer_step_t *p_steps, uint32_t max_steps, bool *p_loop){
+	uint32_t num_steps = 0;
+	bool continuous = (pattern.on_ms == 0 || pattern.off_ms == 0);
+	uint32_t volume = (pattern.volume > PORT_BUZZER_VOLUME_MAX) ? PORT_BUZZER_VOLUME_MAX : pattern.volume;
+	uint32_t level = (PORT_BUZZER_LEVEL_MAX * volume + PORT_BUZZER_VOLUME_MAX / 2U) / PORT_BUZZER_VOLUME_MAX;
+
+	//Con la frecuencia nominal los pasos no cambian con el reloj
+	uint32_t on_periods = (pattern.on_ms * pattern.freq + 500U) / 1000U;
+	uint32_t off_periods = (pattern.off_ms * pattern.freq + 500U) / 1000U;
+	if (on_periods == 0) on_periods = 1;
+	if (off_periods == 0) off_periods = 1;
+
+	uint32_t env_periods = ((PORT_BUZZER_ENVELOPE_MS * pattern.freq + 500U) / 1000U) / PORT_BUZZER_ENVELOPE_STEPS;
+	if (!continuous && 2U * PORT_BUZZER_ENVELOPE_STEPS * env_periods > on_periods){
+		//Pitido corto: la subida y la bajada se reparten el pitido
+		env_periods = on_periods / (2U * PORT_BUZZER_ENVELOPE_STEPS);
+	}
+
+	*p_loop = (!continuous && pattern.repeat == PORT_BUZZER_PATTERN_FOREVER);
+	if (continuous){
+		for (uint32_t i = 0; i < PORT_BUZZER_ENVELOPE_STEPS; i++){
+			if (!_envelope_add(p_steps, max_steps, &num_steps, env_periods, _envelope_level(i, level))) return 0;
+		}
+		if (!_envelope_add(p_steps, max_steps, &num_steps, 2U * PORT_BUZZER_STEP_MAX_PERIODS, level)) return 0;
+		return num_steps;
+	}
+
+	uint32_t sustain_periods = on_periods - 2U * PORT_BUZZER_ENVELOPE_STEPS * env_periods;
+	uint32_t repeat = *p_loop ? 1 : pattern.repeat;
+	for (uint32_t r = 0; r < repeat; r++){
+		for (uint32_t i = 0; i < PORT_BUZZER_ENVELOPE_STEPS; i++){
+			if (!_envelope_add(p_steps, max_steps, &num_steps, env_periods, _envelope_level(i, level))) return 0;
+		}
+		if (!_envelope_add(p_steps, max_steps, &num_steps, sustain_periods, level)) return 0;
+		for (uint32_t i = PORT_BUZZER_ENVELOPE_STEPS; i > 0; i--){
+			if (!_envelope_add(p_steps, max_steps, &num_steps, env_periods, _envelope_level(i - 1U, level))) return 0;
+		}
+		if (!_envelope_add(p_steps, max_steps, &num_steps, off_periods, 0)) return 0;
+	}
+	if (!*p_loop){
+		if (!_envelope_add(p_steps, max_steps, &num_steps, 2U * PORT_BUZZER_STEP_MAX_PERIODS, 0)) return 0;
+	}
+	return num_steps;
+}
+
+uint16_t 	port_buzzer_envelope_ccr (uint16_t ccr_on, uint16_t level){
+	return (uint16_t)(((uint32_t)ccr_on * level + PORT_BUZZER_LEVEL_MAX / 2U) / PORT_BUZZER_LEVEL_MAX);
+}
@@ -0,0 +1,27 @@
+/**
+ * @file port_timer.c
+ * @brief Calculo del prescaler y del periodo de los timers de 16 bits. Independiente de la plataforma.
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-24
+ */
+
+/* Standard C includes */
+#include "port_timer.h"
+
+/* Public functions -----------------------------------------------------------*/
+void 	port_timer_compute_period (uint32_t timer_clock_hz, uint32_t num, uint32_t den, uint32_t *p_psc, uint32_t *p_arr){
+	//Cuentas del periodo por 2*den, para redondear sin salir de los enteros: round(t / d) = (2t + d) / 2d
+	uint64_t ticks_x2den = 2ULL * timer_clock_hz * num;
+	uint64_t den64 = den;
+	uint64_t div = (ticks_x2den + den64 * PORT_TIMER_MAX_TICKS) / (2ULL * den64 * PORT_TIMER_MAX_TICKS);
+	if (div == 0)
+		div = 1;
+	uint64_t arr = (ticks_x2den + den64 * div) / (2ULL * den64 * div);
+	if (arr > PORT_TIMER_MAX_TICKS){
+		div++;
+		arr = (ticks_x2den + den64 * div) / (2ULL * den64 * div);
+	}
+	*p_psc = (uint32_t)(div - 1U);
+	*p_arr = (uint32_t)(arr - 1U);
+}
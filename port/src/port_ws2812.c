@@ -0,0 +1,47 @@
+/**
+ * @file port_ws2812.c
+ * @brief Codificacion de los colores de una tira de LEDs WS2812 en la trama que envia el SPI. Independiente de la plataforma.
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-10
+ */
+
+/* Standard C includes */
+#include <string.h>
+#include "port_ws2812.h"
+
+/* Global variables */
+/**
+ * @brief Codificacion de cada nibble: 4 bits del WS2812 son 12 bits del SPI (100 para un 0 y 110 para un 1)
+ */
+static const uint16_t 	ws2812_nibble_lut [16] = {
+	0x924, 0x926, 0x934, 0x936, 0x9A4, 0x9A6, 0x9B4, 0x9B6,
+	0xD24, 0xD26, 0xD34, 0xD36, 0xDA4, 0xDA6, 0xDB4, 0xDB6,
+};
+
+/* Private functions -----------------------------------------------------------*/
+/**
+ * @brief Codifica un byte de color en los 3 bytes (24 bits) que envia el SPI
+ * @param level nivel del color
+ * @param p_out donde se escriben los 3 bytes
+ */
+static void 	_ws2812_encode_byte (uint8_t level, uint8_t *p_out){
+	uint32_t bits = ((uint32_t)ws2812_nibble_lut[level >> 4] << 12) | ws2812_nibble_lut[level & 0x0FU];
+	p_out[0] = (uint8_t)(bits >> 16);
+	p_out[1] = (uint8_t)(bits >> 8);
+	p_out[2] = (uint8_t)bits;
+}
+
+/* Public functions -----------------------------------------------------------*/
+uint32_t 	port_ws2812_encode (const rgb_color_t *p_pixels, uint32_t num_leds, uint8_t *p_buffer){
+	uint8_t *p_out = p_buffer;
+	for (uint32_t i = 0; i < num_leds; i++){
+		//El WS2812 espera el verde primero
+		_ws2812_encode_byte(p_pixels[i].g, &p_out[0]);
+		_ws2812_encode_byte(p_pixels[i].r, &p_out[3]);
+		_ws2812_encode_byte(p_pixels[i].b, &p_out[6]);
+		p_out += PORT_WS2812_BYTES_PER_LED;
+	}
+	memset(p_out, 0, PORT_WS2812_RESET_BYTES);
+	return PORT_WS2812_BUFFER_SIZE(num_leds);
+}
@@ -19,6 +19,10 @@
 #define STM32F4_PARKING_BUTTON_GPIO GPIOC /*!< GPIO del boton */
 #define STM32F4_PARKING_BUTTON_PIN 13 /*!< PIN del boton */
 
+#define STM32F4_BUTTON_DEBOUNCE_TIM TIM10 /*!< Timer de un solo disparo del debounce por hardware */
+#define STM32F4_BUTTON_DEBOUNCE_IRQN TIM1_UP_TIM10_IRQn /*!< Interrupcion del timer del debounce */
+#define STM32F4_BUTTON_DEBOUNCE_TICK_HZ 10000 /*!< Frecuencia de cuenta del timer del debounce: ventanas de hasta 6.5 s */
+
 
 /* Function prototypes and explanation -------------------------------------------------*/
 /**
@@ -30,4 +34,20 @@
  */
 void stm32f4_button_set_new_gpio(uint32_t button_id, GPIO_TypeDef *p_port, uint8_t pin);
 
+/**
+ * @brief Abre la ventana de debounce por hardware tras aceptar un flanco: enmascara la linea EXTI del boton y arranca el timer de un solo disparo.
+ *
+ * @note Se llama desde la interrupcion del boton. Sin debounce por hardware no hace nada. El timer es unico, asi que solo un boton puede usarlo.
+ * @param button_id ID del boton
+ */
+void stm32f4_button_debounce_start(uint32_t button_id);
+
+/**
+ * @brief Cierra la ventana de debounce por hardware. Si el nivel del pin ya no es el del ultimo flanco aceptado, acepta el flanco que se perdio en la ventana y abre otra; si no, desenmascara la linea EXTI.
+ *
+ * @note Se llama desde la interrupcion del timer del debounce.
+ * @param button_id ID del boton
+ */
+void stm32f4_button_debounce_timeout(uint32_t button_id);
+
 #endif /* STM32F4_BUTTON_H_ */
\ No newline at end of file
@@ -21,4 +21,8 @@
 #define STM32F4_PARKING_BUZZER_GPIO GPIOC /*!< PUERTO del buzzer */
 #define STM32F4_PARKING_BUZZER_PIN 7 /*!< PIN del buzzer */
 
+#define STM32F4_PARKING_BUZZER_DMA_STREAM DMA2_Stream1 /*!< Stream del DMA que atiende al evento de actualizacion de TIM8 (TIM8_UP)*/
+
+#define STM32F4_PARKING_BUZZER_DMA_CHANNEL 7 /*!< Canal de TIM8_UP en el stream*/
+
 #endif /* STM32F4_BUZZER_SYSTEM_H_ */
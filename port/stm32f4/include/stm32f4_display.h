@@ -28,4 +28,8 @@
  
 #define STM32F4_REAR_PARKING_DISPLAY_RGB_B_PIN 9 /*!< PIN del led azul*/
 
+#define STM32F4_REAR_PARKING_DISPLAY_DMA_STREAM DMA1_Stream6 /*!< Stream del DMA que atiende al evento de actualizacion de TIM4 (TIM4_UP)*/
+
+#define STM32F4_REAR_PARKING_DISPLAY_DMA_CHANNEL 2 /*!< Canal de TIM4_UP en el stream*/
+
 #endif /* STM32F4_DISPLAY_SYSTEM_H_ */
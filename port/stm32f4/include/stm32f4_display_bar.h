@@ -0,0 +1,33 @@
+/**
+ * @file stm32f4_display_bar.h
+ * @brief Header for stm32f4_display_bar.c file.
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-10
+ */
+#ifndef STM32F4_DISPLAY_BAR_H_
+#define STM32F4_DISPLAY_BAR_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard C includes */
+#include <stdint.h>
+#include "stm32f4xx.h"
+/* HW dependent includes */
+
+/* Defines and enums ----------------------------------------------------------*/
+/* Defines */
+#define STM32F4_REAR_PARKING_BAR_GPIO GPIOA /*!< PUERTO de datos de la tira (MOSI de SPI1)*/
+
+#define STM32F4_REAR_PARKING_BAR_PIN 7 /*!< PIN de datos de la tira*/
+
+#define STM32F4_REAR_PARKING_BAR_AF 5 /*!< Funcion alternativa de SPI1 en el pin*/
+
+#define STM32F4_REAR_PARKING_BAR_SPI SPI1 /*!< SPI que genera la trama*/
+
+#define STM32F4_REAR_PARKING_BAR_DMA_STREAM DMA2_Stream3 /*!< Stream del DMA que atiende a la transmision de SPI1 (SPI1_TX)*/
+
+#define STM32F4_REAR_PARKING_BAR_DMA_CHANNEL 3 /*!< Canal de SPI1_TX en el stream*/
+
+#define STM32F4_BAR_SPI_MAX_HZ 3000000U /*!< Frecuencia maxima del SPI: con 3 bits por bit del WS2812 el pulso de un 0 (un bit del SPI) dura al menos 333 ns */
+
+#endif /* STM32F4_DISPLAY_BAR_H_ */
@@ -42,6 +42,14 @@
 #define STM32F4_AF1 0x01U /*!< Alternate function 1 */
 #define STM32F4_AF2 0x02U /*!< Alternate function 2 */
 
+/* Typedefs --------------------------------------------------------------------*/
+/**
+ * @brief Funcion de un driver que recalcula sus timers tras un cambio de reloj del sistema.
+ *
+ * @note Se llama con las interrupciones deshabilitadas, con `SystemCoreClock` ya actualizado.
+ */
+typedef void (*stm32f4_system_clock_listener_t)(void);
+
 /** @verbatim
       ==============================================================================
                               ##### How to use GPIOs #####
@@ -194,4 +202,70 @@ void stm32f4_system_gpio_write(GPIO_TypeDef *p_port, uint8_t pin, bool value);
  */
 void stm32f4_system_gpio_toggle(GPIO_TypeDef *p_port, uint8_t pin);
 
+/**
+ * @brief Aparca un pin que no se usa: modo analogico y sin pull, que es el estado de menor consumo.
+ *
+ * Cuando ya no queda ningun pin del puerto en uso (configurado con `stm32f4_system_gpio_config()`)
+ * se deshabilita tambien el reloj del puerto en AHB1ENR.
+ *
+ * @param p_port Puerto del pin a aparcar.
+ * @param pin Pin a aparcar.
+ */
+void stm32f4_system_gpio_park(GPIO_TypeDef *p_port, uint8_t pin);
+
+/**
+ * @brief Devuelve la frecuencia a la que cuenta un timer antes de su prescaler.
+ *
+ * Depende del bus al que esta conectado (APB1 o APB2) y del prescaler de ese bus: si es distinto de 1,
+ * el timer cuenta al doble de la frecuencia del bus.
+ *
+ * @param p_tim Timer (CMSIS struct like)
+ * @return Frecuencia del reloj del timer en Hz.
+ */
+uint32_t stm32f4_system_get_timer_clock(TIM_TypeDef *p_tim);
+
+/**
+ * @brief Atiende una llamada de semihosting que ha acabado en HardFault porque no hay nadie al otro lado.
+ *
+ * Sin depurador el `bkpt 0xAB` de una llamada de semihosting escala a HardFault. Si la instruccion que ha fallado es esa,
+ * la salta, devuelve -1 a la llamada y apunta que no hay semihosting, asi que el programa sigue sin salida en lugar de
+ * quedarse bloqueado.
+ *
+ * @note Se llama desde la ISR de HardFault.
+ *
+ * @param p_frame Marco que apila el hardware al entrar en la excepcion: r0-r3, r12, lr, pc y xpsr.
+ * @return true si era una llamada de semihosting y se puede volver de la excepcion.
+ */
+bool stm32f4_system_semihosting_trap(uint32_t *p_frame);
+
+/**
+ * @brief Devuelve la frecuencia del bus (APB1 o APB2) al que esta conectado un SPI, antes de su prescaler.
+ *
+ * @param p_spi SPI (CMSIS struct like)
+ * @return Frecuencia del reloj del SPI en Hz.
+ */
+uint32_t stm32f4_system_get_spi_clock(SPI_TypeDef *p_spi);
+
+/**
+ * @brief Registra un driver para que recalcule sus timers cuando cambia el perfil de reloj.
+ *
+ * @param listener Funcion del driver. Registrarla mas de una vez no tiene efecto.
+ * @return false si ya no caben mas drivers.
+ */
+bool stm32f4_system_clock_listener_register(stm32f4_system_clock_listener_t listener);
+
+/**
+ * @brief Acumula una vuelta completa del contador de la base de tiempos (TIM11).
+ *
+ * @note Se llama desde la ISR de desbordamiento de TIM11.
+ */
+void stm32f4_system_timebase_wrap(void);
+
+/**
+ * @brief Atiende el despertar programado con `port_system_set_wakeup_ms()`.
+ *
+ * @note Se llama desde la ISR de comparacion del canal 1 de TIM11.
+ */
+void stm32f4_system_timebase_wakeup(void);
+
 #endif /* STM32F4_SYSTEM_H_ */
\ No newline at end of file
@@ -16,22 +16,62 @@
 #include "port_ultrasound.h"
 #include "stm32f4_button.h"
 #include "stm32f4_ultrasound.h"
-#include "port_buzzer.h"
-#include "stm32f4_buzzer.h"
+#include "trace.h"
+#include "isr_stats.h"
+#include "profiler.h"
 
 //------------------------------------------------------
-// INTERRUPT SERVICE ROUTINES
+// PRIVATE FUNCTIONS
 //------------------------------------------------------
 /**
- * @brief Rutina de atencion al timer del sistema.
+ * @brief Pasa ticks de un timer a ciclos del nucleo, para la latencia de sus interrupciones.
  *
- * @note Incrementa el contador del timer en 1.
+ * @note La resolucion es de un tick del timer: con prescalers grandes la latencia sale casi siempre 0.
+ * @param p_tim timer
+ * @param ticks ticks del timer desde el evento
+ * @return ciclos del nucleo
  */
-void SysTick_Handler(void)
+static inline uint32_t _timer_latency(TIM_TypeDef *p_tim, uint32_t ticks)
 {
-	uint32_t ms_local = port_system_get_millis();
-	port_system_set_millis(ms_local+1);
+	return ticks * (p_tim->PSC + 1U) * (SystemCoreClock / stm32f4_system_get_timer_clock(p_tim));
+}
 
+/**
+ * @brief Devuelve los ticks de un timer desde una captura o comparacion, teniendo en cuenta que el contador ha podido dar la vuelta.
+ *
+ * @param p_tim timer
+ * @param ccr valor del registro de captura o comparacion
+ * @return ticks desde el evento
+ */
+static inline uint32_t _timer_ticks_since(TIM_TypeDef *p_tim, uint32_t ccr)
+{
+	uint32_t cnt = p_tim->CNT;
+	return (cnt >= ccr) ? cnt - ccr : cnt + p_tim->ARR + 1U - ccr;
+}
+
+//------------------------------------------------------
+// INTERRUPT SERVICE ROUTINES
+//------------------------------------------------------
+/**
+ * @brief Rutina de atencion a la base de tiempos del sistema (TIM11).
+ *
+ * @note Sustituye al tick de 1 ms del SysTick: solo interrumpe al desbordar el contador y en el despertar programado.
+ */
+void TIM1_TRG_COM_TIM11_IRQHandler(void)
+{
+	/* El evento es el desbordamiento (CNT = 0) o la comparacion del despertar */
+	ISR_STATS_ENTER(TRACE_ISR_TIM11, _timer_latency(TIM11, ((TIM11->SR & TIM_SR_CC1IF) != 0) ? _timer_ticks_since(TIM11, TIM11->CCR1) : TIM11->CNT));
+	TRACE_ISR_ENTER(TRACE_ISR_TIM11);
+	if ((TIM11->SR & TIM_SR_UIF) != 0){
+		TIM11->SR &= ~TIM_SR_UIF;
+		stm32f4_system_timebase_wrap();
+	}
+	if ((TIM11->SR & TIM_SR_CC1IF) != 0){
+		TIM11->SR &= ~TIM_SR_CC1IF;
+		stm32f4_system_timebase_wakeup();
+	}
+	TRACE_ISR_EXIT(TRACE_ISR_TIM11);
+	ISR_STATS_EXIT(TRACE_ISR_TIM11);
 }
 
 /**
@@ -42,7 +82,9 @@ void SysTick_Handler(void)
 
 void EXTI15_10_IRQHandler ( void )
 {
-	port_system_systick_resume();
+	/* El EXTI no tiene contador: no se mide la latencia */
+	ISR_STATS_ENTER(TRACE_ISR_EXTI15_10, ISR_STATS_LATENCY_UNKNOWN);
+	TRACE_ISR_ENTER(TRACE_ISR_EXTI15_10);
 	/* ISR parking button */
 	if ( port_button_get_pending_interrupt ( PORT_PARKING_BUTTON_ID ) ){
 		if(port_button_get_value(PORT_PARKING_BUTTON_ID)){
@@ -51,7 +93,30 @@ void EXTI15_10_IRQHandler ( void )
 			port_button_set_pressed(PORT_PARKING_BUTTON_ID, true);
 		}
 		port_button_clear_pending_interrupt(PORT_PARKING_BUTTON_ID);
+		stm32f4_button_debounce_start(PORT_PARKING_BUTTON_ID);
+		port_system_post_events(PORT_SYSTEM_EVENT_BUTTON);
+	}
+	TRACE_ISR_EXIT(TRACE_ISR_EXTI15_10);
+	ISR_STATS_EXIT(TRACE_ISR_EXTI15_10);
+}
+
+/**
+ * @brief Rutina de atencion a la interrupcion del timer 10.
+ *
+ * @note Cierra la ventana del debounce por hardware del boton.
+ */
+void TIM1_UP_TIM10_IRQHandler(void)
+{
+	/* En modo one-pulse el contador se para a 0 en el evento: no se mide la latencia */
+	ISR_STATS_ENTER(TRACE_ISR_TIM10, ISR_STATS_LATENCY_UNKNOWN);
+	TRACE_ISR_ENTER(TRACE_ISR_TIM10);
+	if ((TIM10->SR & TIM_SR_UIF) != 0){
+		TIM10->SR &= ~TIM_SR_UIF;
+		stm32f4_button_debounce_timeout(PORT_PARKING_BUTTON_ID);
+		port_system_post_events(PORT_SYSTEM_EVENT_BUTTON);
 	}
+	TRACE_ISR_EXIT(TRACE_ISR_TIM10);
+	ISR_STATS_EXIT(TRACE_ISR_TIM10);
 }
 
 /**
@@ -61,8 +126,13 @@ void EXTI15_10_IRQHandler ( void )
  */
 
 void TIM3_IRQHandler(){
+	ISR_STATS_ENTER(TRACE_ISR_TIM3, _timer_latency(TIM3, TIM3->CNT));
+	TRACE_ISR_ENTER(TRACE_ISR_TIM3);
 	TIM3->SR &= ~TIM_SR_UIF;
 	port_ultrasound_set_trigger_end(PORT_REAR_PARKING_SENSOR_ID,true);
+	port_system_post_events(PORT_SYSTEM_EVENT_ULTRASOUND);
+	TRACE_ISR_EXIT(TRACE_ISR_TIM3);
+	ISR_STATS_EXIT(TRACE_ISR_TIM3);
 }
 
 /**
@@ -72,18 +142,13 @@ void TIM3_IRQHandler(){
  */
 
 void TIM5_IRQHandler(){
+	ISR_STATS_ENTER(TRACE_ISR_TIM5, _timer_latency(TIM5, TIM5->CNT));
+	TRACE_ISR_ENTER(TRACE_ISR_TIM5);
 	TIM5->SR &= ~TIM_SR_UIF;
 	port_ultrasound_set_trigger_ready(PORT_REAR_PARKING_SENSOR_ID,true);
-}
-
-/**
- * @brief Rutina de atencion a la interrupcion del timer 9.
- *
- * @note Se encarga de contar el número de overflows del timer.
- */
-void TIM1_BRK_TIM9_IRQHandler(){
-	TIM9->SR &= ~TIM_SR_UIF;
-	port_buzzer_counter_add(PORT_PARKING_BUZZER_ID);
+	port_system_post_events(PORT_SYSTEM_EVENT_ULTRASOUND);
+	TRACE_ISR_EXIT(TRACE_ISR_TIM5);
+	ISR_STATS_EXIT(TRACE_ISR_TIM5);
 }
 
 /**
@@ -92,8 +157,13 @@ void TIM1_BRK_TIM9_IRQHandler(){
  * @note Controla la duracion de la señal eco.
  */
 void TIM2_IRQHandler(){
-	port_system_systick_resume();
-	if((TIM2->SR) & TIM_SR_UIF){
+	/* SR y CCR2 se leen una sola vez: en modo captura, leer CCR2 borra CC2IF, y una segunda lectura perderia el flanco */
+	uint32_t sr = TIM2->SR;
+	uint32_t ccr2 = ((sr & TIM_SR_CC2IF) != 0) ? TIM2->CCR2 : 0;
+	/* El evento es la captura del flanco del eco o el desbordamiento */
+	ISR_STATS_ENTER(TRACE_ISR_TIM2, _timer_latency(TIM2, ((sr & TIM_SR_CC2IF) != 0) ? _timer_ticks_since(TIM2, ccr2) : TIM2->CNT));
+	TRACE_ISR_ENTER(TRACE_ISR_TIM2);
+	if(sr & TIM_SR_UIF){
 		port_ultrasound_set_echo_overflows(
 			PORT_REAR_PARKING_SENSOR_ID,
 			port_ultrasound_get_echo_overflows(PORT_REAR_PARKING_SENSOR_ID)+1
@@ -101,14 +171,81 @@ void TIM2_IRQHandler(){
 		TIM2->SR &= ~TIM_SR_UIF;
 	}
 	
-	if((TIM2->SR & TIM_SR_CC2IF) != 0){
+	if((sr & TIM_SR_CC2IF) != 0){
 		if((port_ultrasound_get_echo_init_tick(PORT_REAR_PARKING_SENSOR_ID) == 0) & (port_ultrasound_get_echo_end_tick(PORT_REAR_PARKING_SENSOR_ID) == 0)){
-			port_ultrasound_set_echo_init_tick(PORT_REAR_PARKING_SENSOR_ID,TIM2->CCR2);
+			port_ultrasound_set_echo_init_tick(PORT_REAR_PARKING_SENSOR_ID,ccr2);
 		}else{
-			port_ultrasound_set_echo_end_tick(PORT_REAR_PARKING_SENSOR_ID,TIM2->CCR2);
+			port_ultrasound_set_echo_end_tick(PORT_REAR_PARKING_SENSOR_ID,ccr2);
 			port_ultrasound_set_echo_received(PORT_REAR_PARKING_SENSOR_ID,true);
 		}
 		TIM2->SR &= ~TIM_SR_CC2IF;
+		/* Los desbordamientos solo se cuentan: la FSM solo tiene algo que hacer con los flancos del eco */
+		port_system_post_events(PORT_SYSTEM_EVENT_ULTRASOUND);
 	}
-	
-}
\ No newline at end of file
+	TRACE_ISR_EXIT(TRACE_ISR_TIM2);
+	ISR_STATS_EXIT(TRACE_ISR_TIM2);
+}
+
+#ifdef USE_PROFILER
+/**
+ * @brief Parte en C de la rutina del perfilador: apunta la direccion de la instruccion interrumpida.
+ *
+ * @param p_frame marco que apila el hardware al entrar en la interrupcion: r0-r3, r12, lr, pc y xpsr
+ */
+__attribute__((used)) static void _profiler_isr(const uint32_t *p_frame)
+{
+	TIM7->SR &= ~TIM_SR_UIF;
+	profiler_sample(p_frame[6]);
+}
+
+/**
+ * @brief Rutina de atencion a la interrupcion del timer 7, el muestreo del perfilador.
+ *
+ * @note Es naked para encontrar el marco apilado antes de que el prologo de una funcion C mueva la pila: el bit 2 de
+ *       EXC_RETURN (en lr) dice si el contexto interrumpido usaba la pila principal o la del proceso. No se marca en la
+ *       traza ni en las estadisticas de interrupciones para no cambiar lo que mide.
+ */
+__attribute__((naked)) void TIM7_IRQHandler(void)
+{
+	__asm volatile(
+		"tst lr, #4\n"
+		"ite eq\n"
+		"mrseq r0, msp\n"
+		"mrsne r0, psp\n"
+		"b _profiler_isr\n");
+}
+#endif
+
+#ifdef USE_SEMIHOSTING
+/**
+ * @brief Parte en C de la rutina de HardFault: salta las llamadas de semihosting sin depurador y se para en el resto.
+ *
+ * @param p_frame marco que apila el hardware al entrar en la excepcion: r0-r3, r12, lr, pc y xpsr
+ */
+__attribute__((used)) static void _hardfault_isr(uint32_t *p_frame)
+{
+	if (stm32f4_system_semihosting_trap(p_frame))
+	{
+		return;
+	}
+	while (1)
+	{
+	}
+}
+
+/**
+ * @brief Rutina de atencion al HardFault.
+ *
+ * @note Es naked para encontrar el marco apilado, igual que la del perfilador: la llamada de semihosting que falla se
+ *       retoma cambiando el pc y el r0 apilados.
+ */
+__attribute__((naked)) void HardFault_Handler(void)
+{
+	__asm volatile(
+		"tst lr, #4\n"
+		"ite eq\n"
+		"mrseq r0, msp\n"
+		"mrsne r0, psp\n"
+		"b _hardfault_isr\n");
+}
+#endif
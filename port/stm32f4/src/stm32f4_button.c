@@ -22,7 +22,8 @@
 
 /* Typedefs --------------------------------------------------------------------*/
 /**
- * @brief La estructura del boton tienen los siguientes elementos: el puerto y pin del boton, el modo de pull-up/pull-down y un booleano para saber si el boton está presionado
+ * @brief La estructura del boton tienen los siguientes elementos: el puerto y pin del boton, el modo de pull-up/pull-down, un booleano para saber si el boton está presionado,
+ * el debounce por hardware (0 si no hay), el instante del ultimo flanco aceptado y si la linea EXTI esta enmascarada esperando al fin del debounce
  *
  */
 typedef struct
@@ -31,6 +32,9 @@ typedef struct
     uint8_t pin;
     uint8_t pupd_mode;
     bool flag_pressed;
+    uint32_t debounce_ms;
+    uint32_t edge_ms;
+    bool debouncing;
 } stm32f4_button_hw_t;
 
 /* Global variables ------------------------------------------------------------*/
@@ -60,6 +64,32 @@ stm32f4_button_hw_t *_stm32f4_button_get(uint32_t button_id)
     }
 }
 
+/**
+ * @brief Prepara el timer del debounce por hardware: un solo disparo que para el contador al desbordar
+ *
+ * @note El prescaler se calcula cada vez que se arma con `stm32f4_button_debounce_start()`, asi que no hace falta escuchar los cambios de reloj.
+ */
+static void 	_debounce_timer_setup (void){
+	RCC -> APB2ENR |= RCC_APB2ENR_TIM10EN;
+
+	STM32F4_BUTTON_DEBOUNCE_TIM -> CR1 = TIM_CR1_OPM | TIM_CR1_URS;
+	STM32F4_BUTTON_DEBOUNCE_TIM -> CNT = 0;
+	STM32F4_BUTTON_DEBOUNCE_TIM -> SR &= ~TIM_SR_UIF;
+	STM32F4_BUTTON_DEBOUNCE_TIM -> DIER |= TIM_DIER_UIE;
+
+	NVIC_SetPriority(STM32F4_BUTTON_DEBOUNCE_IRQN, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 1, 1));
+	NVIC_EnableIRQ(STM32F4_BUTTON_DEBOUNCE_IRQN);
+}
+
+/**
+ * @brief Para el timer del debounce por hardware sin tocar la linea EXTI
+ */
+static void 	_debounce_timer_stop (void){
+	STM32F4_BUTTON_DEBOUNCE_TIM -> CR1 &= ~TIM_CR1_CEN;
+	STM32F4_BUTTON_DEBOUNCE_TIM -> SR &= ~TIM_SR_UIF;
+	NVIC_ClearPendingIRQ(STM32F4_BUTTON_DEBOUNCE_IRQN);
+}
+
 /* Public functions -----------------------------------------------------------*/
 void port_button_init(uint32_t button_id)
 {
@@ -83,6 +113,10 @@ void port_button_init(uint32_t button_id)
 		1,
 		0 
 	);
+	p_button->debouncing = false;
+	if (p_button->debounce_ms > 0){
+		_debounce_timer_setup();
+	}
 }
 
 void stm32f4_button_set_new_gpio(uint32_t button_id, GPIO_TypeDef *p_port, uint8_t pin)
@@ -104,6 +138,9 @@ bool 	port_button_get_value (uint32_t button_id){
  
 void 	port_button_set_pressed (uint32_t button_id, bool pressed){
 	stm32f4_button_hw_t *p_button = _stm32f4_button_get(button_id);
+	if (pressed != p_button->flag_pressed){
+		p_button->edge_ms = port_system_get_millis();
+	}
 	p_button->flag_pressed = pressed;
 }
  
@@ -121,3 +158,63 @@ void 	port_button_disable_interrupts (uint32_t button_id){
 	stm32f4_button_hw_t *p_button = _stm32f4_button_get(button_id);
 	stm32f4_system_gpio_exti_disable(p_button->pin);
 }
+
+void 	port_button_set_hw_debounce (uint32_t button_id, uint32_t debounce_ms){
+	stm32f4_button_hw_t *p_button = _stm32f4_button_get(button_id);
+	uint32_t max_ms = 65536U / (STM32F4_BUTTON_DEBOUNCE_TICK_HZ / 1000U);
+	p_button->debounce_ms = (debounce_ms > max_ms) ? max_ms : debounce_ms;
+	if (p_button->debounce_ms > 0){
+		_debounce_timer_setup();
+		return;
+	}
+	//Sin debounce por hardware la linea no puede quedarse enmascarada
+	_debounce_timer_stop();
+	p_button->debouncing = false;
+	EXTI->PR = BIT_POS_TO_MASK(p_button->pin);
+	EXTI->IMR |= BIT_POS_TO_MASK(p_button->pin);
+}
+
+bool 	port_button_get_hw_debounce (uint32_t button_id){
+	stm32f4_button_hw_t *p_button = _stm32f4_button_get(button_id);
+	return p_button->debounce_ms > 0;
+}
+
+uint32_t 	port_button_get_edge_ms (uint32_t button_id){
+	stm32f4_button_hw_t *p_button = _stm32f4_button_get(button_id);
+	return p_button->edge_ms;
+}
+
+bool 	port_button_get_debouncing (uint32_t button_id){
+	stm32f4_button_hw_t *p_button = _stm32f4_button_get(button_id);
+	return p_button->debouncing;
+}
+
+void 	stm32f4_button_debounce_start (uint32_t button_id){
+	stm32f4_button_hw_t *p_button = _stm32f4_button_get(button_id);
+	if (p_button->debounce_ms == 0) return;
+
+	//Los rebotes no llegan a la CPU: la linea se enmascara hasta que acaba la ventana
+	EXTI->IMR &= ~BIT_POS_TO_MASK(p_button->pin);
+	p_button->debouncing = true;
+
+	STM32F4_BUTTON_DEBOUNCE_TIM -> CR1 &= ~TIM_CR1_CEN;
+	STM32F4_BUTTON_DEBOUNCE_TIM -> PSC = stm32f4_system_get_timer_clock(STM32F4_BUTTON_DEBOUNCE_TIM) / STM32F4_BUTTON_DEBOUNCE_TICK_HZ - 1U;
+	STM32F4_BUTTON_DEBOUNCE_TIM -> ARR = p_button->debounce_ms * (STM32F4_BUTTON_DEBOUNCE_TICK_HZ / 1000U) - 1U;
+	STM32F4_BUTTON_DEBOUNCE_TIM -> CNT = 0;
+	STM32F4_BUTTON_DEBOUNCE_TIM -> EGR = TIM_EGR_UG; //Carga el PSC; con URS no levanta UIF
+	STM32F4_BUTTON_DEBOUNCE_TIM -> CR1 |= TIM_CR1_CEN;
+}
+
+void 	stm32f4_button_debounce_timeout (uint32_t button_id){
+	stm32f4_button_hw_t *p_button = _stm32f4_button_get(button_id);
+	bool pressed = !stm32f4_system_gpio_read(p_button->p_port, p_button->pin);
+	if (pressed != p_button->flag_pressed){
+		//El nivel cambio durante la ventana: se acepta el flanco perdido y se abre otra ventana
+		port_button_set_pressed(button_id, pressed);
+		stm32f4_button_debounce_start(button_id);
+		return;
+	}
+	EXTI->PR = BIT_POS_TO_MASK(p_button->pin);
+	EXTI->IMR |= BIT_POS_TO_MASK(p_button->pin);
+	p_button->debouncing = false;
+}
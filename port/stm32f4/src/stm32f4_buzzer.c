@@ -8,33 +8,69 @@
 
 /* Standard C includes */
 #include <stdio.h>
-#include <math.h>
 #include "port_buzzer.h"
+#include "port_buzzer_envelope.h"
 #include "port_system.h"
 #include "stm32f4_system.h"
+#include "port_timer.h"
 #include "stm32f4_buzzer.h"
 /* HW dependent includes */
 
 /* Microcontroller dependent includes */
 
 /* Defines --------------------------------------------------------------------*/
+#define BUZZER_DMA_BURST_LEN 3U /*!< Registros que escribe el DMA en cada paso del patron: RCR, CCR1 y CCR2 (CCR1 no tiene pin) */
+#define BUZZER_DMA_BURST_DBA 12U /*!< Primer registro de la rafaga (RCR) como desplazamiento en palabras desde CR1 */
+#define BUZZER_NOTE_TABLE_SIZE 16U /*!< Entradas de la tabla de notas: la escala de `DO` a `DO_ALTO` y el resto para otras frecuencias */
+#define BUZZER_DMA_STREAM1_FLAGS (DMA_LIFCR_CTCIF1 | DMA_LIFCR_CHTIF1 | DMA_LIFCR_CTEIF1 | DMA_LIFCR_CDMEIF1 | DMA_LIFCR_CFEIF1) /*!< Flags del stream 1 */
 
 /* Typedefs --------------------------------------------------------------------*/
 /**
- * @brief La estructura tiene los siguientes parametros: el pin y puerto del buzzer y contador de semi-periodos de actividad.
+ * @brief Registros de TIM8 para una frecuencia con el reloj actual
+ */
+typedef struct
+{
+	uint32_t freq; //frecuencia en Hz (0 entrada libre)
+	uint16_t psc; //prescaler
+	uint16_t arr; //periodo
+	uint16_t ccr_on; //CCR2 del 50%
+} stm32f4_buzzer_note_t;
+
+/**
+ * @brief La estructura tiene los siguientes parametros: el pin y puerto del buzzer, la tabla de notas, el stream del DMA de los patrones y el patron que suena.
  */
 typedef struct
 {
     GPIO_TypeDef * p_port_buzzer; //puerto del buzzer
 	uint8_t pin_buzzer; //pin del buzzer
-	uint32_t pipi_counter; //contador de semi-periodo
+	uint32_t freq; //frecuencia que esta sonando (0 en silencio), para recalcularla si cambia el reloj
+	uint32_t ccr_on; //CCR2 del 50% con el periodo actual
+	stm32f4_buzzer_note_t notes[BUZZER_NOTE_TABLE_SIZE]; //PSC, ARR y CCR2 de cada nota con el reloj actual
+	uint32_t next_note; //siguiente entrada que se reemplaza al pedir una frecuencia que no esta en la tabla
+	bool suspended; //si el hardware del buzzer esta suspendido
+	DMA_Stream_TypeDef *p_dma_stream; //stream del DMA que escribe los pasos del patron
+	uint32_t dma_channel; //canal del stream
+	bool playing; //si hay un patron cargado en el DMA
+	bool loop; //si el patron se repite sin fin
+	uint32_t num_steps; //pasos del patron
+	port_buzzer_step_t steps[PORT_BUZZER_PATTERN_MAX_STEPS]; //periodos y nivel de cada paso
+	uint16_t burst[PORT_BUZZER_PATTERN_MAX_STEPS][BUZZER_DMA_BURST_LEN]; //rafagas RCR, CCR1, CCR2 que lee el DMA
 } stm32f4_buzzer_hw_t;
 
 /* Global variables */
+/**
+ * @brief Notas que se calculan al iniciar y al cambiar el reloj. No se reemplazan nunca
+ */
+static const uint32_t buzzer_scale [] = {DO, RE, MI, FA, SOL, LA, SI, DO_ALTO};
+
 static stm32f4_buzzer_hw_t buzzers_arr []= {
 	[PORT_PARKING_BUZZER_ID] = {
 		.p_port_buzzer = STM32F4_PARKING_BUZZER_GPIO,
 		.pin_buzzer = STM32F4_PARKING_BUZZER_PIN, 
+		.suspended = false,
+		.p_dma_stream = STM32F4_PARKING_BUZZER_DMA_STREAM,
+		.dma_channel = STM32F4_PARKING_BUZZER_DMA_CHANNEL,
+		.playing = false,
 	},
 };
 /* Private functions -----------------------------------------------------------*/
@@ -47,11 +83,100 @@ stm32f4_buzzer_hw_t *_stm32f4_buzzer_get(uint32_t buzzer_id){
     }
 }
 
+/**
+ * @brief Configura el pin del buzzer como salida del canal 2 de TIM8 (funcion alternativa 3)
+ * @param p_buzzer el objeto buzzer
+ */
+static void _buzzer_gpio_config (stm32f4_buzzer_hw_t *p_buzzer){
+	stm32f4_system_gpio_config(
+		p_buzzer -> p_port_buzzer,
+		p_buzzer -> pin_buzzer,
+		STM32F4_GPIO_MODE_AF,
+		STM32F4_GPIO_PUPDR_NOPULL
+	);
+	
+	stm32f4_system_gpio_config_alternate(
+		p_buzzer -> p_port_buzzer,
+		p_buzzer -> pin_buzzer,
+		3
+	);
+}
+
+/**
+ * @brief Calcula el PSC, el ARR y el CCR2 del 50% de ciclo de trabajo de TIM8 para una frecuencia con el reloj actual del timer.
+ * @param p_note entrada de la tabla, con la frecuencia ya puesta
+ */
+static void _buzzer_note_compute (stm32f4_buzzer_note_t *p_note){
+	uint32_t psc, arr;
+	port_timer_compute_period(stm32f4_system_get_timer_clock(TIM8), 1U, p_note -> freq, &psc, &arr);
+
+	p_note -> psc = (uint16_t)psc;
+	p_note -> arr = (uint16_t)arr;
+	//50% en canal 2
+	p_note -> ccr_on = (uint16_t)((arr + 1U) / 2U);
+}
+
+/**
+ * @brief Recalcula toda la tabla de notas con el reloj actual. Las entradas de frecuencias sueltas se conservan
+ * @param p_buzzer el objeto buzzer
+ */
+static void _buzzer_notes_build (stm32f4_buzzer_hw_t *p_buzzer){
+	uint32_t num_scale = sizeof(buzzer_scale) / sizeof(buzzer_scale[0]);
+	for (uint32_t i = 0; i < BUZZER_NOTE_TABLE_SIZE; i++){
+		stm32f4_buzzer_note_t *p_note = &p_buzzer -> notes[i];
+		if (i < num_scale){
+			p_note -> freq = buzzer_scale[i];
+		}
+		if (p_note -> freq != 0){
+			_buzzer_note_compute(p_note);
+		}
+	}
+	if (p_buzzer -> next_note < num_scale){
+		p_buzzer -> next_note = num_scale;
+	}
+}
+
+/**
+ * @brief Busca una frecuencia en la tabla de notas. Si no esta, la calcula en una entrada libre o en la mas antigua de las que no son de la escala
+ * @param p_buzzer el objeto buzzer
+ * @param freq frecuencia en Hz
+ * @return entrada de la tabla con los registros de la frecuencia
+ */
+static const stm32f4_buzzer_note_t *_buzzer_note_get (stm32f4_buzzer_hw_t *p_buzzer, uint32_t freq){
+	for (uint32_t i = 0; i < BUZZER_NOTE_TABLE_SIZE; i++){
+		if (p_buzzer -> notes[i].freq == freq){
+			return &p_buzzer -> notes[i];
+		}
+	}
+	stm32f4_buzzer_note_t *p_note = &p_buzzer -> notes[p_buzzer -> next_note];
+	p_buzzer -> next_note++;
+	if (p_buzzer -> next_note >= BUZZER_NOTE_TABLE_SIZE){
+		p_buzzer -> next_note = sizeof(buzzer_scale) / sizeof(buzzer_scale[0]);
+	}
+	p_note -> freq = freq;
+	_buzzer_note_compute(p_note);
+	return p_note;
+}
+
+/**
+ * @brief Escribe el PSC y el ARR de una nota en TIM8. Con el preload entran al acabar el periodo en curso
+ * @note El CCR2 se guarda en `ccr_on` pero no se escribe: en un patron depende del paso.
+ * @param p_buzzer el objeto buzzer
+ * @param freq frecuencia en Hz.
+ */
+static void _buzzer_timer_pwm_set_freq (stm32f4_buzzer_hw_t *p_buzzer, uint32_t freq){
+	const stm32f4_buzzer_note_t *p_note = _buzzer_note_get(p_buzzer, freq);
+	TIM8 -> PSC = p_note -> psc;
+	TIM8 -> ARR = p_note -> arr;
+	p_buzzer -> ccr_on = p_note -> ccr_on;
+}
+
 /**
  * @brief Configura el timer del buzzer encargado de dictar la frecuencia del buzzer.
  * @param buzzer_id ID del objeto buzzer.
  */
 void _buzzer_timer_pwm_config (uint32_t buzzer_id){
+	stm32f4_buzzer_hw_t *p_buzzer = _stm32f4_buzzer_get(buzzer_id);
 	if (buzzer_id == PORT_PARKING_BUZZER_ID){
 		//Habilitar contador TIM8
 		RCC -> APB2ENR |= RCC_APB2ENR_TIM8EN;
@@ -65,18 +190,9 @@ void _buzzer_timer_pwm_config (uint32_t buzzer_id){
 		//Contador a cero
 		TIM8 -> CNT = 0;
 
-		//Configurar frecuencia en registros ARR y PSC
-		double sys_core_clk = (double)SystemCoreClock;
-
-		double psc = round((((sys_core_clk)/400)/(65535.0+1.0))-1.0);
-		double arr = round((((sys_core_clk)/400)/(psc+1.0))-1.0);
-		if (arr > 65535.0){
-			psc += 1.0;
-			arr = round((((sys_core_clk)/400)/(psc+1.0))-1.0);
-		}
-
-		TIM8 -> PSC = (uint32_t)psc;
-		TIM8 -> ARR = (uint32_t)arr;
+		//Configurar frecuencia en registros ARR, PSC y CCR2
+		_buzzer_timer_pwm_set_freq(p_buzzer, DO);
+		TIM8 -> CCR2 = p_buzzer -> ccr_on;
 
 		//Disable output capture en canal2
 		TIM8 -> CCER &= ~TIM_CCER_CC2E;
@@ -94,157 +210,245 @@ void _buzzer_timer_pwm_config (uint32_t buzzer_id){
 		//Preload en canal2
 		TIM8 -> CCMR1 |= TIM_CCMR1_OC2PE; 
 
-		//50% en canal 2
-		TIM8 -> CCR2 = round(((TIM8->ARR)+1)/2);
-
 		//Actualizar registros del contador	
 		TIM8 -> EGR = TIM_EGR_UG;
 	}
 }
 
 /**
- * @brief Configura el timer del buzzer encargado de dictar la el periodo de pulsación del buzzer.
+ * @brief Configura el modo rafaga de TIM8: en cada actualizacion el DMA escribe RCR, CCR1 y CCR2 a traves de DMAR
  * @param buzzer_id ID del objeto buzzer.
  */
-static void _buzzer_timer_period_config(uint32_t buzzer_id){
-	if(buzzer_id == PORT_PARKING_BUZZER_ID){
-		//Habilitar contador TIM9
-		RCC->APB2ENR |= RCC_APB2ENR_TIM9EN;
-		
-		//Disable contador
-		TIM9 -> CR1 &= ~TIM_CR1_CEN;
-
-		//Habilitar preload
-		TIM9->CR1 |= TIM_CR1_ARPE;
-
-		//Configurar frecuencia en registros ARR y PSC (25ms)
-		double psc = 16000; //convertir a ms
-		double arr = 25; // tiempo hasta overflow
-
-		TIM9 -> PSC = (uint32_t)(psc-1);
-		TIM9 -> ARR = (uint32_t)(arr-1);
-
-		//Actualizar registros del contador	
-		TIM9->EGR |= TIM_EGR_UG;
-	
-		// Habilitar interrupción al actualizar
-		TIM9 -> DIER |= TIM_DIER_UIE ;
+static void _buzzer_dma_config (uint32_t buzzer_id){
+	if (buzzer_id == PORT_PARKING_BUZZER_ID){
+		RCC -> AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+		TIM8 -> DIER &= ~TIM_DIER_UDE;
+		TIM8 -> DCR = ((BUZZER_DMA_BURST_LEN - 1U) << TIM_DCR_DBL_Pos) | (BUZZER_DMA_BURST_DBA << TIM_DCR_DBA_Pos);
+	}
+}
 
-		//Habilitar contador
-		TIM9 -> CR1 |= TIM_CR1_CEN;
+/**
+ * @brief Numero de pasos que escribe el DMA: los dos primeros los escribe la CPU al arrancar
+ * @param p_buzzer el objeto buzzer
+ * @return numero de rafagas del buffer
+ */
+static uint32_t _buzzer_pattern_dma_steps (stm32f4_buzzer_hw_t *p_buzzer){
+	return p_buzzer -> loop ? p_buzzer -> num_steps : p_buzzer -> num_steps - 2U;
+}
 
-		//Limpiar registro de interrupción
-		TIM9 -> SR &= ~TIM_SR_UIF;
-		
-		//Habilitar interrupción del TIM9
-		NVIC_EnableIRQ(TIM1_BRK_TIM9_IRQn);
+/**
+ * @brief Convierte los pasos en rafagas de registros con el periodo actual
+ *
+ * Lo que escribe el DMA en una actualizacion entra en la siguiente (RCR y CCR2 tienen preload), asi que el buffer empieza
+ * dos pasos por delante: el paso 0 se carga con UG y el paso 1 lo escribe la CPU en los registros de preload.
+ *
+ * @param p_buzzer el objeto buzzer
+ */
+static void _buzzer_pattern_render (stm32f4_buzzer_hw_t *p_buzzer){
+	uint32_t dma_steps = _buzzer_pattern_dma_steps(p_buzzer);
+	for (uint32_t i = 0; i < dma_steps; i++){
+		uint32_t step = (i + 2U) % p_buzzer -> num_steps;
+		uint16_t *p_burst = p_buzzer -> burst[i];
+		p_burst[0] = p_buzzer -> steps[step].periods - 1U;
+		p_burst[1] = 0;
+		p_burst[2] = port_buzzer_envelope_ccr((uint16_t)p_buzzer -> ccr_on, p_buzzer -> steps[step].level);
+	}
+}
 
-		//Prioridad del TIM9 a 1
-		NVIC_SetPriority(TIM1_BRK_TIM9_IRQn , NVIC_EncodePriority(NVIC_GetPriorityGrouping(),1,0));
+/**
+ * @brief Para el patron en curso. El tono se queda en el paso en el que estaba
+ * @param buzzer_id ID del objeto buzzer.
+ */
+static void _buzzer_pattern_stop (uint32_t buzzer_id){
+	stm32f4_buzzer_hw_t *p_buzzer = _stm32f4_buzzer_get(buzzer_id);
+	if (buzzer_id == PORT_PARKING_BUZZER_ID){
+		TIM8 -> DIER &= ~TIM_DIER_UDE;
 	}
+	p_buzzer -> p_dma_stream -> CR &= ~DMA_SxCR_EN;
+	while (p_buzzer -> p_dma_stream -> CR & DMA_SxCR_EN){
+	}
+	p_buzzer -> playing = false;
 }
 
 void port_buzzer_set_freq (uint32_t buzzer_id, buzzer_t nota){
+	stm32f4_buzzer_hw_t *p_buzzer = _stm32f4_buzzer_get(buzzer_id);
+	//Sin reloj en el timer las escrituras se perderian
+	if (p_buzzer->suspended) return;
+	bool was_playing = p_buzzer -> playing;
+	if (was_playing){
+		_buzzer_pattern_stop(buzzer_id);
+	}
+	p_buzzer -> freq = nota.freq;
 	if (buzzer_id == PORT_PARKING_BUZZER_ID){
-		
-		//Disable timer
-		TIM8 -> CR1 &= ~TIM_CR1_CEN;
-
-		//Disable output capture en canal2
-		TIM8 -> CCER &= ~TIM_CCER_CC2E;
-
-		//Disable output mode
-		TIM8->BDTR &= ~TIM_BDTR_MOE;
-
-		//Contador a cero
-		TIM8 -> CNT = 0;
-
-		if (nota.freq == 0) return;
-
-		//Configurar frecuencia en registros ARR y PSC
-		double sys_core_clk = (double)SystemCoreClock;
-
-		double freq = (double)nota.freq;
-
-		double psc = round((((sys_core_clk)/freq)/(65535.0+1.0))-1.0);
-		double arr = round((((sys_core_clk)/freq)/(psc+1.0))-1.0);
-		if (arr > 65535.0){
-			psc += 1.0;
-			arr = round((((sys_core_clk)/freq)/(psc+1.0))-1.0);
+		if (nota.freq == 0){
+			//Silencio con el contador en marcha: el pulso en curso acaba entero y no hay chasquido
+			TIM8 -> CCR2 = 0;
+		}else{
+			//PSC, ARR y CCR2 con preload: la nota nueva entra al acabar el periodo en curso
+			_buzzer_timer_pwm_set_freq(p_buzzer, nota.freq);
+			TIM8 -> CCR2 = p_buzzer -> ccr_on;
 		}
+		//Una actualizacion por periodo
+		TIM8 -> RCR = 0;
 
-		TIM8 -> PSC = (uint32_t)psc;
-		TIM8 -> ARR = (uint32_t)arr;
+		if (TIM8 -> CR1 & TIM_CR1_CEN){
+			//Un paso del patron puede durar 256 periodos: se corta para que el cambio no espere a que acabe
+			if (was_playing) TIM8 -> EGR = TIM_EGR_UG;
+			return;
+		}
+		if (nota.freq == 0) return;
 
-		//Limpiar bits de polaridad de canal2
+		//Primera nota tras init o resume: se arranca el PWM
 		TIM8 -> CCER &= ~TIM_CCER_CC2NP;
 		TIM8 -> CCER &= ~TIM_CCER_CC2P;
-		
-		//enable pwm mode1 de canal2
-		TIM8 -> CCMR1 &= ~TIM_CCMR1_OC2M_0;
-		TIM8 -> CCMR1 |= TIM_CCMR1_OC2M_1;
-		TIM8 -> CCMR1 |= TIM_CCMR1_OC2M_2;
-
-		//preload en canal2
-		TIM8 -> CCMR1 |= TIM_CCMR1_OC2PE;
-
-		//output mode activate
-		TIM8->BDTR |= TIM_BDTR_MOE;
-
-		//50% en canal 2
-		TIM8 -> CCR2 = round(((TIM8->ARR)+1)/2);
-
-		//Enable output capture en canal2
+		TIM8 -> BDTR |= TIM_BDTR_MOE;
 		TIM8 -> CCER |= TIM_CCER_CC2E;
-
-		//Actualizar valores de reloj
+		TIM8 -> CNT = 0;
 		TIM8 -> EGR = TIM_EGR_UG;
-
-		//Habilitar contador
 		TIM8 -> CR1 |= TIM_CR1_CEN;
 	}
 }
 
-/* Public functions -----------------------------------------------------------*/
-void port_buzzer_counter_add(uint32_t buzzer_id){
+/**
+ * @brief Recalcula el timer del buzzer tras un cambio de reloj del sistema, sin cortar la nota ni el patron que suena
+ * @note Con un patron, el UG adelanta el final del paso en curso; el DMA sigue con el siguiente.
+ * @param buzzer_id ID del objeto buzzer.
+ */
+static void _buzzer_retime_id (uint32_t buzzer_id){
 	stm32f4_buzzer_hw_t *p_buzzer = _stm32f4_buzzer_get(buzzer_id);
-	p_buzzer->pipi_counter += 1;
+	_buzzer_notes_build(p_buzzer);
+	if (buzzer_id == PORT_PARKING_BUZZER_ID){
+		if (p_buzzer -> freq != 0){
+			uint32_t old_ccr_on = p_buzzer -> ccr_on;
+			_buzzer_timer_pwm_set_freq(p_buzzer, p_buzzer -> freq);
+			if (p_buzzer -> playing){
+				//El siguiente paso ya esta en el preload: se escala su nivel al nuevo periodo
+				TIM8 -> CCR2 = (TIM8 -> CCR2 * p_buzzer -> ccr_on + old_ccr_on / 2U) / old_ccr_on;
+				_buzzer_pattern_render(p_buzzer);
+			}else{
+				TIM8 -> CCR2 = p_buzzer -> ccr_on;
+			}
+			TIM8 -> EGR = TIM_EGR_UG;
+		}
+	}
 }
 
-void port_buzzer_counter_reset(uint32_t buzzer_id){
-	stm32f4_buzzer_hw_t *p_buzzer = _stm32f4_buzzer_get(buzzer_id);
-	TIM9 -> CR1 &= ~TIM_CR1_CEN;
-	TIM9 -> CNT = 0;
-	p_buzzer -> pipi_counter = 0;
-	TIM9 -> CR1 |= TIM_CR1_CEN;
+/**
+ * @brief Avisado por el sistema cuando cambia el reloj. Los buzzers suspendidos se recalculan al reanudarse
+ */
+static void _buzzer_retime (void){
+	for (uint32_t buzzer_id = 0; buzzer_id < sizeof(buzzers_arr) / sizeof(buzzers_arr[0]); buzzer_id++){
+		if (!buzzers_arr[buzzer_id].suspended){
+			_buzzer_retime_id(buzzer_id);
+		}
+	}
 }
 
-uint32_t get_port_buzzer_counter(uint32_t buzzer_id){
+/* Public functions -----------------------------------------------------------*/
+bool port_buzzer_play_pattern (uint32_t buzzer_id, buzzer_pattern_t pattern){
 	stm32f4_buzzer_hw_t *p_buzzer = _stm32f4_buzzer_get(buzzer_id);
-	return p_buzzer -> pipi_counter;
+	if (p_buzzer -> suspended) return false;
+	if (pattern.freq == 0 || pattern.volume == 0){
+		//Silencio: no hay pasos
+		port_buzzer_set_freq(buzzer_id, BUZZER_OFF);
+		return true;
+	}
+	if (p_buzzer -> playing){
+		_buzzer_pattern_stop(buzzer_id);
+	}
+	p_buzzer -> num_steps = port_buzzer_envelope_build(pattern, p_buzzer -> steps, PORT_BUZZER_PATTERN_MAX_STEPS, &p_buzzer -> loop);
+	if (p_buzzer -> num_steps == 0){
+		port_buzzer_set_freq(buzzer_id, BUZZER_OFF);
+		return false;
+	}
+
+	if (buzzer_id == PORT_PARKING_BUZZER_ID){
+		TIM8 -> CR1 &= ~TIM_CR1_CEN;
+		TIM8 -> CNT = 0;
+		p_buzzer -> freq = pattern.freq;
+		_buzzer_timer_pwm_set_freq(p_buzzer, pattern.freq);
+		_buzzer_pattern_render(p_buzzer);
+
+		//Paso 0 a los registros activos con UG y paso 1 al preload
+		TIM8 -> RCR = p_buzzer -> steps[0].periods - 1U;
+		TIM8 -> CCR2 = port_buzzer_envelope_ccr((uint16_t)p_buzzer -> ccr_on, p_buzzer -> steps[0].level);
+		TIM8 -> EGR = TIM_EGR_UG;
+		TIM8 -> RCR = p_buzzer -> steps[1].periods - 1U;
+		TIM8 -> CCR2 = port_buzzer_envelope_ccr((uint16_t)p_buzzer -> ccr_on, p_buzzer -> steps[1].level);
+
+		DMA_Stream_TypeDef *p_stream = p_buzzer -> p_dma_stream;
+		DMA2 -> LIFCR = BUZZER_DMA_STREAM1_FLAGS;
+		p_stream -> PAR = (uint32_t)&(TIM8 -> DMAR);
+		p_stream -> M0AR = (uint32_t)p_buzzer -> burst;
+		p_stream -> NDTR = _buzzer_pattern_dma_steps(p_buzzer) * BUZZER_DMA_BURST_LEN;
+		//Memoria a periferico, de 16 en 16 bits, incrementando la memoria. En modo circular se repite solo
+		p_stream -> CR = (p_buzzer -> dma_channel << DMA_SxCR_CHSEL_Pos)
+			| DMA_SxCR_DIR_0
+			| DMA_SxCR_MINC
+			| DMA_SxCR_PSIZE_0
+			| DMA_SxCR_MSIZE_0
+			| (p_buzzer -> loop ? DMA_SxCR_CIRC : 0);
+		p_stream -> CR |= DMA_SxCR_EN;
+		TIM8 -> DIER |= TIM_DIER_UDE;
+		p_buzzer -> playing = true;
+
+		TIM8 -> CCER &= ~(TIM_CCER_CC2NP | TIM_CCER_CC2P);
+		TIM8 -> BDTR |= TIM_BDTR_MOE;
+		TIM8 -> CCER |= TIM_CCER_CC2E;
+		TIM8 -> CR1 |= TIM_CR1_CEN;
+	}
+	return true;
 }
 
 void port_buzzer_init (uint32_t buzzer_id){
 	stm32f4_buzzer_hw_t *p_buzzer = _stm32f4_buzzer_get(buzzer_id);
-	p_buzzer -> pipi_counter = 0;
-	stm32f4_system_gpio_config(
-		p_buzzer -> p_port_buzzer,
-		p_buzzer -> pin_buzzer,
-		STM32F4_GPIO_MODE_AF,
-		STM32F4_GPIO_PUPDR_NOPULL
-	);
-	
-	stm32f4_system_gpio_config_alternate(
-		p_buzzer -> p_port_buzzer,
-		p_buzzer -> pin_buzzer,
-		3
-	);
+	p_buzzer -> freq = 0;
+	p_buzzer -> suspended = false;
+	p_buzzer -> playing = false;
+	p_buzzer -> next_note = 0;
+	_buzzer_notes_build(p_buzzer);
+	_buzzer_gpio_config(p_buzzer);
 
 	_buzzer_timer_pwm_config(buzzer_id);
-	_buzzer_timer_period_config(buzzer_id);
+	_buzzer_dma_config(buzzer_id);
+	stm32f4_system_clock_listener_register(_buzzer_retime);
 	
 	//Check if buzzer works
 	//port_buzzer_set_freq(buzzer_id,(buzzer_t){600,1});
 	//port_system_delay_ms(1000);
 	//port_buzzer_set_freq(buzzer_id,(buzzer_t){0,1});
 }
+
+void port_buzzer_suspend (uint32_t buzzer_id){
+	stm32f4_buzzer_hw_t *p_buzzer = _stm32f4_buzzer_get(buzzer_id);
+	if (p_buzzer -> suspended) return;
+
+	if (p_buzzer -> playing){
+		_buzzer_pattern_stop(buzzer_id);
+	}
+	if (buzzer_id == PORT_PARKING_BUZZER_ID){
+		//Silenciar el PWM
+		TIM8 -> CR1 &= ~TIM_CR1_CEN;
+		TIM8 -> CCER &= ~TIM_CCER_CC2E;
+		TIM8 -> BDTR &= ~TIM_BDTR_MOE;
+
+		//Sin reloj el timer conserva sus registros
+		RCC -> APB2ENR &= ~RCC_APB2ENR_TIM8EN;
+	}
+
+	stm32f4_system_gpio_park(p_buzzer -> p_port_buzzer, p_buzzer -> pin_buzzer);
+	p_buzzer -> freq = 0;
+	p_buzzer -> suspended = true;
+}
+
+void port_buzzer_resume (uint32_t buzzer_id){
+	stm32f4_buzzer_hw_t *p_buzzer = _stm32f4_buzzer_get(buzzer_id);
+	if (!(p_buzzer -> suspended)) return;
+
+	_buzzer_gpio_config(p_buzzer);
+	if (buzzer_id == PORT_PARKING_BUZZER_ID){
+		RCC -> APB2ENR |= RCC_APB2ENR_TIM8EN;
+	}
+	//Vuelve en silencio: el siguiente tono o patron calcula el periodo con el reloj actual
+	p_buzzer -> suspended = false;
+}
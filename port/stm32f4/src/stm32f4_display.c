@@ -8,16 +8,19 @@
 
 /* Standard C includes */
 #include <stdio.h>
-#include <math.h>
 #include "port_display.h"
 #include "port_system.h"
 #include "stm32f4_system.h"
+#include "port_timer.h"
 #include "stm32f4_display.h"
 /* HW dependent includes */
 
 /* Microcontroller dependent includes */
 
 /* Defines --------------------------------------------------------------------*/
+#define DISPLAY_DMA_BURST_LEN 4U /*!< Registros que escribe el DMA en cada actualizacion de TIM4: CCR1, CCR2, CCR3 y CCR4 (CCR2 no tiene pin) */
+#define DISPLAY_DMA_BURST_DBA 13U /*!< Primer registro de la rafaga (CCR1) como desplazamiento en palabras desde CR1 */
+#define DISPLAY_DMA_STREAM6_FLAGS (DMA_HIFCR_CTCIF6 | DMA_HIFCR_CHTIF6 | DMA_HIFCR_CTEIF6 | DMA_HIFCR_CDMEIF6 | DMA_HIFCR_CFEIF6) /*!< Flags del stream 6 */
 
 /* Typedefs --------------------------------------------------------------------*/
 /**
@@ -31,6 +34,15 @@ typedef struct
 	uint8_t pin_green;
 	GPIO_TypeDef *p_port_blue;
 	uint8_t pin_blue;
+	bool suspended; //si el hardware del display esta suspendido
+	rgb_color_t color; //color que esta mostrando el display (COLOR_OFF con el timer parado)
+	uint32_t ccr_lut[PORT_DISPLAY_RGB_MAX_VALUE + 1]; //valor de CCR para cada nivel de color con el periodo actual
+	DMA_Stream_TypeDef *p_dma_stream; //stream del DMA que escribe las animaciones en los CCR
+	uint32_t dma_channel; //canal del stream
+	const rgb_color_t *p_frames; //fotogramas de la animacion en curso (NULL sin animacion)
+	uint32_t num_frames; //numero de fotogramas de la animacion en curso
+	bool loop; //si la animacion en curso se repite
+	uint16_t anim_ccr[PORT_DISPLAY_ANIM_MAX_FRAMES][DISPLAY_DMA_BURST_LEN]; //rafagas CCR1..CCR4 que lee el DMA
 } stm32f4_display_hw_t;
 
 /* Global variables */
@@ -42,6 +54,11 @@ static stm32f4_display_hw_t displays_arr []= {
 		.pin_green = STM32F4_REAR_PARKING_DISPLAY_RGB_G_PIN,
 		.p_port_blue = STM32F4_REAR_PARKING_DISPLAY_RGB_B_GPIO,
 		.pin_blue = STM32F4_REAR_PARKING_DISPLAY_RGB_B_PIN, 
+		.suspended = false,
+		.color = {0, 0, 0},
+		.p_dma_stream = STM32F4_REAR_PARKING_DISPLAY_DMA_STREAM,
+		.dma_channel = STM32F4_REAR_PARKING_DISPLAY_DMA_CHANNEL,
+		.p_frames = NULL,
 	},
 };
 /* Private functions -----------------------------------------------------------*/
@@ -54,6 +71,28 @@ stm32f4_display_hw_t *_stm32f4_display_get(uint32_t display_id){
     }
 }
 
+/**
+ * @brief Calcula el PSC y el ARR del PWM de los colores (50 Hz) con el reloj actual del timer
+ * @param display_id el ID del display
+ */
+static void _timer_pwm_set_period (uint32_t display_id){
+	stm32f4_display_hw_t *p_display = _stm32f4_display_get(display_id);
+	if (display_id == PORT_REAR_PARKING_DISPLAY_ID){
+		uint32_t psc, arr;
+		port_timer_compute_period(stm32f4_system_get_timer_clock(TIM4), 1U, 50U, &psc, &arr);
+
+		TIM4 -> PSC = psc;
+		TIM4 -> ARR = arr;
+
+		//Los CCR solo dependen del periodo: se calculan aqui y al cambiar de color basta con leer la tabla
+		for (uint32_t level = 0; level <= PORT_DISPLAY_RGB_MAX_VALUE; level++){
+			uint32_t ccr = (level * (arr + 1U)) / PORT_DISPLAY_RGB_MAX_VALUE;
+			//Con ARR = 65535 el 100% seria 65536, que no cabe en 16 bits
+			p_display -> ccr_lut[level] = (ccr > 0xFFFFU) ? 0xFFFFU : ccr;
+		}
+	}
+}
+
 /**
  * @brief Configuración del timer que se encarga del PWM de los colores
  * @param display_id el ID del display
@@ -66,17 +105,7 @@ void _timer_pwm_config (uint32_t display_id){
 
 		TIM4 -> CNT = 0;
 
-		double sys_core_clk = (double)SystemCoreClock;
-
-		double psc = round((((sys_core_clk)/50)/(65535.0+1.0))-1.0);
-		double arr = round((((sys_core_clk)/50)/(psc+1.0))-1.0);
-		if (arr > 65535.0){
-			psc += 1.0;
-			arr = round((((sys_core_clk)/50)/(psc+1.0))-1.0);
-		}
-
-		TIM4 -> PSC = (uint32_t)psc;
-		TIM4 -> ARR = (uint32_t)arr;
+		_timer_pwm_set_period(display_id);
 
 		TIM4 -> CCER &= ~TIM_CCER_CC1E;
 		TIM4 -> CCER &= ~TIM_CCER_CC3E;
@@ -106,49 +135,11 @@ void _timer_pwm_config (uint32_t display_id){
 		TIM4 -> CCMR2 |= TIM_CCMR2_OC4PE;
 	}
 }
-/* Public functions -----------------------------------------------------------*/
-void port_display_set_rgb (uint32_t display_id, rgb_color_t color){
-	if (display_id == PORT_REAR_PARKING_DISPLAY_ID){
-		uint8_t r = color.r;
-		uint8_t g = color.g;
-		uint8_t b = color.b;
-
-		TIM4 -> CR1 &= ~TIM_CR1_CEN;
-		TIM4 ->CNT = 0;
-		if (r == 0 && g == 0 && b == 0){
-			TIM4 -> CCER &= ~TIM_CCER_CC1E;
-			TIM4 -> CCER &= ~TIM_CCER_CC3E;
-			TIM4 -> CCER &= ~TIM_CCER_CC4E;
-			return;
-		}
-
-		if (r == 0){
-			TIM4 -> CCER &= ~TIM_CCER_CC1E;
-		}else{
-			TIM4 -> CCR1 = round(r*((TIM4->ARR)+1)/PORT_DISPLAY_RGB_MAX_VALUE);
-			TIM4 -> CCER |= TIM_CCER_CC1E;
-		}
-		if (g == 0){
-			TIM4 -> CCER &= ~TIM_CCER_CC3E;
-		}else{
-			TIM4 -> CCR3 = round(g*((TIM4->ARR)+1)/PORT_DISPLAY_RGB_MAX_VALUE);
-			TIM4 -> CCER |= TIM_CCER_CC3E;
-		}
-		if (b == 0){
-			TIM4 -> CCER &= ~TIM_CCER_CC4E;
-		}else{
-			TIM4 -> CCR4 = round(b*((TIM4->ARR)+1)/PORT_DISPLAY_RGB_MAX_VALUE);
-			TIM4 -> CCER |= TIM_CCER_CC4E;
-		}
-
-		TIM4 -> EGR |= TIM_EGR_UG;
-		TIM4 -> CR1 |= TIM_CR1_CEN;
-	}
-}
-
-void port_display_init (uint32_t display_id){
-	stm32f4_display_hw_t *p_display = _stm32f4_display_get(display_id);
-	
+/**
+ * @brief Configura los pines del display como salidas del timer (funcion alternativa 2)
+ * @param p_display el objeto display
+ */
+static void _display_gpio_config (stm32f4_display_hw_t *p_display){
 	stm32f4_system_gpio_config(
 		p_display -> p_port_blue,
 		p_display -> pin_blue,
@@ -183,7 +174,228 @@ void port_display_init (uint32_t display_id){
 		p_display -> pin_red,
 		2
 	);
+}
+/**
+ * @brief Configura el modo rafaga de TIM4: en cada actualizacion el DMA escribe CCR1..CCR4 a traves de DMAR
+ * @param display_id el ID del display
+ */
+static void _display_dma_config (uint32_t display_id){
+	if (display_id == PORT_REAR_PARKING_DISPLAY_ID){
+		RCC -> AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+		TIM4 -> DIER &= ~TIM_DIER_UDE;
+		TIM4 -> DCR = ((DISPLAY_DMA_BURST_LEN - 1U) << TIM_DCR_DBL_Pos) | (DISPLAY_DMA_BURST_DBA << TIM_DCR_DBA_Pos);
+	}
+}
+
+/**
+ * @brief Convierte los fotogramas de la animacion en curso en rafagas de CCR con el periodo actual
+ * @param p_display el objeto display
+ */
+static void _display_anim_render (stm32f4_display_hw_t *p_display){
+	for (uint32_t i = 0; i < p_display -> num_frames; i++){
+		rgb_color_t color = p_display -> p_frames[i];
+		uint16_t *p_burst = p_display -> anim_ccr[i];
+		//La tabla ya esta limitada a 16 bits
+		p_burst[0] = (uint16_t)p_display -> ccr_lut[color.r];
+		p_burst[1] = 0;
+		p_burst[2] = (uint16_t)p_display -> ccr_lut[color.g];
+		p_burst[3] = (uint16_t)p_display -> ccr_lut[color.b];
+	}
+}
+
+/**
+ * @brief Para la animacion en curso. Los CCR se quedan con el ultimo fotograma escrito
+ * @param display_id el ID del display
+ */
+static void _display_anim_stop (uint32_t display_id){
+	stm32f4_display_hw_t *p_display = _stm32f4_display_get(display_id);
+	if (display_id == PORT_REAR_PARKING_DISPLAY_ID){
+		TIM4 -> DIER &= ~TIM_DIER_UDE;
+	}
+	p_display -> p_dma_stream -> CR &= ~DMA_SxCR_EN;
+	while (p_display -> p_dma_stream -> CR & DMA_SxCR_EN){
+	}
+	p_display -> p_frames = NULL;
+}
+
+/**
+ * @brief Recalcula el PWM de los colores tras un cambio de reloj del sistema, conservando el color que se muestra
+ * @param display_id el ID del display
+ */
+static void _display_retime_id (uint32_t display_id){
+	stm32f4_display_hw_t *p_display = _stm32f4_display_get(display_id);
+	if (display_id == PORT_REAR_PARKING_DISPLAY_ID){
+		_timer_pwm_set_period(display_id);
+
+		//Mismo color con el nuevo periodo
+		TIM4 -> CCR1 = p_display -> ccr_lut[p_display -> color.r];
+		TIM4 -> CCR3 = p_display -> ccr_lut[p_display -> color.g];
+		TIM4 -> CCR4 = p_display -> ccr_lut[p_display -> color.b];
+
+		//El DMA sigue leyendo el buffer: las siguientes rafagas ya salen con el nuevo periodo
+		if (p_display -> p_frames != NULL){
+			_display_anim_render(p_display);
+		}
+
+		TIM4 -> EGR = TIM_EGR_UG;
+	}
+}
+
+/**
+ * @brief Avisado por el sistema cuando cambia el reloj. Los displays suspendidos se recalculan al reanudarse
+ */
+static void _display_retime (void){
+	for (uint32_t display_id = 0; display_id < sizeof(displays_arr) / sizeof(displays_arr[0]); display_id++){
+		if (!displays_arr[display_id].suspended){
+			_display_retime_id(display_id);
+		}
+	}
+}
+/* Public functions -----------------------------------------------------------*/
+void port_display_set_rgb (uint32_t display_id, rgb_color_t color){
+	stm32f4_display_hw_t *p_display = _stm32f4_display_get(display_id);
+	//Sin reloj en el timer las escrituras se perderian
+	if (p_display->suspended) return;
+	rgb_color_t last = p_display -> color;
+	bool animating = (p_display -> p_frames != NULL);
+	if (animating){
+		//Los CCR tienen el fotograma en el que se ha quedado la animacion
+		_display_anim_stop(display_id);
+	}else if (color.r == last.r && color.g == last.g && color.b == last.b){
+		return;
+	}
+	p_display -> color = color;
+
+	if (display_id == PORT_REAR_PARKING_DISPLAY_ID){
+		if (color.r == 0 && color.g == 0 && color.b == 0){
+			//Apagado: se para el timer y se quitan las salidas. El siguiente color vuelve a arrancar el PWM
+			TIM4 -> CR1 &= ~TIM_CR1_CEN;
+			TIM4 -> CCER &= ~(TIM_CCER_CC1E | TIM_CCER_CC3E | TIM_CCER_CC4E);
+			TIM4 -> CCR1 = 0;
+			TIM4 -> CCR3 = 0;
+			TIM4 -> CCR4 = 0;
+			return;
+		}
+
+		if ((TIM4 -> CR1 & TIM_CR1_CEN) && !animating){
+			//Con el contador en marcha solo se escriben los canales que cambian. Con el preload
+			//los CCR nuevos se cargan al acabar el periodo en curso, sin pulsos cortados
+			if (color.r != last.r) TIM4 -> CCR1 = p_display -> ccr_lut[color.r];
+			if (color.g != last.g) TIM4 -> CCR3 = p_display -> ccr_lut[color.g];
+			if (color.b != last.b) TIM4 -> CCR4 = p_display -> ccr_lut[color.b];
+			return;
+		}
+
+		TIM4 -> CCR1 = p_display -> ccr_lut[color.r];
+		TIM4 -> CCR3 = p_display -> ccr_lut[color.g];
+		TIM4 -> CCR4 = p_display -> ccr_lut[color.b];
+		if (TIM4 -> CR1 & TIM_CR1_CEN) return;
+
+		//Primer color tras init o resume: se arranca el PWM con los tres canales
+		TIM4 -> CCER |= (TIM_CCER_CC1E | TIM_CCER_CC3E | TIM_CCER_CC4E);
+
+		TIM4 -> CNT = 0;
+		TIM4 -> EGR = TIM_EGR_UG;
+		TIM4 -> CR1 |= TIM_CR1_CEN;
+	}
+}
+
+bool port_display_animate (uint32_t display_id, const rgb_color_t *p_frames, uint32_t num_frames, bool loop){
+	stm32f4_display_hw_t *p_display = _stm32f4_display_get(display_id);
+	if (p_display->suspended) return false;
+	if (num_frames == 0 || num_frames > PORT_DISPLAY_ANIM_MAX_FRAMES) return false;
+
+	if (p_display -> p_frames != NULL){
+		if (num_frames == p_display -> num_frames && loop == p_display -> loop){
+			//Misma animacion con otros colores: se reescribe el buffer sin reiniciar el DMA, asi no se pierde la fase
+			p_display -> p_frames = p_frames;
+			_display_anim_render(p_display);
+			return true;
+		}
+		_display_anim_stop(display_id);
+	}
+	p_display -> p_frames = p_frames;
+	p_display -> loop = loop;
+	p_display -> num_frames = num_frames;
+	_display_anim_render(p_display);
+
+	if (display_id == PORT_REAR_PARKING_DISPLAY_ID){
+		//El primer fotograma se escribe ya; el DMA empieza a escribir en la siguiente actualizacion
+		TIM4 -> CCR1 = p_display -> anim_ccr[0][0];
+		TIM4 -> CCR3 = p_display -> anim_ccr[0][2];
+		TIM4 -> CCR4 = p_display -> anim_ccr[0][3];
+		if (!(TIM4 -> CR1 & TIM_CR1_CEN)){
+			TIM4 -> CCER |= (TIM_CCER_CC1E | TIM_CCER_CC3E | TIM_CCER_CC4E);
+			TIM4 -> CNT = 0;
+			TIM4 -> EGR = TIM_EGR_UG;
+			TIM4 -> CR1 |= TIM_CR1_CEN;
+		}
+
+		DMA_Stream_TypeDef *p_stream = p_display -> p_dma_stream;
+		DMA1 -> HIFCR = DISPLAY_DMA_STREAM6_FLAGS;
+		p_stream -> PAR = (uint32_t)&(TIM4 -> DMAR);
+		p_stream -> M0AR = (uint32_t)p_display -> anim_ccr;
+		p_stream -> NDTR = num_frames * DISPLAY_DMA_BURST_LEN;
+		//Memoria a periferico, de 16 en 16 bits, incrementando la memoria. En modo circular se repite sola
+		p_stream -> CR = (p_display -> dma_channel << DMA_SxCR_CHSEL_Pos)
+			| DMA_SxCR_DIR_0
+			| DMA_SxCR_MINC
+			| DMA_SxCR_PSIZE_0
+			| DMA_SxCR_MSIZE_0
+			| (loop ? DMA_SxCR_CIRC : 0);
+		p_stream -> CR |= DMA_SxCR_EN;
+
+		TIM4 -> DIER |= TIM_DIER_UDE;
+	}
+	return true;
+}
+
+void port_display_init (uint32_t display_id){
+	stm32f4_display_hw_t *p_display = _stm32f4_display_get(display_id);
+	p_display->suspended = false;
+	//Con el timer parado y las salidas deshabilitadas el display esta apagado
+	p_display->color = COLOR_OFF;
+	
+	_display_gpio_config(p_display);
 
 	_timer_pwm_config(display_id);
+	_display_dma_config(display_id);
+	p_display->p_frames = NULL;
 	port_display_set_rgb(display_id,COLOR_OFF);
+	stm32f4_system_clock_listener_register(_display_retime);
+}
+
+void port_display_suspend (uint32_t display_id){
+	stm32f4_display_hw_t *p_display = _stm32f4_display_get(display_id);
+	if (p_display->suspended) return;
+
+	if (p_display -> p_frames != NULL){
+		_display_anim_stop(display_id);
+	}
+	if (display_id == PORT_REAR_PARKING_DISPLAY_ID){
+		TIM4 -> CR1 &= ~TIM_CR1_CEN;
+		TIM4 -> CCER &= ~(TIM_CCER_CC1E | TIM_CCER_CC3E | TIM_CCER_CC4E);
+		//Sin reloj el timer conserva sus registros
+		RCC -> APB1ENR &= ~RCC_APB1ENR_TIM4EN;
+	}
+
+	stm32f4_system_gpio_park(p_display -> p_port_red, p_display -> pin_red);
+	stm32f4_system_gpio_park(p_display -> p_port_green, p_display -> pin_green);
+	stm32f4_system_gpio_park(p_display -> p_port_blue, p_display -> pin_blue);
+	//Al reanudar, el primer color distinto de apagado vuelve a arrancar el PWM
+	p_display->color = COLOR_OFF;
+	p_display->suspended = true;
+}
+
+void port_display_resume (uint32_t display_id){
+	stm32f4_display_hw_t *p_display = _stm32f4_display_get(display_id);
+	if (!p_display->suspended) return;
+
+	_display_gpio_config(p_display);
+	if (display_id == PORT_REAR_PARKING_DISPLAY_ID){
+		RCC -> APB1ENR |= RCC_APB1ENR_TIM4EN;
+	}
+	//El reloj del sistema puede haber cambiado mientras estaba suspendido
+	_display_retime_id(display_id);
+	p_display->suspended = false;
 }
@@ -0,0 +1,214 @@
+/**
+ * @file stm32f4_display_bar.c
+ * @brief Portable functions to interact with a WS2812 LED bar. The bit stream is generated by SPI1 fed by DMA.
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-10
+ */
+
+/* Standard C includes */
+#include <stddef.h>
+#include "port_display.h"
+#include "port_ws2812.h"
+#include "stm32f4_system.h"
+#include "stm32f4_display_bar.h"
+/* HW dependent includes */
+
+/* Microcontroller dependent includes */
+
+/* Defines --------------------------------------------------------------------*/
+#define BAR_DMA_STREAM3_FLAGS (DMA_LIFCR_CTCIF3 | DMA_LIFCR_CHTIF3 | DMA_LIFCR_CTEIF3 | DMA_LIFCR_CDMEIF3 | DMA_LIFCR_CFEIF3) /*!< Flags del stream 3 */
+
+/* Typedefs --------------------------------------------------------------------*/
+/**
+ * @brief Esta estructura tiene los siguientes elementos: el puerto, pin y funcion alternativa de datos, el SPI y el stream del DMA
+ * que envian la trama, el frame buffer y la trama codificada
+ */
+typedef struct
+{
+	GPIO_TypeDef *p_port;
+	uint8_t pin;
+	uint8_t alternate;
+	SPI_TypeDef *p_spi;
+	DMA_Stream_TypeDef *p_dma_stream;
+	uint32_t dma_channel;
+	bool suspended; //si el hardware de la barra esta suspendido
+	rgb_color_t frame [PORT_DISPLAY_BAR_NUM_LEDS]; //frame buffer, un color por LED
+	uint8_t stream [PORT_WS2812_BUFFER_SIZE(PORT_DISPLAY_BAR_NUM_LEDS)]; //trama que lee el DMA
+} stm32f4_display_bar_hw_t;
+
+/* Global variables */
+static stm32f4_display_bar_hw_t bars_arr []= {
+	[PORT_REAR_PARKING_BAR_ID] = {
+		.p_port = STM32F4_REAR_PARKING_BAR_GPIO,
+		.pin = STM32F4_REAR_PARKING_BAR_PIN,
+		.alternate = STM32F4_REAR_PARKING_BAR_AF,
+		.p_spi = STM32F4_REAR_PARKING_BAR_SPI,
+		.p_dma_stream = STM32F4_REAR_PARKING_BAR_DMA_STREAM,
+		.dma_channel = STM32F4_REAR_PARKING_BAR_DMA_CHANNEL,
+		.suspended = false,
+	},
+};
+/* Private functions -----------------------------------------------------------*/
+stm32f4_display_bar_hw_t *_stm32f4_display_bar_get(uint32_t bar_id){
+	if (bar_id < sizeof(bars_arr) / sizeof(bars_arr[0])){
+		return &bars_arr[bar_id];
+	}
+	else{
+		return NULL;
+	}
+}
+
+/**
+ * @brief Comprueba si el DMA sigue enviando la trama. En modo normal el stream se deshabilita solo al acabar
+ * @param p_bar el objeto barra
+ * @return true si todavia se esta enviando
+ */
+static bool _bar_busy (stm32f4_display_bar_hw_t *p_bar){
+	return (p_bar -> p_dma_stream -> CR & DMA_SxCR_EN) || (p_bar -> p_spi -> SR & SPI_SR_BSY);
+}
+
+/**
+ * @brief Elige el prescaler del SPI con el reloj actual: el mas pequeño que no pasa de `STM32F4_BAR_SPI_MAX_HZ`
+ * @param bar_id el ID de la barra
+ */
+static void _bar_spi_set_rate (uint32_t bar_id){
+	stm32f4_display_bar_hw_t *p_bar = _stm32f4_display_bar_get(bar_id);
+	uint32_t spi_clk = stm32f4_system_get_spi_clock(p_bar -> p_spi);
+	//BR = n divide entre 2^(n+1)
+	uint32_t br = 0;
+	while (br < 7U && (spi_clk >> (br + 1U)) > STM32F4_BAR_SPI_MAX_HZ){
+		br++;
+	}
+	//El prescaler no se puede cambiar con el SPI habilitado
+	while (_bar_busy(p_bar)){
+	}
+	p_bar -> p_spi -> CR1 &= ~SPI_CR1_SPE;
+	p_bar -> p_spi -> CR1 = (p_bar -> p_spi -> CR1 & ~SPI_CR1_BR) | (br << SPI_CR1_BR_Pos);
+	p_bar -> p_spi -> CR1 |= SPI_CR1_SPE;
+}
+
+/**
+ * @brief Configura el pin de datos como MOSI del SPI. Con el pull-down la linea esta a nivel bajo antes de la primera trama
+ * @param p_bar el objeto barra
+ */
+static void _bar_gpio_config (stm32f4_display_bar_hw_t *p_bar){
+	stm32f4_system_gpio_config(p_bar -> p_port, p_bar -> pin, STM32F4_GPIO_MODE_AF, STM32F4_GPIO_PUPDR_PULLDOWN);
+	stm32f4_system_gpio_config_alternate(p_bar -> p_port, p_bar -> pin, p_bar -> alternate);
+}
+
+/**
+ * @brief Da reloj al SPI y al DMA de la barra
+ * @param bar_id el ID de la barra
+ */
+static void _bar_clock_enable (uint32_t bar_id){
+	if (bar_id == PORT_REAR_PARKING_BAR_ID){
+		RCC -> APB2ENR |= RCC_APB2ENR_SPI1EN;
+		RCC -> AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+	}
+}
+
+/**
+ * @brief Configura el SPI como maestro solo de transmision, 8 bits, MSB primero y con la peticion de DMA de transmision
+ * @param bar_id el ID de la barra
+ */
+static void _bar_spi_config (uint32_t bar_id){
+	stm32f4_display_bar_hw_t *p_bar = _stm32f4_display_bar_get(bar_id);
+	SPI_TypeDef *p_spi = p_bar -> p_spi;
+
+	p_spi -> CR1 = 0;
+	//Sin pin NSS: se fija por software para que el SPI se mantenga como maestro
+	p_spi -> CR1 = SPI_CR1_BIDIMODE | SPI_CR1_BIDIOE | SPI_CR1_SSM | SPI_CR1_SSI | SPI_CR1_MSTR;
+	p_spi -> CR2 = SPI_CR2_TXDMAEN;
+	_bar_spi_set_rate(bar_id);
+}
+
+/**
+ * @brief Avisado por el sistema cuando cambia el reloj. Las barras suspendidas se recalculan al reanudarse
+ */
+static void _bar_retime (void){
+	for (uint32_t bar_id = 0; bar_id < sizeof(bars_arr) / sizeof(bars_arr[0]); bar_id++){
+		if (!bars_arr[bar_id].suspended){
+			_bar_spi_set_rate(bar_id);
+		}
+	}
+}
+/* Public functions -----------------------------------------------------------*/
+void port_display_bar_init (uint32_t bar_id){
+	stm32f4_display_bar_hw_t *p_bar = _stm32f4_display_bar_get(bar_id);
+	p_bar -> suspended = false;
+
+	_bar_gpio_config(p_bar);
+	_bar_clock_enable(bar_id);
+	p_bar -> p_dma_stream -> CR &= ~DMA_SxCR_EN;
+	while (p_bar -> p_dma_stream -> CR & DMA_SxCR_EN){
+	}
+	_bar_spi_config(bar_id);
+
+	for (uint32_t i = 0; i < PORT_DISPLAY_BAR_NUM_LEDS; i++){
+		p_bar -> frame[i] = COLOR_OFF;
+	}
+	port_display_bar_show(bar_id);
+	stm32f4_system_clock_listener_register(_bar_retime);
+}
+
+uint32_t port_display_bar_get_num_leds (uint32_t bar_id){
+	if (_stm32f4_display_bar_get(bar_id) == NULL) return 0;
+	return PORT_DISPLAY_BAR_NUM_LEDS;
+}
+
+rgb_color_t * port_display_bar_get_frame_buffer (uint32_t bar_id){
+	return _stm32f4_display_bar_get(bar_id) -> frame;
+}
+
+bool port_display_bar_show (uint32_t bar_id){
+	stm32f4_display_bar_hw_t *p_bar = _stm32f4_display_bar_get(bar_id);
+	//Sin reloj el SPI no enviaria nada
+	if (p_bar -> suspended) return false;
+	//No se puede reescribir el buffer que lee el DMA. Una trama de la barra dura menos de 1 ms
+	while (_bar_busy(p_bar)){
+	}
+
+	uint32_t num_bytes = port_ws2812_encode(p_bar -> frame, PORT_DISPLAY_BAR_NUM_LEDS, p_bar -> stream);
+
+	if (bar_id == PORT_REAR_PARKING_BAR_ID){
+		DMA_Stream_TypeDef *p_stream = p_bar -> p_dma_stream;
+		DMA2 -> LIFCR = BAR_DMA_STREAM3_FLAGS;
+		p_stream -> PAR = (uint32_t)&(p_bar -> p_spi -> DR);
+		p_stream -> M0AR = (uint32_t)p_bar -> stream;
+		p_stream -> NDTR = num_bytes;
+		//Memoria a periferico, de 8 en 8 bits, incrementando la memoria y una sola vez: al acabar el stream se deshabilita
+		p_stream -> CR = (p_bar -> dma_channel << DMA_SxCR_CHSEL_Pos)
+			| DMA_SxCR_DIR_0
+			| DMA_SxCR_MINC;
+		p_stream -> CR |= DMA_SxCR_EN;
+	}
+	return true;
+}
+
+void port_display_bar_suspend (uint32_t bar_id){
+	stm32f4_display_bar_hw_t *p_bar = _stm32f4_display_bar_get(bar_id);
+	if (p_bar -> suspended) return;
+
+	//Una trama cortada dejaria los LEDs con colores a medias
+	while (_bar_busy(p_bar)){
+	}
+	p_bar -> p_spi -> CR1 &= ~SPI_CR1_SPE;
+	if (bar_id == PORT_REAR_PARKING_BAR_ID){
+		RCC -> APB2ENR &= ~RCC_APB2ENR_SPI1EN;
+	}
+	//No se aparca en analogico: con la linea flotando la tira podria leer ruido como una trama
+	stm32f4_system_gpio_config(p_bar -> p_port, p_bar -> pin, STM32F4_GPIO_MODE_IN, STM32F4_GPIO_PUPDR_PULLDOWN);
+	p_bar -> suspended = true;
+}
+
+void port_display_bar_resume (uint32_t bar_id){
+	stm32f4_display_bar_hw_t *p_bar = _stm32f4_display_bar_get(bar_id);
+	if (!p_bar -> suspended) return;
+
+	_bar_gpio_config(p_bar);
+	_bar_clock_enable(bar_id);
+	//El reloj del sistema puede haber cambiado mientras estaba suspendida
+	_bar_spi_set_rate(bar_id);
+	p_bar -> suspended = false;
+}
@@ -6,6 +6,9 @@
  * @date 2025-03-18
  */
 
+/* Standard C includes */
+#include <unistd.h>
+
 /* HW dependent includes */
 #include "port_system.h"
 #include "stm32f4_system.h"
@@ -20,18 +23,59 @@ extern void initialise_monitor_handles(void);
 #define HSI_VALUE ((uint32_t)16000000) /*!< Value of the Internal oscillator in Hz */
 /* Timer configuration */
 #define RCC_HSI_CALIBRATION_DEFAULT 0x10U			 /*!< Default HSI calibration trimming value */
-#define TICK_FREQ_1KHZ 1U							 /*!< Frequency in kHz of the System tick */
 #define NVIC_PRIORITY_GROUP_0 ((uint32_t)0x00000007) /*!< 0 bit  for pre-emption priority, \
 														 4 bits for subpriority */
 #define NVIC_PRIORITY_GROUP_4 ((uint32_t)0x00000003) /*!< 4 bits for pre-emption priority, \
 														 0 bit  for subpriority */
 /* Power */
+#define POWER_REGULATOR_VOLTAGE_SCALE1 0x03 /*!< Scale 1 mode: the maximum value of fHCLK is 168 MHz, 180 MHz with over-drive. */
 #define POWER_REGULATOR_VOLTAGE_SCALE3 0x01 /*!< Scale 3 mode: the maximum value of fHCLK is 120 MHz. */
+/* Clock profiles */
+#define FLASH_MAX_HZ_PER_WS 30000000U /*!< Frecuencia maxima de HCLK por cada estado de espera de la flash con VDD entre 2.7 V y 3.6 V */
+#define PLL_BURST_M 8U				  /*!< Divisor de entrada del PLL: 16 MHz / 8 = 2 MHz en la entrada del VCO */
+#define PLL_BURST_N 180U			  /*!< Multiplicador del PLL: 2 MHz * 180 = 360 MHz en el VCO */
+#define PLL_BURST_P 2U				  /*!< Divisor de salida del PLL: 360 MHz / 2 = 180 MHz de reloj del sistema */
+#define CLOCK_MAX_LISTENERS 4U		  /*!< Numero maximo de drivers que se pueden registrar para recalcular sus timers al cambiar el reloj */
+/* Timebase (TIM11) */
+#define TIMEBASE_TICKS_PER_MS 4U										 /*!< Ticks del timer de la base de tiempos por milisegundo. Con 4 ticks/ms el prescaler cabe en 16 bits hasta 180 MHz */
+#define TIMEBASE_WRAP_TICKS 65536U										 /*!< Ticks hasta el desbordamiento del contador de 16 bits */
+#define TIMEBASE_WRAP_MS (TIMEBASE_WRAP_TICKS / TIMEBASE_TICKS_PER_MS)	 /*!< Milisegundos entre dos desbordamientos del contador */
+#define TIMEBASE_MAX_WAKEUP_TICKS ((TIMEBASE_WRAP_TICKS / 2U) - 1U)		 /*!< Maxima distancia a la que se programa un despertar, para poder detectar si ya ha pasado */
+/* RTC (LSE) para compensar el tiempo en modo Stop */
+#define RTC_PREDIV_A 1U													 /*!< Prescaler asincrono del RTC: 32768 Hz / (1 + 1) = 16384 Hz */
+#define RTC_PREDIV_S 16383U												 /*!< Prescaler sincrono del RTC: 16384 Hz / (16383 + 1) = 1 Hz. El subsegundo tiene una resolucion de 1/16384 s (61 us) */
+#define RTC_WPR_KEY1 0xCAU												 /*!< Primera clave para desproteger los registros del RTC */
+#define RTC_WPR_KEY2 0x53U												 /*!< Segunda clave para desproteger los registros del RTC */
+#define RTC_WPR_LOCK 0xFFU												 /*!< Cualquier otro valor vuelve a proteger los registros del RTC */
+#define RTC_TICKS_PER_DAY (86400U * (RTC_PREDIV_S + 1U))				 /*!< Ticks del subsegundo en un dia. El calendario del RTC vuelve a 00:00:00 tras las 23:59:59 */
+/* Registro binario (ITM) */
+#define LOG_ITM_PORT 1U													 /*!< Puerto de estimulo del ITM de los registros binarios. El 0 es el de `printf` */
+/* Pila y heap */
+#define MEMORY_PAINT 0xC5C5C5C5U										 /*!< Patron con el que se pinta la RAM libre al arrancar para medir lo que llegan a usar la pila y el heap */
+#define MEMORY_PAINT_GUARD_WORDS 16U									 /*!< Palabras bajo el SP que no se pintan, por si las usa la propia funcion que pinta */
+/* Perfilador (TIM7) */
+#define PROFILER_TICK_HZ 1000000U										 /*!< Frecuencia del contador de TIM7: el periodo de muestreo se programa en microsegundos */
+/* Semihosting */
+#define SEMIHOSTING_SYS_ERRNO 0x13U										 /*!< Llamada de semihosting sin efectos, para ver si hay alguien al otro lado */
+#define SEMIHOSTING_BKPT 0xBEABU										 /*!< Codificacion Thumb de `bkpt 0xAB`, la instruccion de las llamadas de semihosting */
 
 //------------------------------------------------------
 // PRIVATE (STATIC) VARIABLES
 //------------------------------------------------------
-static volatile uint32_t msTicks = 0; /*!< Variable to store millisecond ticks. @warning **It must be declared volatile!** Just because it is modified in an ISR. **Add it to the definition** after *static*. */
+static uint16_t gpio_pins_in_use[3] = {0}; /*!< Pines en uso de GPIOA, GPIOB y GPIOC. Cuando un puerto se queda sin pines en uso se apaga su reloj */
+static volatile uint32_t pending_events = 0; /*!< Eventos publicados por las ISR y aun no recogidos con `port_system_take_events()` */
+static volatile uint32_t ms_base = 0; /*!< Milisegundos correspondientes a CNT = 0 en la vuelta actual del contador de TIM11. @warning Se modifica en la ISR de desbordamiento, por eso es volatile. */
+static uint32_t wakeup_deadline_ms = 0; /*!< Ultimo despertar programado con `port_system_set_wakeup_ms()`, para volver a programarlo si cambia el reloj */
+static port_system_clock_profile_t clock_profile = PORT_SYSTEM_CLOCK_LOW_POWER; /*!< Perfil de reloj activo */
+static stm32f4_system_clock_listener_t clock_listeners[CLOCK_MAX_LISTENERS] = {0}; /*!< Drivers a avisar cuando cambia el reloj del sistema */
+static uint32_t num_clock_listeners = 0; /*!< Numero de drivers registrados en `clock_listeners` */
+static uint32_t micros_base = 0; /*!< Microsegundos correspondientes a `cycles_base` */
+static uint32_t cycles_base = 0; /*!< Valor del contador de ciclos (DWT) en `micros_base` */
+static uint32_t cycles_per_us = HSI_VALUE / 1000000U; /*!< Ciclos del nucleo por microsegundo con el reloj actual */
+static uint32_t profiler_hz = 0; /*!< Frecuencia de muestreo del perfilador, o 0 si esta parado */
+static uint32_t wake_us = 0; /*!< Microsegundos del ultimo despertar del modo Stop, desde el flanco del boton hasta restaurar el perfil de reloj */
+static uint32_t *p_heap_start = NULL; /*!< Principio del heap (simbolo `end` del enlazador) */
+static volatile bool semihosting_host = false; /*!< Si hay un depurador o un emulador que atienda el semihosting. Lo borra `stm32f4_system_semihosting_trap()` */
 
 //------------------------------------------------------
 // PUBLIC (GLOBAL) VARIABLES
@@ -47,13 +91,341 @@ const uint8_t APBPrescTable[8] = {0, 0, 0, 0, 1, 2, 3, 4};							/*!< Prescaler
 //------------------------------------------------------
 
 /**
- * @brief System Clock Configuration
+ * @brief Configura TIM11 como base de tiempos sin tick (tickless).
+ *
+ * El contador de 16 bits avanza libremente a `TIMEBASE_TICKS_PER_MS` ticks por milisegundo y solo interrumpe
+ * al desbordar (cada `TIMEBASE_WRAP_MS` ms) para acumular los milisegundos en `ms_base`. El canal 1 en modo
+ * comparacion se usa para programar el siguiente despertar con `port_system_set_wakeup_ms()`.
+ *
+ * @note TIM11 sigue contando en modo Sleep, por lo que `port_system_get_millis()` no se retrasa al dormir.
+ */
+static void _timebase_config(void)
+{
+	/* Habilitar reloj de TIM11 */
+	RCC->APB2ENR |= RCC_APB2ENR_TIM11EN;
+
+	/* Disable contador */
+	TIM11->CR1 &= ~TIM_CR1_CEN;
+
+	TIM11->PSC = (stm32f4_system_get_timer_clock(TIM11) / (1000U * TIMEBASE_TICKS_PER_MS)) - 1U;
+	TIM11->ARR = TIMEBASE_WRAP_TICKS - 1U;
+	TIM11->CNT = 0;
+	ms_base = 0;
+
+	/* Solo el desbordamiento activa UIF: asi un UG al cambiar de reloj no cuenta como una vuelta */
+	TIM11->CR1 |= TIM_CR1_URS;
+
+	/* Canal 1 como comparacion sin salida (frozen) para el despertar */
+	TIM11->CCMR1 &= ~(TIM_CCMR1_CC1S | TIM_CCMR1_OC1M);
+
+	/* Cargar el prescaler y limpiar el flag que genera UG */
+	TIM11->EGR = TIM_EGR_UG;
+	TIM11->SR &= ~(TIM_SR_UIF | TIM_SR_CC1IF);
+
+	/* Solo interrumpe al desbordar. El despertar se habilita bajo demanda */
+	TIM11->DIER &= ~TIM_DIER_CC1IE;
+	TIM11->DIER |= TIM_DIER_UIE;
+
+	/* Prioridad maxima, como tenia el SysTick */
+	NVIC_SetPriority(TIM1_TRG_COM_TIM11_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0U, 0U));
+	NVIC_EnableIRQ(TIM1_TRG_COM_TIM11_IRQn);
+
+	TIM11->CR1 |= TIM_CR1_CEN;
+}
+
+/**
+ * @brief Lee la base de tiempos: los milisegundos de CNT = 0 en la vuelta actual y el contador de TIM11
+ *
+ * @param p_base_ms Donde se devuelven los milisegundos de la vuelta
+ * @param p_cnt Donde se devuelve el contador
+ */
+static void _timebase_read(uint32_t *p_base_ms, uint32_t *p_cnt)
+{
+	uint32_t base;
+	uint32_t cnt;
+	bool wrap_pending;
+
+	/* Si la ISR actualiza ms_base mientras se lee el contador, se repite la lectura */
+	do
+	{
+		base = ms_base;
+		cnt = TIM11->CNT;
+		/* Desbordamiento aun no atendido (p. ej. leyendo desde otra ISR o con interrupciones deshabilitadas) */
+		wrap_pending = ((TIM11->SR & TIM_SR_UIF) != 0) && (cnt < (TIMEBASE_WRAP_TICKS / 2U));
+	} while (base != ms_base);
+
+	if (wrap_pending)
+	{
+		base += TIMEBASE_WRAP_MS;
+	}
+	*p_base_ms = base;
+	*p_cnt = cnt;
+}
+
+/**
+ * @brief Devuelve los microsegundos desde el arranque segun la base de tiempos (TIM11), con la resolucion de un tick
+ *
+ * @return microsegundos desde el arranque
+ */
+static uint32_t _timebase_micros(void)
+{
+	uint32_t base;
+	uint32_t cnt;
+	_timebase_read(&base, &cnt);
+	return (base * 1000U) + (cnt * (1000U / TIMEBASE_TICKS_PER_MS));
+}
+
+/**
+ * @brief Arranca el contador de ciclos del DWT, base de `port_system_get_micros()` y `port_system_get_cycles()`
+ */
+static void _cycle_counter_config(void)
+{
+	/* Ya cuenta desde SystemInit: no se pone a cero para no perder el tiempo de arranque */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	cycles_per_us = SystemCoreClock / 1000000U;
+	cycles_base = DWT->CYCCNT;
+	micros_base = _timebase_micros();
+}
+
+/**
+ * @brief Pasa a `micros_base` los microsegundos enteros contados por el DWT desde `cycles_base`.
+ *
+ * Se llama antes de que el contador de 32 bits de la vuelta (unos 24 s a 180 MHz) y antes de cambiar `cycles_per_us`.
+ * Los ciclos que no llegan a un microsegundo se quedan para el siguiente, asi que no se acumula error.
+ *
+ * @note Se llama con las interrupciones deshabilitadas o desde la ISR de la base de tiempos.
+ */
+static void _micros_fold(void)
+{
+	uint32_t elapsed_us = (DWT->CYCCNT - cycles_base) / cycles_per_us;
+	micros_base += elapsed_us;
+	cycles_base += elapsed_us * cycles_per_us;
+}
+
+/**
+ * @brief Reajusta los microsegundos con la base de tiempos tras un periodo en el que el DWT no ha contado.
+ *
+ * El contador de ciclos se para con el nucleo en Sleep y en Stop, y no sigue el cambio de reloj. Si la base de tiempos
+ * va por delante, los microsegundos siguen desde ella; si no, se conservan, asi que nunca van hacia atras.
+ *
+ * @note Se llama con las interrupciones deshabilitadas.
+ */
+static void _micros_resync(void)
+{
+	_micros_fold();
+	uint32_t timebase_us = _timebase_micros();
+	if ((int32_t)(timebase_us - micros_base) > 0)
+	{
+		micros_base = timebase_us;
+		cycles_base = DWT->CYCCNT;
+	}
+}
+
+/**
+ * @brief Recalcula el prescaler de la base de tiempos tras un cambio de reloj sin perder la cuenta de milisegundos.
+ *
+ * El UG carga el nuevo prescaler al instante y pone el contador a cero, por lo que se rehace `ms_base` a partir
+ * del tiempo leido antes del cambio y se conserva la fraccion de milisegundo que llevaba el contador.
+ *
+ * @param now_ms Milisegundos desde el arranque leidos justo antes de cambiar el reloj.
+ * @param sub_ticks Ticks del contador dentro del milisegundo en curso, leidos a la vez que `now_ms`.
+ */
+static void _timebase_retime(uint32_t now_ms, uint32_t sub_ticks)
+{
+	TIM11->PSC = (stm32f4_system_get_timer_clock(TIM11) / (1000U * TIMEBASE_TICKS_PER_MS)) - 1U;
+	TIM11->EGR = TIM_EGR_UG;
+	TIM11->CNT = sub_ticks;
+	TIM11->SR &= ~TIM_SR_CC1IF;
+	ms_base = now_ms;
+
+	/* El despertar estaba programado en ticks del contador anterior */
+	if (TIM11->DIER & TIM_DIER_CC1IE)
+	{
+		port_system_set_wakeup_ms(wakeup_deadline_ms);
+	}
+}
+
+/**
+ * @brief Devuelve el tope de la pila principal: el SP inicial, primera entrada de la tabla de vectores
+ *
+ * @return direccion del tope de la pila
+ */
+static uint32_t *_stack_top(void)
+{
+	return (uint32_t *)(*(uint32_t *)SCB->VTOR);
+}
+
+/**
+ * @brief Pinta con `MEMORY_PAINT` la RAM libre entre el final del heap y el SP actual.
+ *
+ * Lo que la pila o `malloc()` escriban despues borra el patron, asi `port_system_get_memory()` puede saber hasta
+ * donde han llegado.
+ */
+static void _memory_paint(void)
+{
+	extern char end __asm__("end");
+	p_heap_start = (uint32_t *)(((uintptr_t)&end + 3U) & ~(uintptr_t)3U);
+
+	uint32_t *p_low = (uint32_t *)(((uintptr_t)sbrk(0) + 3U) & ~(uintptr_t)3U);
+	uint32_t *p_high = (uint32_t *)__get_MSP() - MEMORY_PAINT_GUARD_WORDS;
+	for (uint32_t *p = p_low; p < p_high; p++)
+	{
+		*p = MEMORY_PAINT;
+	}
+}
+
+/**
+ * @brief Programa el periodo de muestreo del perfilador (TIM7) con el reloj actual del timer
+ */
+static void _profiler_set_period(void)
+{
+	TIM7->PSC = (stm32f4_system_get_timer_clock(TIM7) / PROFILER_TICK_HZ) - 1U;
+	TIM7->ARR = (PROFILER_TICK_HZ / profiler_hz) - 1U;
+	TIM7->EGR = TIM_EGR_UG;
+	TIM7->SR &= ~TIM_SR_UIF;
+}
+
+/**
+ * @brief Arranca el oscilador LSE para el RTC, sin esperar a que este listo.
+ *
+ * El LSE tarda del orden de segundos en arrancar, por lo que no se bloquea el arranque: el RTC se
+ * configura en `_rtc_start()` la primera vez que se entra en modo Stop con el LSE ya estable.
+ */
+static void _rtc_config(void)
+{
+	/* El dominio de backup (RCC_BDCR y RTC) esta protegido contra escritura tras el reset */
+	PWR->CR |= PWR_CR_DBP;
+	RCC->BDCR |= RCC_BDCR_LSEON;
+}
+
+/**
+ * @brief Configura el RTC con el LSE si aun no esta en marcha.
+ *
+ * @retval true si el RTC cuenta y se puede usar para medir el tiempo en modo Stop.
+ * @retval false si el LSE no esta listo (todavia arrancando o sin cristal). En ese caso no se compensa el tiempo.
+ */
+static bool _rtc_start(void)
+{
+	if (RCC->BDCR & RCC_BDCR_RTCEN)
+	{
+		return true;
+	}
+	if (!(RCC->BDCR & RCC_BDCR_LSERDY))
+	{
+		return false;
+	}
+
+	/* RTCSEL = 01: LSE como reloj del RTC */
+	RCC->BDCR &= ~RCC_BDCR_RTCSEL;
+	RCC->BDCR |= RCC_BDCR_RTCSEL_0;
+	RCC->BDCR |= RCC_BDCR_RTCEN;
+
+	RTC->WPR = RTC_WPR_KEY1;
+	RTC->WPR = RTC_WPR_KEY2;
+
+	RTC->ISR |= RTC_ISR_INIT;
+	while (!(RTC->ISR & RTC_ISR_INITF))
+	{
+	}
+
+	/* Los dos prescalers se escriben en dos accesos separados, primero el sincrono */
+	RTC->PRER = RTC_PREDIV_S;
+	RTC->PRER |= (RTC_PREDIV_A << RTC_PRER_PREDIV_A_Pos);
+	RTC->TR = 0;
+
+	RTC->ISR &= ~RTC_ISR_INIT;
+
+	/* Marca de tiempo en el flanco de bajada de PC13 (RTC_AF1, el boton), para medir el despertar de Stop.
+	 * El flanco se elige antes de activarla */
+	RTC->CR |= RTC_CR_TSEDGE;
+	RTC->CR |= RTC_CR_TSE;
+	RTC->WPR = RTC_WPR_LOCK;
+
+	return true;
+}
+
+/**
+ * @brief Pasa una hora del RTC a ticks del subsegundo desde las 00:00:00.
+ *
+ * @param tr Hora en BCD, de `RTC_TR` o de la marca de tiempo `RTC_TSTR` (mismos campos).
+ * @param ssr Subsegundo, de `RTC_SSR` o de `RTC_TSSSR`.
+ */
+static uint32_t _rtc_ticks_of_day(uint32_t tr, uint32_t ssr)
+{
+	uint32_t hours = ((tr & RTC_TR_HT) >> RTC_TR_HT_Pos) * 10U + ((tr & RTC_TR_HU) >> RTC_TR_HU_Pos);
+	uint32_t minutes = ((tr & RTC_TR_MNT) >> RTC_TR_MNT_Pos) * 10U + ((tr & RTC_TR_MNU) >> RTC_TR_MNU_Pos);
+	uint32_t seconds = ((tr & RTC_TR_ST) >> RTC_TR_ST_Pos) * 10U + ((tr & RTC_TR_SU) >> RTC_TR_SU_Pos);
+
+	/* El subsegundo cuenta hacia abajo desde PREDIV_S */
+	return (hours * 3600U + minutes * 60U + seconds) * (RTC_PREDIV_S + 1U) + (RTC_PREDIV_S - ssr);
+}
+
+/**
+ * @brief Devuelve la hora del RTC en ticks del subsegundo desde las 00:00:00.
+ *
+ * Tras salir de Stop los registros sombra no estan sincronizados, por lo que se espera a `RTC_ISR_RSF`
+ * (como mucho dos ciclos de RTCCLK, unos 61 us) antes de leerlos.
+ */
+static uint32_t _rtc_get_ticks_of_day(void)
+{
+	RTC->WPR = RTC_WPR_KEY1;
+	RTC->WPR = RTC_WPR_KEY2;
+	RTC->ISR &= ~RTC_ISR_RSF;
+	RTC->WPR = RTC_WPR_LOCK;
+	while (!(RTC->ISR & RTC_ISR_RSF))
+	{
+	}
+
+	/* Leer SSR bloquea TR y DR hasta que se lee DR, asi los tres valores son coherentes */
+	uint32_t ssr = RTC->SSR & RTC_SSR_SS;
+	uint32_t tr = RTC->TR;
+	(void)RTC->DR;
+
+	return _rtc_ticks_of_day(tr, ssr);
+}
+
+/**
+ * @brief Programa en la flash el minimo numero de estados de espera valido para una frecuencia de HCLK.
+ *
+ * @param hclk_hz Frecuencia de HCLK en Hz.
+ *
+ * @note Solo modifica el campo LATENCY: las caches y el prefetch configurados en `port_system_init()` se conservan.
+ */
+static void _flash_latency_config(uint32_t hclk_hz)
+{
+	uint32_t latency = (hclk_hz - 1U) / FLASH_MAX_HZ_PER_WS;
+	MODIFY_REG(FLASH->ACR, FLASH_ACR_LATENCY, latency << FLASH_ACR_LATENCY_Pos);
+	/* La nueva latencia tiene que estar activa antes de cambiar la frecuencia */
+	while ((FLASH->ACR & FLASH_ACR_LATENCY) != (latency << FLASH_ACR_LATENCY_Pos))
+	{
+	}
+}
+
+/**
+ * @brief System Clock Configuration. Perfil de bajo consumo: HSI a 16 MHz, escala de tension 3 y 0 estados de espera.
  *
  * @attention This function should NOT be accesible from the outside to avoid configuration problems.
- * @note This function starts a system timer that generates a SysTick every 1 ms.
+ * @note Se llama tambien al salir de modo Stop, donde el hardware vuelve a seleccionar el HSI como reloj del sistema,
+ * y al volver del perfil PLL. Por eso no toca la base de tiempos (TIM11), que se reajusta en `port_system_set_clock_profile()`.
  */
 static void system_clock_config(void)
 {
+	/* Change in clock source is performed in 16 clock cycles after writing to CFGR */
+	RCC->CFGR &= ~RCC_CFGR_SW; // Clean and set value
+	RCC->CFGR |= (RCC_CFGR_SW & (RCC_CFGR_SW_HSI << RCC_CFGR_SW_Pos));
+	while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_HSI)
+	{
+	}
+
+	/* Con el HSI como reloj ya se pueden apagar el over-drive y el PLL del perfil rapido */
+	PWR->CR &= ~(PWR_CR_ODSWEN | PWR_CR_ODEN);
+	RCC->CR &= ~RCC_CR_PLLON;
+	while (RCC->CR & RCC_CR_PLLRDY)
+	{
+	}
+
 	/** Configure the main internal regulator output voltage */
 	/* Power controller (PWR) */
 	/* Control the main internal voltage regulator output voltage to achieve a trade-off between performance and power consumption when the device does not operate at the maximum frequency */
@@ -67,23 +439,90 @@ static void system_clock_config(void)
 
 	/* RCC Clock Config */
 	/* Initializes the CPU, AHB and APB buses clocks */
+	RCC->CFGR &= ~(RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2);
+
+	/* Update the SystemCoreClock global variable */
+	SystemCoreClock = HSI_VALUE >> AHBPrescTable[(RCC->CFGR & RCC_CFGR_HPRE) >> RCC_CFGR_HPRE_Pos];
+
 	/* To correctly read data from FLASH memory, the number of wait states (LATENCY)
 		must be correctly programmed according to the frequency of the CPU clock
-		(HCLK) and the supply voltage of the device. */
+		(HCLK) and the supply voltage of the device. Al bajar la frecuencia se reduce despues del cambio. */
+	_flash_latency_config(SystemCoreClock);
+}
 
-	/* Increasing the number of wait states because of higher CPU frequency */
-	FLASH->ACR = FLASH_ACR_LATENCY_2WS; /* Program the new number of wait states to the LATENCY bits in the FLASH_ACR register */
+/**
+ * @brief Perfil rapido: PLL a 180 MHz desde el HSI, escala de tension 1 con over-drive y 5 estados de espera.
+ *
+ * APB1 (max. 45 MHz) va a HCLK/4 y APB2 (max. 90 MHz) a HCLK/2, por lo que los timers de APB1 cuentan a 90 MHz
+ * y los de APB2 a 180 MHz (ver `stm32f4_system_get_timer_clock()`).
+ *
+ * @note Parte siempre del perfil de bajo consumo: la escala de tension solo se puede cambiar con el PLL apagado.
+ */
+static void _clock_pll_burst_config(void)
+{
+	system_clock_config();
 
-	/* Change in clock source is performed in 16 clock cycles after writing to CFGR */
-	RCC->CFGR &= ~RCC_CFGR_SW; // Clean and set value
-	RCC->CFGR |= (RCC_CFGR_SW & (RCC_CFGR_SW_HSI << RCC_CFGR_SW_Pos));
+	PWR->CR &= ~PWR_CR_VOS;
+	PWR->CR |= (PWR_CR_VOS & (POWER_REGULATOR_VOLTAGE_SCALE1 << PWR_CR_VOS_Pos));
 
-	/* Update the SystemCoreClock global variable */
-	SystemCoreClock = HSI_VALUE >> AHBPrescTable[(RCC->CFGR & RCC_CFGR_HPRE) >> RCC_CFGR_HPRE_Pos];
+	/* PLLP = 00 divide entre 2. PLLQ y PLLR no se usan y se dejan como estan */
+	MODIFY_REG(RCC->PLLCFGR, (RCC_PLLCFGR_PLLSRC | RCC_PLLCFGR_PLLM | RCC_PLLCFGR_PLLN | RCC_PLLCFGR_PLLP),
+			   (RCC_PLLCFGR_PLLSRC_HSI | (PLL_BURST_M << RCC_PLLCFGR_PLLM_Pos) | (PLL_BURST_N << RCC_PLLCFGR_PLLN_Pos) | (((PLL_BURST_P / 2U) - 1U) << RCC_PLLCFGR_PLLP_Pos)));
+	RCC->CR |= RCC_CR_PLLON;
+	while (!(RCC->CR & RCC_CR_PLLRDY))
+	{
+	}
+	while (!(PWR->CSR & PWR_CSR_VOSRDY))
+	{
+	}
 
-	/* Configure the source of time base considering new system clocks settings */
-	SysTick_Config(SystemCoreClock / (1000U / TICK_FREQ_1KHZ)); /* Set Systick to 1 ms */
+	/* Por encima de 168 MHz hace falta el over-drive, que se activa con el PLL ya enganchado */
+	PWR->CR |= PWR_CR_ODEN;
+	while (!(PWR->CSR & PWR_CSR_ODRDY))
+	{
+	}
+	PWR->CR |= PWR_CR_ODSWEN;
+	while (!(PWR->CSR & PWR_CSR_ODSWRDY))
+	{
+	}
+
+	/* Al subir la frecuencia los estados de espera y los prescalers de los buses van antes del cambio */
+	uint32_t hclk_hz = ((HSI_VALUE / PLL_BURST_M) * PLL_BURST_N) / PLL_BURST_P;
+	_flash_latency_config(hclk_hz);
+	MODIFY_REG(RCC->CFGR, (RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2), (RCC_CFGR_PPRE1_DIV4 | RCC_CFGR_PPRE2_DIV2));
+
+	RCC->CFGR &= ~RCC_CFGR_SW;
+	RCC->CFGR |= (RCC_CFGR_SW & (RCC_CFGR_SW_PLL << RCC_CFGR_SW_Pos));
+	while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_PLL)
+	{
+	}
+
+	SystemCoreClock = hclk_hz;
+}
+
+#ifdef USE_SEMIHOSTING
+/**
+ * @brief Comprueba si hay alguien que atienda el semihosting antes de la primera llamada, que sin depurador se bloquea
+ *
+ * Con un depurador conectado el nucleo tiene la depuracion por parada habilitada. Si no, puede ser un emulador que atiende
+ * el `bkpt 0xAB` sin depurador: se hace una llamada sin efectos y, si acaba en HardFault, `stm32f4_system_semihosting_trap()`
+ * la salta y borra `semihosting_host`.
+ *
+ * @return true si hay semihosting
+ */
+static bool _semihosting_detect(void)
+{
+	semihosting_host = true;
+	if (CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk)
+	{
+		return true;
+	}
+	register uint32_t r0 __asm__("r0") = SEMIHOSTING_SYS_ERRNO;
+	register uint32_t r1 __asm__("r1") = 0;
+	__asm volatile("bkpt 0xAB" : "+r"(r0) : "r"(r1) : "memory");
+	return semihosting_host;
 }
+#endif
 
 //------------------------------------------------------
 // PUBLIC (GLOBAL) FUNCTIONS
@@ -116,13 +555,24 @@ void SystemInit(void)
 #if defined(USER_VECT_TAB_ADDRESS)
 	SCB->VTOR = VECT_TAB_BASE_ADDRESS | VECT_TAB_OFFSET; /* Vector Table Relocation in Internal SRAM */
 #endif													 /* USER_VECT_TAB_ADDRESS */
+
+	/* Contador de ciclos desde aqui, para medir el arranque. Todavia no se puede escribir en la RAM */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 }
 
 uint32_t port_system_init()
 {
+	/* Antes que nada: todo lo que use la pila o el heap desde aqui queda medido */
+	_memory_paint();
 
 #ifdef USE_SEMIHOSTING
-	initialise_monitor_handles();
+	/* Sin depurador initialise_monitor_handles() se quedaria bloqueada: se arranca sin salida */
+	if (_semihosting_detect())
+	{
+		initialise_monitor_handles();
+	}
 #endif
 
 	/* Reset of all peripherals, Initializes the Flash interface and the Systick. */
@@ -139,10 +589,6 @@ uint32_t port_system_init()
 	/* Set Interrupt Group Priority */
 	NVIC_SetPriorityGrouping(NVIC_PRIORITY_GROUP_4);
 
-	/* Use systick as time base source and configure 1ms tick (default clock after Reset is HSI) */
-	/* Configure the SysTick IRQ priority. It must be the highest (lower number: 0)*/
-	NVIC_SetPriority(SysTick_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0U, 0U)); /* Tick interrupt priority */
-
 	/* Init the low level hardware */
 	/* Reset and clock control (RCC) */
 	RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN; /* Syscfg clock enabling */
@@ -153,6 +599,23 @@ uint32_t port_system_init()
 	/* Configure the system clock */
 	system_clock_config();
 
+	/* Configure the source of time base considering new system clocks settings */
+	_timebase_config();
+
+	/* Cycle counter for the microsecond time */
+	_cycle_counter_config();
+
+	/* RTC (LSE) to keep track of time while in Stop mode */
+	_rtc_config();
+
+#ifdef USE_SEMIHOSTING
+	/* Keep the debug connection alive in Stop mode, otherwise semihosting hangs. Sin depurador solo gastaria en Stop */
+	if (semihosting_host)
+	{
+		DBGMCU->CR |= DBGMCU_CR_DBG_STOP;
+	}
+#endif
+
 	return 0;
 }
 
@@ -181,22 +644,203 @@ void port_system_delay_until_ms(uint32_t *p_t, uint32_t ms)
 
 uint32_t port_system_get_millis()
 {
-	return msTicks;
+	uint32_t base;
+	uint32_t cnt;
+	_timebase_read(&base, &cnt);
+	return base + (cnt / TIMEBASE_TICKS_PER_MS);
+}
+
+uint32_t port_system_get_micros(void)
+{
+	/* La lectura de las dos bases y del contador no se puede partir con un ajuste desde una ISR */
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint32_t us = micros_base + ((DWT->CYCCNT - cycles_base) / cycles_per_us);
+	__set_PRIMASK(primask);
+	return us;
+}
+
+uint32_t port_system_get_cycles(void)
+{
+	return DWT->CYCCNT;
+}
+
+uint32_t port_system_get_cycles_per_us(void)
+{
+	return cycles_per_us;
 }
 
 void port_system_set_millis(uint32_t ms)
 {
-	msTicks = ms;
+	ms_base = ms - (TIM11->CNT / TIMEBASE_TICKS_PER_MS);
 }
 
-void port_system_systick_suspend()
+void port_system_set_wakeup_ms(uint32_t deadline_ms)
 {
-	SysTick->CTRL &= ~SysTick_CTRL_TICKINT_Msk;
+	int32_t delta_ms = (int32_t)(deadline_ms - port_system_get_millis());
+	uint32_t delta_ticks;
+
+	if (delta_ms <= 0)
+	{
+		delta_ticks = 1;
+	}
+	else if ((uint32_t)delta_ms * TIMEBASE_TICKS_PER_MS > TIMEBASE_MAX_WAKEUP_TICKS)
+	{
+		delta_ticks = TIMEBASE_MAX_WAKEUP_TICKS; /* Se despierta antes y se vuelve a programar */
+	}
+	else
+	{
+		delta_ticks = (uint32_t)delta_ms * TIMEBASE_TICKS_PER_MS;
+	}
+
+	wakeup_deadline_ms = deadline_ms;
+	uint32_t ccr = (TIM11->CNT + delta_ticks) % TIMEBASE_WRAP_TICKS;
+	TIM11->CCR1 = ccr;
+	TIM11->SR &= ~TIM_SR_CC1IF;
+	TIM11->DIER |= TIM_DIER_CC1IE;
+
+	/* Si el contador ya ha alcanzado el instante programado, la comparacion no saltaria hasta la siguiente vuelta */
+	if (((TIM11->CNT - ccr) % TIMEBASE_WRAP_TICKS) < (TIMEBASE_WRAP_TICKS / 2U))
+	{
+		NVIC_SetPendingIRQ(TIM1_TRG_COM_TIM11_IRQn);
+	}
+}
+
+void port_system_post_events(uint32_t events)
+{
+	/* Las ISR se pueden anidar: la lectura-modificacion-escritura tiene que ser atomica */
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	pending_events |= events;
+	__set_PRIMASK(primask);
 }
 
-void port_system_systick_resume()
+uint32_t port_system_take_events(void)
 {
-	SysTick->CTRL |= SysTick_CTRL_TICKINT_Msk;
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint32_t events = pending_events;
+	pending_events = 0;
+	__set_PRIMASK(primask);
+	return events;
+}
+
+void port_system_log_write(const uint32_t *p_words, uint32_t num_words)
+{
+	/* Sin un depurador que capture el SWO el ITM esta deshabilitado y los registros se descartan */
+	if ((ITM->TCR & ITM_TCR_ITMENA_Msk) == 0 || (ITM->TER & (1UL << LOG_ITM_PORT)) == 0)
+	{
+		return;
+	}
+	for (uint32_t i = 0; i < num_words; i++)
+	{
+		while (ITM->PORT[LOG_ITM_PORT].u32 == 0)
+		{
+		}
+		ITM->PORT[LOG_ITM_PORT].u32 = p_words[i];
+	}
+}
+
+void port_system_set_clock_profile(port_system_clock_profile_t profile)
+{
+	if (profile == clock_profile)
+	{
+		return;
+	}
+
+	/* Ninguna ISR puede ver los timers a medio recalcular */
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	/* Se lee el tiempo antes del cambio: durante el cambio TIM11 cuenta con el prescaler antiguo */
+	uint32_t now_ms = port_system_get_millis();
+	uint32_t sub_ticks = TIM11->CNT % TIMEBASE_TICKS_PER_MS;
+	_micros_fold();
+
+	if (profile == PORT_SYSTEM_CLOCK_BURST)
+	{
+		_clock_pll_burst_config();
+	}
+	else
+	{
+		system_clock_config();
+	}
+	clock_profile = profile;
+
+	_timebase_retime(now_ms, sub_ticks);
+	cycles_per_us = SystemCoreClock / 1000000U;
+	cycles_base = DWT->CYCCNT;
+	_micros_resync();
+	if (profiler_hz != 0)
+	{
+		_profiler_set_period();
+	}
+	for (uint32_t i = 0; i < num_clock_listeners; i++)
+	{
+		clock_listeners[i]();
+	}
+
+	__set_PRIMASK(primask);
+}
+
+port_system_clock_profile_t port_system_get_clock_profile(void)
+{
+	return clock_profile;
+}
+
+void port_system_get_memory(port_system_memory_t *p_memory)
+{
+	uint32_t *p_top = _stack_top();
+	uint32_t *p_heap_end = (uint32_t *)(((uintptr_t)sbrk(0) + 3U) & ~(uintptr_t)3U);
+
+	/* La pila crece hacia abajo: la primera palabra sin el patron por encima del heap es lo mas hondo que ha llegado */
+	uint32_t *p_deepest = p_heap_end;
+	while (p_deepest < p_top && *p_deepest == MEMORY_PAINT)
+	{
+		p_deepest++;
+	}
+
+	p_memory->stack_top = (uint32_t)(uintptr_t)p_top;
+	p_memory->stack_peak = (uint32_t)((uintptr_t)p_top - (uintptr_t)p_deepest);
+	p_memory->heap_peak = (p_heap_start != NULL) ? (uint32_t)((uintptr_t)p_heap_end - (uintptr_t)p_heap_start) : 0;
+	p_memory->margin = (uint32_t)((uintptr_t)p_deepest - (uintptr_t)p_heap_end);
+}
+
+uint32_t port_system_profiler_start(uint32_t hz)
+{
+	RCC->APB1ENR |= RCC_APB1ENR_TIM7EN;
+	TIM7->CR1 = 0;
+	profiler_hz = (hz == 0) ? 1U : hz;
+	_profiler_set_period();
+	TIM7->DIER |= TIM_DIER_UIE;
+
+	/* Maxima prioridad, como la base de tiempos: solo las muestras durante su rutina se pierden */
+	NVIC_SetPriority(TIM7_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0U, 1U));
+	NVIC_EnableIRQ(TIM7_IRQn);
+	TIM7->CR1 |= TIM_CR1_CEN;
+	return FLASH_BASE;
+}
+
+void port_system_profiler_stop(void)
+{
+	TIM7->CR1 &= ~TIM_CR1_CEN;
+	NVIC_DisableIRQ(TIM7_IRQn);
+	RCC->APB1ENR &= ~RCC_APB1ENR_TIM7EN;
+	profiler_hz = 0;
+}
+
+void stm32f4_system_timebase_wrap(void)
+{
+	ms_base += TIMEBASE_WRAP_MS;
+	/* Cada vuelta de TIM11 (16 s) es mas corta que una del contador de ciclos a 180 MHz (24 s) */
+	_micros_fold();
+}
+
+void stm32f4_system_timebase_wakeup(void)
+{
+	/* El despertar es de un solo disparo */
+	TIM11->DIER &= ~TIM_DIER_CC1IE;
+	port_system_post_events(PORT_SYSTEM_EVENT_WAKEUP);
 }
 
 // ------------------------------------------------------
@@ -204,6 +848,75 @@ void port_system_systick_resume()
 // i.e., the following functions do depend on the platform and are declared in the
 // stm32f4_system.h file.
 // ------------------------------------------------------
+//------------------------------------------------------
+// CLOCK RELATED FUNCTIONS
+//------------------------------------------------------
+uint32_t stm32f4_system_get_timer_clock(TIM_TypeDef *p_tim)
+{
+	uint32_t ppre;
+	if ((p_tim == TIM1) || (p_tim == TIM8) || (p_tim == TIM9) || (p_tim == TIM10) || (p_tim == TIM11))
+	{
+		ppre = (RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos;
+	}
+	else
+	{
+		ppre = (RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos;
+	}
+
+	/* Con el prescaler del bus distinto de 1 los timers cuentan al doble que el bus (TIMPRE = 0) */
+	uint32_t shift = APBPrescTable[ppre];
+	if (shift == 0)
+	{
+		return SystemCoreClock;
+	}
+	return (SystemCoreClock >> shift) << 1;
+}
+
+bool stm32f4_system_semihosting_trap(uint32_t *p_frame)
+{
+	const uint16_t *p_instruction = (const uint16_t *)p_frame[6];
+	if (!(SCB->HFSR & SCB_HFSR_DEBUGEVT_Msk) || *p_instruction != SEMIHOSTING_BKPT)
+	{
+		return false;
+	}
+	SCB->HFSR = SCB_HFSR_DEBUGEVT_Msk; /* Se borra escribiendo un 1 */
+	p_frame[0] = (uint32_t)-1;		   /* r0: la llamada ha fallado */
+	p_frame[6] += 2U;				   /* pc: la instruccion siguiente */
+	semihosting_host = false;
+	return true;
+}
+
+uint32_t stm32f4_system_get_spi_clock(SPI_TypeDef *p_spi)
+{
+	uint32_t ppre;
+	if ((p_spi == SPI1) || (p_spi == SPI4))
+	{
+		ppre = (RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos;
+	}
+	else
+	{
+		ppre = (RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos;
+	}
+	return SystemCoreClock >> APBPrescTable[ppre];
+}
+
+bool stm32f4_system_clock_listener_register(stm32f4_system_clock_listener_t listener)
+{
+	for (uint32_t i = 0; i < num_clock_listeners; i++)
+	{
+		if (clock_listeners[i] == listener)
+		{
+			return true;
+		}
+	}
+	if (num_clock_listeners >= CLOCK_MAX_LISTENERS)
+	{
+		return false;
+	}
+	clock_listeners[num_clock_listeners++] = listener;
+	return true;
+}
+
 //------------------------------------------------------
 // GPIO RELATED FUNCTIONS
 //------------------------------------------------------
@@ -212,14 +925,17 @@ void stm32f4_system_gpio_config(GPIO_TypeDef *p_port, uint8_t pin, uint8_t mode,
 	if (p_port == GPIOA)
 	{
 		RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN; /* GPIOA_CLK_ENABLE */
+		gpio_pins_in_use[0] |= BIT_POS_TO_MASK(pin);
 	}
 	else if (p_port == GPIOB)
 	{
 		RCC->AHB1ENR |= RCC_AHB1ENR_GPIOBEN; /* GPIOB_CLK_ENABLE */
+		gpio_pins_in_use[1] |= BIT_POS_TO_MASK(pin);
 	}
 	else if (p_port == GPIOC)
 	{
 		RCC->AHB1ENR |= RCC_AHB1ENR_GPIOCEN; /* GPIOC_CLK_ENABLE */
+		gpio_pins_in_use[2] |= BIT_POS_TO_MASK(pin);
 	}
 
 	/* Clean ( &=~ ) by displacing the base register and set the configuration ( |= ) */
@@ -342,6 +1058,38 @@ void stm32f4_system_gpio_toggle(GPIO_TypeDef *p_port, uint8_t pin)
 	stm32f4_system_gpio_write(p_port, pin, !value);
 }
 
+void stm32f4_system_gpio_park(GPIO_TypeDef *p_port, uint8_t pin)
+{
+	/* Analogico: se desconecta el disparador Schmitt de entrada y no hay consumo por pines flotantes */
+	p_port->MODER |= (STM32F4_GPIO_MODE_AN << (pin * 2U));
+	p_port->PUPDR &= ~(GPIO_PUPDR_PUPD0 << (pin * 2U));
+
+	if (p_port == GPIOA)
+	{
+		gpio_pins_in_use[0] &= ~BIT_POS_TO_MASK(pin);
+		if (gpio_pins_in_use[0] == 0)
+		{
+			RCC->AHB1ENR &= ~RCC_AHB1ENR_GPIOAEN;
+		}
+	}
+	else if (p_port == GPIOB)
+	{
+		gpio_pins_in_use[1] &= ~BIT_POS_TO_MASK(pin);
+		if (gpio_pins_in_use[1] == 0)
+		{
+			RCC->AHB1ENR &= ~RCC_AHB1ENR_GPIOBEN;
+		}
+	}
+	else if (p_port == GPIOC)
+	{
+		gpio_pins_in_use[2] &= ~BIT_POS_TO_MASK(pin);
+		if (gpio_pins_in_use[2] == 0)
+		{
+			RCC->AHB1ENR &= ~RCC_AHB1ENR_GPIOCEN;
+		}
+	}
+}
+
 // ------------------------------------------------------
 // POWER RELATED FUNCTIONS
 // ------------------------------------------------------
@@ -361,8 +1109,76 @@ void port_system_power_sleep()
 	__WFI();													   // Select Sleep mode entry : Request Wait For Interrupt
 }
 
-
 void port_system_sleep(){
-	port_system_systick_suspend();
-	port_system_power_sleep();
+	/* Con PRIMASK activo el WFI despierta igualmente con una interrupcion pendiente */
+	__disable_irq();
+	if (pending_events == 0)
+	{
+		port_system_power_sleep();
+		_micros_resync();
+	}
+	__enable_irq();
+}
+
+void port_system_deep_sleep(){
+	uint32_t rtc_before_ticks = 0;
+	bool rtc_ready = _rtc_start();
+
+	/* Con PRIMASK activo el WFI sigue despertando con la EXTI del boton, pero su ISR no se ejecuta
+	 * hasta haber restaurado el reloj y el tiempo, y asi ve un port_system_get_millis() correcto */
+	__disable_irq();
+
+	if (pending_events != 0)
+	{
+		__enable_irq();
+		return;
+	}
+
+	/* El over-drive no se puede mantener en Stop: se baja al perfil de bajo consumo y se recupera al despertar */
+	port_system_clock_profile_t profile = clock_profile;
+	port_system_set_clock_profile(PORT_SYSTEM_CLOCK_LOW_POWER);
+
+	if (rtc_ready)
+	{
+		rtc_before_ticks = _rtc_get_ticks_of_day();
+		/* Solo vale la marca de tiempo del flanco que despierta: se descartan las de pulsaciones anteriores */
+		RTC->ISR &= ~RTC_ISR_TSF;
+		RTC->ISR &= ~RTC_ISR_TSOVF;
+	}
+
+	/* Flash apagada en Stop: algo mas de latencia al despertar a cambio de menos consumo */
+	PWR->CR |= PWR_CR_FPDS;
+	port_system_power_stop();
+
+	/* Al salir de Stop el reloj del sistema es el HSI. Los prescalers de los timers se conservan, y como
+	 * se restaura la misma frecuencia del perfil de bajo consumo no hace falta recalcularlos */
+	system_clock_config();
+
+	/* TIM11 ha estado parado: se suma lo que ha contado el RTC */
+	if (rtc_ready)
+	{
+		uint32_t elapsed_ticks = (_rtc_get_ticks_of_day() + RTC_TICKS_PER_DAY - rtc_before_ticks) % RTC_TICKS_PER_DAY;
+		ms_base += (uint32_t)(((uint64_t)elapsed_ticks * 1000U) / (RTC_PREDIV_S + 1U));
+	}
+	_micros_resync();
+
+	port_system_set_clock_profile(profile);
+
+	/* Latencia del despertar: desde la marca de tiempo que el RTC ha tomado en el flanco del boton (el hardware
+	 * arranca el regulador, la flash y el HSI antes de ejecutar nada) hasta tener otra vez el perfil de reloj */
+	wake_us = 0;
+	if (rtc_ready && (RTC->ISR & RTC_ISR_TSF))
+	{
+		uint32_t ts_ticks = _rtc_ticks_of_day(RTC->TSTR, RTC->TSSSR & RTC_TSSSR_SS);
+		uint32_t wake_ticks = (_rtc_get_ticks_of_day() + RTC_TICKS_PER_DAY - ts_ticks) % RTC_TICKS_PER_DAY;
+		wake_us = (uint32_t)(((uint64_t)wake_ticks * 1000000U) / (RTC_PREDIV_S + 1U));
+		RTC->ISR &= ~RTC_ISR_TSF;
+	}
+
+	__enable_irq();
+}
+
+uint32_t port_system_get_wake_us(void)
+{
+	return wake_us;
 }
\ No newline at end of file
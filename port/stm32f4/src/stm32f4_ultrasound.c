@@ -8,10 +8,10 @@
 
 /* Standard C includes */
 #include <stdio.h>
-#include <math.h>
 #include "port_ultrasound.h"
 #include "port_system.h"
 #include "stm32f4_system.h"
+#include "port_timer.h"
 #include "stm32f4_ultrasound.h"
 /* HW dependent includes */
 
@@ -36,6 +36,7 @@ typedef struct{
 	uint32_t 	echo_init_tick;
 	uint32_t 	echo_end_tick;
 	uint32_t 	echo_overflows;
+	bool 	suspended;
 } stm32f4_ultrasound_hw_t;
 
 /* Global variables */
@@ -52,6 +53,7 @@ static stm32f4_ultrasound_hw_t ultrasounds_arr[] = {
 		.echo_init_tick = 0,
 		.echo_end_tick = 0,
 		.echo_overflows = 0,
+		.suspended = false,
 	},
 };
 /* Private functions ----------------------------------------------------------*/
@@ -72,6 +74,47 @@ stm32f4_ultrasound_hw_t * 	_stm32f4_ultrasound_get (uint32_t ultrasound_id){
     }
 }
 
+/**
+ * @brief Calcula el PSC y el ARR del timer del trigger con el reloj actual del timer
+ */
+
+static void 	_timer_trigger_set_period (){
+	uint32_t psc, arr;
+	port_timer_compute_period(stm32f4_system_get_timer_clock(TIM3), PORT_PARKING_SENSOR_TRIGGER_UP_US, 1000000U, &psc, &arr);
+
+	TIM3 -> PSC = psc;
+	TIM3 -> ARR = arr;
+}
+
+/**
+ * @brief Calcula el PSC y el ARR del timer del timeout con el reloj actual del timer
+ */
+
+static void 	_timer_new_measurement_set_period (){
+	uint32_t psc, arr;
+	port_timer_compute_period(stm32f4_system_get_timer_clock(TIM5), PORT_PARKING_SENSOR_TIMEOUT_MS, 1000U, &psc, &arr);
+
+	TIM5 -> PSC = psc;
+	TIM5 -> ARR = arr;
+}
+
+/**
+ * @brief Calcula el PSC y el ARR del timer del echo (ticks de 1 us) con el reloj actual del timer
+ * 
+ * @param ultrasound_id ID del ultrasound
+ */
+
+static void 	_timer_echo_set_period (uint32_t ultrasound_id){
+	if(ultrasound_id == PORT_REAR_PARKING_SENSOR_ID){
+		//65536 ticks de 1 us
+		uint32_t psc, arr;
+		port_timer_compute_period(stm32f4_system_get_timer_clock(TIM2), 65536U, 1000000U, &psc, &arr);
+
+		TIM2 -> PSC = psc;
+		TIM2 -> ARR = arr;
+	}
+}
+
 /**
  * @brief Prepara el timer del trigger
  * 
@@ -86,17 +129,7 @@ static void 	_timer_trigger_setup (){
 
 	TIM3 -> CNT = 0;
 
-	double sys_core_clk = (double)SystemCoreClock;
-
-	double psc = round((((sys_core_clk/1000000.0)*PORT_PARKING_SENSOR_TRIGGER_UP_US)/(65535.0+1.0))-1.0);
-	double arr = round((((sys_core_clk/1000000.0)*PORT_PARKING_SENSOR_TRIGGER_UP_US)/(psc+1.0))-1.0);
-	if (arr > 65535.0){
-		psc += 1.0;
-		arr = round((((sys_core_clk/1000000.0)*PORT_PARKING_SENSOR_TRIGGER_UP_US)/(psc+1.0))-1.0);
-	}
-
-	TIM3 -> PSC = (uint32_t)psc;
-	TIM3 -> ARR = (uint32_t)arr;
+	_timer_trigger_set_period();
 
 	TIM3 -> EGR |= TIM_EGR_UG;
 	TIM3 -> SR &= ~TIM_SR_UIF;
@@ -121,17 +154,7 @@ static void 	_timer_new_measurement_setup (){
 
 	TIM5 -> CNT = 0;
 
-	double sys_core_clk = (double)SystemCoreClock;
-
-	double psc = round(((sys_core_clk/1000.0)*PORT_PARKING_SENSOR_TIMEOUT_MS)/(65535.0+1.0)-1.0);
-	double arr = round(((sys_core_clk/1000.0)*PORT_PARKING_SENSOR_TIMEOUT_MS)/(psc+1.0)-1.0);
-	if (arr>65535.0){
-		psc+=1.0;
-		arr = round(((sys_core_clk/1000.0)*PORT_PARKING_SENSOR_TIMEOUT_MS)/(psc+1.0)-1.0);
-	}
-
-	TIM5 -> PSC = (uint32_t)psc;
-	TIM5 -> ARR = (uint32_t)arr;
+	_timer_new_measurement_set_period();
 
 	TIM5 -> EGR |= TIM_EGR_UG;
 	TIM5 -> SR &= ~TIM_SR_UIF;
@@ -155,17 +178,7 @@ static void _timer_echo_setup(uint32_t ultrasound_id){
 
 		TIM2->CR1 |= TIM_CR1_ARPE;
 
-		double sys_core_clk = (double)SystemCoreClock;
-
-		double psc = round((((sys_core_clk/1000000.0)*65536.0)/(65535.0+1.0))-1.0);
-		double arr = round((((sys_core_clk/1000000.0)*65536.0)/(psc+1.0))-1.0);
-		if (arr > 65535.0){
-			psc += 1.0;
-			arr = round((((sys_core_clk/1000000.0)*65536.0)/(psc+1.0))-1.0);
-		}
-
-		TIM2 -> PSC = (uint32_t)psc;
-		TIM2 -> ARR = (uint32_t)arr;
+		_timer_echo_set_period(ultrasound_id);
 
 		
 		TIM2->EGR |= TIM_EGR_UG;
@@ -186,20 +199,13 @@ static void _timer_echo_setup(uint32_t ultrasound_id){
 	}
 }
 
-/* Public functions -----------------------------------------------------------*/
-
+/**
+ * @brief Configura el pin del trigger como salida y el del echo como entrada de captura del timer
+ * 
+ * @param p_ultrasound el objeto ultrasound
+ */
 
-void port_ultrasound_init(uint32_t ultrasound_id)
-{
-    /* Get the ultrasound sensor */
-    stm32f4_ultrasound_hw_t *p_ultrasound = _stm32f4_ultrasound_get(ultrasound_id);
-	
-    /* TO-DO alumnos: */
-	p_ultrasound -> trigger_ready = true;
-	p_ultrasound -> trigger_end = false;
-	p_ultrasound -> echo_received = false;
-	p_ultrasound -> echo_init_tick = 0;
-	p_ultrasound -> echo_end_tick = 0;
+static void 	_ultrasound_gpio_config (stm32f4_ultrasound_hw_t *p_ultrasound){
     /* Trigger pin configuration */
 	stm32f4_system_gpio_config(
 		p_ultrasound -> p_trigger_port,
@@ -219,10 +225,67 @@ void port_ultrasound_init(uint32_t ultrasound_id)
 		p_ultrasound -> echo_pin,
 		p_ultrasound -> echo_alt_fun
 	);
+}
+
+/**
+ * @brief Recalcula los timers del ultrasonidos tras un cambio de reloj del sistema
+ * 
+ * @param ultrasound_id ID del ultrasound
+ * 
+ * @note El UG carga el nuevo prescaler al instante y reinicia los contadores. Con las interrupciones deshabilitadas
+ * se limpian los flags que genera para que no cuenten como fin del trigger, timeout o desbordamiento del eco.
+ * Si habia un eco en curso esa medida sale mal, y la mediana de `fsm_ultrasound` la descarta.
+ */
+
+static void 	_ultrasound_retime_id (uint32_t ultrasound_id){
+	_timer_new_measurement_set_period();
+	TIM5 -> EGR = TIM_EGR_UG;
+	TIM5 -> SR &= ~TIM_SR_UIF;
+
+	if (ultrasound_id == PORT_REAR_PARKING_SENSOR_ID){
+		_timer_trigger_set_period();
+		TIM3 -> EGR = TIM_EGR_UG;
+		TIM3 -> SR &= ~TIM_SR_UIF;
+
+		_timer_echo_set_period(ultrasound_id);
+		TIM2 -> EGR = TIM_EGR_UG;
+		TIM2 -> SR &= ~TIM_SR_UIF;
+	}
+}
+
+/**
+ * @brief Avisado por el sistema cuando cambia el reloj. Los ultrasonidos suspendidos se recalculan al reanudarse
+ */
+
+static void 	_ultrasound_retime (void){
+	for (uint32_t ultrasound_id = 0; ultrasound_id < sizeof(ultrasounds_arr) / sizeof(ultrasounds_arr[0]); ultrasound_id++){
+		if (!ultrasounds_arr[ultrasound_id].suspended){
+			_ultrasound_retime_id(ultrasound_id);
+		}
+	}
+}
+
+/* Public functions -----------------------------------------------------------*/
+
+
+void port_ultrasound_init(uint32_t ultrasound_id)
+{
+    /* Get the ultrasound sensor */
+    stm32f4_ultrasound_hw_t *p_ultrasound = _stm32f4_ultrasound_get(ultrasound_id);
+	
+    /* TO-DO alumnos: */
+	p_ultrasound -> trigger_ready = true;
+	p_ultrasound -> trigger_end = false;
+	p_ultrasound -> echo_received = false;
+	p_ultrasound -> echo_init_tick = 0;
+	p_ultrasound -> echo_end_tick = 0;
+	p_ultrasound -> suspended = false;
+	_ultrasound_gpio_config(p_ultrasound);
     /* Configure timers */
 	_timer_trigger_setup();
 	_timer_new_measurement_setup();
 	_timer_echo_setup(ultrasound_id);
+	stm32f4_system_clock_listener_register(_ultrasound_retime);
 }
 
 
@@ -377,3 +440,44 @@ void 	port_ultrasound_stop_new_measurement_timer (void){
 	TIM5->CR1 &= ~TIM_CR1_CEN;
 }//Stop the timer that controls the new measurement. 
 
+void 	port_ultrasound_suspend (uint32_t ultrasound_id){
+	stm32f4_ultrasound_hw_t *p_ultrasound = _stm32f4_ultrasound_get(ultrasound_id);
+	if (p_ultrasound -> suspended) return;
+
+	port_ultrasound_stop_ultrasound(ultrasound_id);
+
+	NVIC_DisableIRQ(TIM3_IRQn);
+	NVIC_DisableIRQ(TIM5_IRQn);
+	TIM3 -> SR &= ~TIM_SR_UIF;
+	TIM5 -> SR &= ~TIM_SR_UIF;
+	NVIC_ClearPendingIRQ(TIM3_IRQn);
+	NVIC_ClearPendingIRQ(TIM5_IRQn);
+	if (ultrasound_id == PORT_REAR_PARKING_SENSOR_ID){
+		NVIC_DisableIRQ(TIM2_IRQn);
+		TIM2 -> SR &= ~(TIM_SR_UIF | TIM_SR_CC2IF);
+		NVIC_ClearPendingIRQ(TIM2_IRQn);
+	}
+
+	/* Sin reloj los timers conservan sus registros */
+	RCC -> APB1ENR &= ~(RCC_APB1ENR_TIM2EN | RCC_APB1ENR_TIM3EN | RCC_APB1ENR_TIM5EN);
+
+	stm32f4_system_gpio_park(p_ultrasound -> p_trigger_port, p_ultrasound -> trigger_pin);
+	stm32f4_system_gpio_park(p_ultrasound -> p_echo_port, p_ultrasound -> echo_pin);
+	p_ultrasound -> suspended = true;
+}//Suspend the HW of the ultrasound sensor.
+
+void 	port_ultrasound_resume (uint32_t ultrasound_id){
+	stm32f4_ultrasound_hw_t *p_ultrasound = _stm32f4_ultrasound_get(ultrasound_id);
+	if (!(p_ultrasound -> suspended)) return;
+
+	_ultrasound_gpio_config(p_ultrasound);
+	stm32f4_system_gpio_write(
+		p_ultrasound -> p_trigger_port,
+		p_ultrasound -> trigger_pin,
+		false
+	);
+	RCC -> APB1ENR |= (RCC_APB1ENR_TIM2EN | RCC_APB1ENR_TIM3EN | RCC_APB1ENR_TIM5EN);
+	/* El reloj del sistema puede haber cambiado mientras estaba suspendido */
+	_ultrasound_retime_id(ultrasound_id);
+	p_ultrasound -> suspended = false;
+}//Resume the HW of the ultrasound sensor.
@@ -313,6 +313,30 @@ void test_display_set_color(void)
     UNITY_TEST_ASSERT_EQUAL_UINT32(prev_tim_pwm_ccmr2, curr_tim_pwm_ccmr2, __LINE__, "ERROR: The register CCMR2 of the DISPLAY timer for PWM has been modified and it should not have been changed");
 }
 
+/**
+ * @brief Test that switching the DISPLAY off stops the timer and disables the outputs
+ *
+ */
+void test_display_set_off(void)
+{
+    rgb_color_t color_test_on = {TEST_PORT_DISPLAY_RGB_MAX_VALUE, TEST_PORT_DISPLAY_RGB_MAX_VALUE / 2, 1};
+    port_display_set_rgb(TEST_PORT_REAR_PARKING_DISPLAY_ID, color_test_on);
+
+    rgb_color_t color_test_off = {0, 0, 0};
+    port_display_set_rgb(TEST_PORT_REAR_PARKING_DISPLAY_ID, color_test_off);
+
+    uint32_t tim_pwm_en = (DISPLAY_RGB_PWM->CR1) & TIM_CR1_CEN_Msk;
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, tim_pwm_en, __LINE__, "ERROR: DISPLAY timer for PWM must be disabled after switching the display off");
+
+    uint32_t tim_pwm_ccer = (DISPLAY_RGB_PWM->CCER) & (TIM_CCER_CC1E_Msk | TIM_CCER_CC3E_Msk | TIM_CCER_CC4E_Msk);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, tim_pwm_ccer, __LINE__, "ERROR: DISPLAY timer for PWM output compare must be disabled (CCER) for all channels after switching the display off");
+
+    // Check that the next color starts the PWM again
+    port_display_set_rgb(TEST_PORT_REAR_PARKING_DISPLAY_ID, color_test_on);
+    tim_pwm_en = (DISPLAY_RGB_PWM->CR1) & TIM_CR1_CEN_Msk;
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TIM_CR1_CEN_Msk, tim_pwm_en, __LINE__, "ERROR: DISPLAY timer for PWM must be enabled again after setting a color");
+}
+
 int main(void)
 {
     port_system_init();
@@ -324,6 +348,7 @@ int main(void)
     RUN_TEST(test_trigger_regs);
     RUN_TEST(test_display_timer_pwm_config);
     RUN_TEST(test_display_set_color);
+    RUN_TEST(test_display_set_off);
 
     exit(UNITY_END());
 }
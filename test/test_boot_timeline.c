@@ -0,0 +1,101 @@
+/**
+ * @file test_boot_timeline.c
+ * @brief Test unitario de la linea de tiempos del arranque: etapas sin marcar, orden de las etapas, primer instante de cada una y cierre con la primera distancia.
+ *
+ * The timeline cannot be reset: the tests run in order and each one builds on the stages marked by the previous ones.
+ *
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-23
+ */
+/* System dependent libraries */
+#include <stdlib.h>
+#include <unity.h>
+
+/* HW independent libraries */
+#include "port_system.h"
+#include "boot_timeline.h"
+
+/* Defines ------------------------------------------------------------------*/
+#define TEST_BOOT_TIMELINE_DELAY_MS 2 /*!< Time between two stages */
+
+void setUp(void)
+{
+    // Nothing to do
+}
+
+void tearDown(void)
+{
+    // Nothing to do
+}
+
+/**
+ * @brief Check that no stage is reached before it is marked
+ *
+ */
+void test_not_reached(void)
+{
+    for (uint32_t stage = 0; stage < BOOT_STAGE_NUM; stage++)
+    {
+        UNITY_TEST_ASSERT_EQUAL_UINT32(BOOT_TIMELINE_NOT_REACHED, boot_timeline_get_us(stage), __LINE__, "A stage should not be reached before it is marked");
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(BOOT_TIMELINE_NOT_REACHED, boot_timeline_get_us(BOOT_STAGE_NUM), __LINE__, "A stage out of range should never be reached");
+}
+
+/**
+ * @brief Check that the stages after the system init are ordered and separated by the time between the marks
+ *
+ */
+void test_stages_ordered(void)
+{
+    boot_timeline_mark(BOOT_STAGE_SYSTEM_INIT);
+    port_system_delay_ms(TEST_BOOT_TIMELINE_DELAY_MS);
+    boot_timeline_mark(BOOT_STAGE_FSM_BUTTON);
+
+    uint32_t init_us = boot_timeline_get_us(BOOT_STAGE_SYSTEM_INIT);
+    uint32_t button_us = boot_timeline_get_us(BOOT_STAGE_FSM_BUTTON);
+    UNITY_TEST_ASSERT_NOT_EQUAL(BOOT_TIMELINE_NOT_REACHED, init_us, __LINE__, "The system init should be reached once it is marked");
+    UNITY_TEST_ASSERT_NOT_EQUAL(BOOT_TIMELINE_NOT_REACHED, button_us, __LINE__, "The button FSM should be reached once it is marked");
+    UNITY_TEST_ASSERT_GREATER_OR_EQUAL_UINT32(init_us + TEST_BOOT_TIMELINE_DELAY_MS * 1000, button_us, __LINE__, "The time between two stages should include the delay between the marks");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(BOOT_TIMELINE_NOT_REACHED, boot_timeline_get_us(BOOT_STAGE_FSM_DISPLAY), __LINE__, "A stage that is not marked should not be reached");
+}
+
+/**
+ * @brief Check that marking a stage again keeps the first timestamp
+ *
+ */
+void test_first_mark_kept(void)
+{
+    uint32_t button_us = boot_timeline_get_us(BOOT_STAGE_FSM_BUTTON);
+    port_system_delay_ms(TEST_BOOT_TIMELINE_DELAY_MS);
+    boot_timeline_mark(BOOT_STAGE_FSM_BUTTON);
+    boot_timeline_mark(BOOT_STAGE_NUM);
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(button_us, boot_timeline_get_us(BOOT_STAGE_FSM_BUTTON), __LINE__, "A stage should keep the time of its first mark");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(BOOT_TIMELINE_NOT_REACHED, boot_timeline_get_us(BOOT_STAGE_NUM), __LINE__, "A stage out of range should be ignored");
+}
+
+/**
+ * @brief Check that the first distance closes the timeline after the stages it skipped
+ *
+ */
+void test_first_distance(void)
+{
+    boot_timeline_mark(BOOT_STAGE_FIRST_DISTANCE);
+
+    UNITY_TEST_ASSERT_GREATER_OR_EQUAL_UINT32(boot_timeline_get_us(BOOT_STAGE_FSM_BUTTON), boot_timeline_get_us(BOOT_STAGE_FIRST_DISTANCE), __LINE__, "The first distance should come after the stages marked before it");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(BOOT_TIMELINE_NOT_REACHED, boot_timeline_get_us(BOOT_STAGE_URBANITE_ON), __LINE__, "The stages that were skipped should stay not reached");
+}
+
+int main(void)
+{
+    port_system_init();
+    UNITY_BEGIN();
+
+    RUN_TEST(test_not_reached);
+    RUN_TEST(test_stages_ordered);
+    RUN_TEST(test_first_mark_kept);
+    RUN_TEST(test_first_distance);
+
+    exit(UNITY_END());
+}
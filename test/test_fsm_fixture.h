@@ -0,0 +1,43 @@
+/**
+ * @file test_fsm_fixture.h
+ * @brief FSM de prueba comun a los tests que buscan en la tabla la transicion de un disparo. Sus guardas no se cumplen nunca: los tests ponen los estados a mano.
+ *
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-21
+ */
+#ifndef TEST_FSM_FIXTURE_H_
+#define TEST_FSM_FIXTURE_H_
+
+/* HW independent libraries */
+#include "fsm.h"
+
+/* Private functions ----------------------------------------------------------*/
+/**
+ * @brief Guard that never holds: the test sets the states by hand
+ *
+ * @param p_this FSM
+ * @return false
+ */
+static bool _never(fsm_t *p_this)
+{
+    (void)p_this;
+    return false;
+}
+
+/* Private variables ---------------------------------------------------------*/
+/**
+ * @brief Transition table of the FSM under test: a single transition from 1 to 0, a self transition in 2 and two transitions from 2 to 1
+ */
+static fsm_trans_t trans[] = {
+    {0, _never, 1, NULL},
+    {1, _never, 2, NULL},
+    {1, _never, 0, NULL},
+    {2, _never, 2, NULL},
+    {2, _never, 1, NULL},
+    {2, _never, 1, NULL},
+    {-1, NULL, -1, NULL},
+};
+static fsm_t fsm = {.current_state = 0, .p_tt = trans}; /*!< FSM under test */
+
+#endif /* TEST_FSM_FIXTURE_H_ */
@@ -0,0 +1,86 @@
+/**
+ * @file test_fsm_stats.c
+ * @brief Test unitario de los contadores de las FSM: transicion tomada por su indice, guardas evaluadas y tiempo en cada estado.
+ *
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-21
+ */
+/* System dependent libraries */
+#include <stdlib.h>
+#include <unity.h>
+
+/* HW independent libraries */
+#include "fsm_stats.h"
+#include "test_fsm_fixture.h"
+
+/* Private variables ---------------------------------------------------------*/
+static fsm_stats_t stats; /*!< Counters of the FSM under test */
+
+void setUp(void)
+{
+    stats = (fsm_stats_t){0};
+}
+
+void tearDown(void)
+{
+    // Nothing to do
+}
+
+/**
+ * @brief Check that the transition taken is counted by its index and that the guards before it are counted too
+ *
+ */
+void test_edges_and_guards(void)
+{
+    fsm.current_state = 0;
+    fsm_stats_fire(&stats, &fsm, 1, 0);
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, stats.fires, __LINE__, "Every fire should be counted");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, stats.edges[2], __LINE__, "The transition from 1 to 0 is the third one of the table");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, stats.guard_evals, __LINE__, "The guard from 1 to 2 is evaluated before the one from 1 to 0");
+}
+
+/**
+ * @brief Check that a fire without a change evaluates every guard of the state and takes no transition
+ *
+ */
+void test_no_transition(void)
+{
+    fsm.current_state = 1;
+    fsm_stats_fire(&stats, &fsm, 1, 0);
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, stats.guard_evals, __LINE__, "Every guard of the state should be evaluated");
+    for (uint32_t i = 0; i < FSM_STATS_MAX_EDGES; i++)
+    {
+        UNITY_TEST_ASSERT_EQUAL_UINT32(0, stats.edges[i], __LINE__, "No transition should be counted");
+    }
+}
+
+/**
+ * @brief Check that the time between two fires goes to the state the FSM was in
+ *
+ */
+void test_time_per_state(void)
+{
+    fsm.current_state = 1;
+    fsm_stats_fire(&stats, &fsm, 0, 100);
+    fsm.current_state = 2;
+    fsm_stats_fire(&stats, &fsm, 1, 130);
+    fsm_stats_fire(&stats, &fsm, 2, 200);
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(100, stats.state_ms[0], __LINE__, "The time until the first fire should go to the initial state");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(30, stats.state_ms[1], __LINE__, "The time between fires should go to the state before the fire");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(70, stats.state_ms[2], __LINE__, "A fire without a change should add its time too");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_edges_and_guards);
+    RUN_TEST(test_no_transition);
+    RUN_TEST(test_time_per_state);
+
+    exit(UNITY_END());
+}
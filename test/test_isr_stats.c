@@ -0,0 +1,94 @@
+/**
+ * @file test_isr_stats.c
+ * @brief Test unitario de los histogramas de las interrupciones: cubetas, latencias con su minimo y su maximo, y rutinas anidadas.
+ *
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-19
+ */
+/* System dependent libraries */
+#include <stdlib.h>
+#include <unity.h>
+
+/* HW independent libraries */
+#include "isr_stats.h"
+
+void setUp(void)
+{
+    isr_stats_reset();
+}
+
+void tearDown(void)
+{
+    // Nothing to do
+}
+
+/**
+ * @brief Check that every power of two starts a new bucket and that big values go to the last one
+ *
+ */
+void test_buckets(void)
+{
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, isr_stats_bucket(0), __LINE__, "Zero should have its own bucket");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, isr_stats_bucket(1), __LINE__, "One should be in the first bucket");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, isr_stats_bucket(3), __LINE__, "Three should be in the bucket from 2 to 3");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(3, isr_stats_bucket(4), __LINE__, "Four should start a new bucket");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(ISR_STATS_BUCKETS - 1, isr_stats_bucket(UINT32_MAX), __LINE__, "Big values should go to the last bucket");
+}
+
+/**
+ * @brief Check that the latencies are kept with their minimum, maximum and bucket, and that unknown ones are skipped
+ *
+ */
+void test_latency(void)
+{
+    isr_stats_enter(TRACE_ISR_TIM2, 12);
+    isr_stats_exit(TRACE_ISR_TIM2);
+    isr_stats_enter(TRACE_ISR_TIM2, 200);
+    isr_stats_exit(TRACE_ISR_TIM2);
+    isr_stats_enter(TRACE_ISR_EXTI15_10, ISR_STATS_LATENCY_UNKNOWN);
+    isr_stats_exit(TRACE_ISR_EXTI15_10);
+
+    const isr_stats_t *p_tim2 = isr_stats_get(TRACE_ISR_TIM2);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, p_tim2->latency.count, __LINE__, "Every latency should be recorded");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(12, p_tim2->latency.min, __LINE__, "The minimum latency is wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(200, p_tim2->latency.max, __LINE__, "The maximum latency is wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, p_tim2->latency.buckets[isr_stats_bucket(200)], __LINE__, "The latency should be in its bucket");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, p_tim2->duration.count, __LINE__, "Every run should have a duration");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, isr_stats_get(TRACE_ISR_EXTI15_10)->latency.count, __LINE__, "An unknown latency should not be recorded");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, isr_stats_get(TRACE_ISR_EXTI15_10)->duration.count, __LINE__, "A run without latency should still have a duration");
+}
+
+/**
+ * @brief Check that a nested routine is counted at its depth and that the outer one is marked as preempted
+ *
+ */
+void test_nesting(void)
+{
+    isr_stats_enter(TRACE_ISR_TIM2, ISR_STATS_LATENCY_UNKNOWN);
+    isr_stats_enter(TRACE_ISR_TIM10, ISR_STATS_LATENCY_UNKNOWN);
+    isr_stats_exit(TRACE_ISR_TIM10);
+    isr_stats_exit(TRACE_ISR_TIM2);
+    isr_stats_enter(TRACE_ISR_TIM2, ISR_STATS_LATENCY_UNKNOWN);
+    isr_stats_exit(TRACE_ISR_TIM2);
+
+    const isr_stats_t *p_tim2 = isr_stats_get(TRACE_ISR_TIM2);
+    const isr_stats_t *p_tim10 = isr_stats_get(TRACE_ISR_TIM10);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, p_tim2->nesting[0], __LINE__, "The outer routine should enter from the main program");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, p_tim10->nesting[1], __LINE__, "The nested routine should enter at depth 1");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, p_tim2->duration.count, __LINE__, "Every run of the outer routine should have a duration");
+    UNITY_TEST_ASSERT((p_tim10->stack_min_sp != 0) && (p_tim2->stack_min_sp != 0), __LINE__, "Every routine should keep its stack at entry");
+    UNITY_TEST_ASSERT(p_tim2->preempted.count <= 1, __LINE__, "Only the nested run can be preempted");
+    UNITY_TEST_ASSERT_NULL(isr_stats_get(TRACE_ISR_NUM), __LINE__, "A routine out of range should have no stats");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_buckets);
+    RUN_TEST(test_latency);
+    RUN_TEST(test_nesting);
+
+    exit(UNITY_END());
+}
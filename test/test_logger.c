@@ -0,0 +1,141 @@
+/**
+ * @file test_logger.c
+ * @brief Test unitario del registro diferido: registros guardados en el buffer circular con sus argumentos, niveles compilados y buffer lleno.
+ *
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-16
+ */
+/* System dependent libraries */
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+/* HW independent libraries */
+#include "logger.h"
+
+/* Defines */
+#define TEST_RECORD_MAX_WORDS (LOGGER_HEADER_WORDS + LOGGER_MAX_ARGS) /*!< Words of the longest record @hideinitializer */
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t record[TEST_RECORD_MAX_WORDS]; /*!< Record read from the logger */
+
+/* Private functions ----------------------------------------------------------*/
+/**
+ * @brief Empty the ring buffer and the lost records count
+ */
+static void _empty(void)
+{
+    while (logger_read(record, TEST_RECORD_MAX_WORDS) > 0)
+    {
+    }
+    logger_take_dropped();
+}
+
+void setUp(void)
+{
+    _empty();
+    memset(record, 0, sizeof(record));
+}
+
+void tearDown(void)
+{
+    // Nothing to do
+}
+
+/**
+ * @brief Check that a record keeps its level, its format and its arguments, in order
+ *
+ */
+void test_record(void)
+{
+    static const char fmt[] = "[TEST] %ld %lu\n";
+    const uint32_t args[] = {(uint32_t)-7, 42};
+
+    UNITY_TEST_ASSERT(logger_write(LOGGER_LEVEL_WARN, fmt, args, 2), __LINE__, "A record should fit in an empty buffer");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(LOGGER_HEADER_WORDS + 2, logger_read(record, TEST_RECORD_MAX_WORDS), __LINE__, "A record should have the header, the format and its arguments");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(LOGGER_HEADER(LOGGER_LEVEL_WARN, 2), record[0], __LINE__, "The header should have the magic byte, the level and the number of arguments");
+    UNITY_TEST_ASSERT_EQUAL_UINT32((uint32_t)(uintptr_t)fmt, record[1], __LINE__, "The record should store the address of the format");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(args[0], record[2], __LINE__, "The first argument is wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(args[1], record[3], __LINE__, "The second argument is wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, logger_read(record, TEST_RECORD_MAX_WORDS), __LINE__, "The buffer should be empty after reading its only record");
+}
+
+/**
+ * @brief Check that the macros store the records of the compiled levels only
+ *
+ */
+void test_levels(void)
+{
+    uint32_t expected = 0;
+
+    LOGGER_DEBUG("[TEST] debug %lu\n", 1);
+    LOGGER_INFO("[TEST] info %lu\n", 2);
+    LOGGER_ERROR("[TEST] error\n");
+    expected += (LOGGER_LEVEL <= LOGGER_LEVEL_DEBUG) + (LOGGER_LEVEL <= LOGGER_LEVEL_INFO) + (LOGGER_LEVEL <= LOGGER_LEVEL_ERROR);
+
+    uint32_t num_records = 0;
+    uint32_t prev_level = 0;
+    while (logger_read(record, TEST_RECORD_MAX_WORDS) > 0)
+    {
+        uint32_t level = (record[0] >> 8) & 0xFFU;
+        UNITY_TEST_ASSERT(((int32_t)level >= LOGGER_LEVEL), __LINE__, "A record below the compiled level should not be stored");
+        UNITY_TEST_ASSERT((level >= prev_level), __LINE__, "The records should come out in order");
+        prev_level = level;
+        num_records++;
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(expected, num_records, __LINE__, "Every record of a compiled level should be stored");
+}
+
+/**
+ * @brief Check that a full buffer drops whole records, counts them and keeps the older ones
+ *
+ */
+void test_full_buffer(void)
+{
+    static const char fmt[] = "[TEST] %lu %lu\n";
+    uint32_t words = LOGGER_HEADER_WORDS + 2;
+    uint32_t fit = LOGGER_BUFFER_WORDS / words;
+
+    for (uint32_t i = 0; i < fit + 3; i++)
+    {
+        const uint32_t args[] = {i, ~i};
+        logger_write(LOGGER_LEVEL_INFO, fmt, args, 2);
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(3, logger_take_dropped(), __LINE__, "The records that do not fit should be counted as lost");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, logger_take_dropped(), __LINE__, "Taking the lost records should reset the count");
+
+    for (uint32_t i = 0; i < fit; i++)
+    {
+        UNITY_TEST_ASSERT_EQUAL_UINT32(words, logger_read(record, TEST_RECORD_MAX_WORDS), __LINE__, "A stored record is missing");
+        UNITY_TEST_ASSERT_EQUAL_UINT32(i, record[2], __LINE__, "The stored records should be the oldest ones");
+        UNITY_TEST_ASSERT_EQUAL_UINT32(~i, record[3], __LINE__, "A record was corrupted when wrapping around the buffer");
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, logger_read(record, TEST_RECORD_MAX_WORDS), __LINE__, "No record should be left");
+}
+
+/**
+ * @brief Check that a record is not read into a buffer too small for it
+ *
+ */
+void test_small_read_buffer(void)
+{
+    static const char fmt[] = "[TEST] %lu %lu %lu\n";
+    const uint32_t args[] = {1, 2, 3};
+
+    logger_write(LOGGER_LEVEL_INFO, fmt, args, 3);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, logger_read(record, LOGGER_HEADER_WORDS + 2), __LINE__, "A record should not be cut");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(LOGGER_HEADER_WORDS + 3, logger_read(record, TEST_RECORD_MAX_WORDS), __LINE__, "The record should still be there");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_record);
+    RUN_TEST(test_levels);
+    RUN_TEST(test_full_buffer);
+    RUN_TEST(test_small_read_buffer);
+
+    exit(UNITY_END());
+}
@@ -0,0 +1,155 @@
+/**
+ * @file test_port_buzzer_envelope.c
+ * @brief Test unitario del volumen y la envolvente del buzzer: secuencia de CCR que escribe el DMA, escalado con el volumen y patrones que no caben.
+ *
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-12
+ */
+/* System dependent libraries */
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+/* HW independent libraries */
+#include "port_buzzer.h"
+#include "port_buzzer_envelope.h"
+
+/* Defines */
+#define TEST_CCR_ON 1000 /*!< CCR of a 50% duty cycle used to render the steps @hideinitializer */
+
+/* Private variables ---------------------------------------------------------*/
+static port_buzzer_step_t steps[PORT_BUZZER_PATTERN_MAX_STEPS]; /*!< Steps of the pattern under test */
+static uint16_t ccr[PORT_BUZZER_PATTERN_MAX_STEPS];              /*!< CCR sequence of the pattern under test */
+static bool loop;                                                /*!< Whether the pattern under test loops */
+
+/* Private functions ----------------------------------------------------------*/
+/**
+ * @brief Build a pattern and render its CCR sequence
+ *
+ * @param pattern pattern to build
+ * @return number of steps
+ */
+static uint32_t _build(buzzer_pattern_t pattern)
+{
+    uint32_t num_steps = port_buzzer_envelope_build(pattern, steps, PORT_BUZZER_PATTERN_MAX_STEPS, &loop);
+    for (uint32_t i = 0; i < num_steps; i++)
+    {
+        ccr[i] = port_buzzer_envelope_ccr(TEST_CCR_ON, steps[i].level);
+    }
+    return num_steps;
+}
+
+void setUp(void)
+{
+    memset(steps, 0, sizeof(steps));
+    memset(ccr, 0, sizeof(ccr));
+    loop = false;
+}
+
+void tearDown(void)
+{
+    // Nothing to do
+}
+
+/**
+ * @brief Check the CCR sequence of a looping beep at full volume: attack, sustain, decay and silence
+ *
+ */
+void test_beep_envelope(void)
+{
+    // RE: 44 periods on (3 per envelope step), 44 periods off
+    const uint16_t expected_ccr[] = {16, 141, 391, 766, TEST_CCR_ON, 766, 391, 141, 16, 0};
+    const uint16_t expected_periods[] = {3, 3, 3, 3, 20, 3, 3, 3, 3, 44};
+
+    uint32_t num_steps = _build((buzzer_pattern_t){RE, 150, 150, PORT_BUZZER_PATTERN_FOREVER, PORT_BUZZER_VOLUME_MAX});
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(sizeof(expected_ccr) / sizeof(expected_ccr[0]), num_steps, __LINE__, "A beep should have the attack, the sustain, the decay and the silence");
+    UNITY_TEST_ASSERT(loop, __LINE__, "A pattern repeated forever should loop");
+    UNITY_TEST_ASSERT_EQUAL_UINT16_ARRAY(expected_ccr, ccr, num_steps, __LINE__, "The CCR sequence does not follow the envelope");
+    for (uint32_t i = 0; i < num_steps; i++)
+    {
+        UNITY_TEST_ASSERT_EQUAL_UINT16(expected_periods[i], steps[i].periods, __LINE__, "The periods of a step are wrong");
+    }
+}
+
+/**
+ * @brief Check that the volume scales every step and keeps the length of the beep
+ *
+ */
+void test_volume(void)
+{
+    uint16_t full_ccr[PORT_BUZZER_PATTERN_MAX_STEPS];
+    uint32_t full_steps = _build((buzzer_pattern_t){MI, 275, 275, PORT_BUZZER_PATTERN_FOREVER, PORT_BUZZER_VOLUME_MAX});
+    memcpy(full_ccr, ccr, sizeof(ccr));
+
+    uint32_t half_steps = _build((buzzer_pattern_t){MI, 275, 275, PORT_BUZZER_PATTERN_FOREVER, PORT_BUZZER_VOLUME_MAX / 2});
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(full_steps, half_steps, __LINE__, "The volume should not change the steps of the pattern");
+    UNITY_TEST_ASSERT_EQUAL_UINT16(TEST_CCR_ON / 2, ccr[PORT_BUZZER_ENVELOPE_STEPS], __LINE__, "At half volume the sustain should be a 25% duty cycle");
+    for (uint32_t i = 0; i < half_steps; i++)
+    {
+        UNITY_TEST_ASSERT((ccr[i] <= (full_ccr[i] + 1) / 2), __LINE__, "A lower volume should lower every step");
+    }
+}
+
+/**
+ * @brief Check that a beep shorter than the envelope has no envelope and that a finite pattern ends in silence
+ *
+ */
+void test_short_finite_beep(void)
+{
+    // LA: 4 periods on and off, 3 beeps and 2 steps of silence
+    uint32_t num_steps = _build((buzzer_pattern_t){LA, 10, 10, 3, PORT_BUZZER_VOLUME_MAX});
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(8, num_steps, __LINE__, "A short beep should have one step on and one step off");
+    UNITY_TEST_ASSERT(!loop, __LINE__, "A finite pattern should not loop");
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        UNITY_TEST_ASSERT_EQUAL_UINT16(4, steps[i].periods, __LINE__, "Every step of a short beep should last the whole beep");
+        UNITY_TEST_ASSERT_EQUAL_UINT16((i % 2 == 0) ? TEST_CCR_ON : 0, ccr[i], __LINE__, "A short beep should switch between full level and silence");
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT16(0, ccr[num_steps - 1], __LINE__, "A finite pattern should end in silence");
+    UNITY_TEST_ASSERT_EQUAL_UINT16(PORT_BUZZER_STEP_MAX_PERIODS, steps[num_steps - 1].periods, __LINE__, "The last step should be as long as possible");
+}
+
+/**
+ * @brief Check that a continuous tone starts with the attack and stays at its level
+ *
+ */
+void test_continuous_tone(void)
+{
+    uint32_t num_steps = _build((buzzer_pattern_t){DO, 0, 0, PORT_BUZZER_PATTERN_FOREVER, PORT_BUZZER_VOLUME_MAX});
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(PORT_BUZZER_ENVELOPE_STEPS + 2, num_steps, __LINE__, "A continuous tone should have the attack and two steps of sustain");
+    UNITY_TEST_ASSERT(!loop, __LINE__, "A continuous tone should stay in its last step instead of looping");
+    for (uint32_t i = 1; i < num_steps; i++)
+    {
+        UNITY_TEST_ASSERT((ccr[i] >= ccr[i - 1]), __LINE__, "The attack should rise");
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT16(TEST_CCR_ON, ccr[num_steps - 1], __LINE__, "A continuous tone should end at its level");
+}
+
+/**
+ * @brief Check that a pattern with too many steps is rejected
+ *
+ */
+void test_too_many_steps(void)
+{
+    uint32_t num_steps = _build((buzzer_pattern_t){SOL, 100, 100, 10, PORT_BUZZER_VOLUME_MAX});
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, num_steps, __LINE__, "A pattern that does not fit should be rejected");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_beep_envelope);
+    RUN_TEST(test_volume);
+    RUN_TEST(test_short_finite_beep);
+    RUN_TEST(test_continuous_tone);
+    RUN_TEST(test_too_many_steps);
+
+    exit(UNITY_END());
+}
@@ -0,0 +1,82 @@
+/**
+ * @file test_port_timer.c
+ * @brief Test unitario del calculo de PSC y ARR de los timers de 16 bits: mismos valores que daba `round()` en doble precision.
+ *
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-24
+ */
+/* System dependent libraries */
+#include <stdlib.h>
+#include <unity.h>
+
+/* HW independent libraries */
+#include "port_timer.h"
+
+/* Private functions ----------------------------------------------------------*/
+void setUp(void)
+{
+    // Nothing to do
+}
+
+void tearDown(void)
+{
+    // Nothing to do
+}
+
+/**
+ * @brief Check a period that fits in 16 bits without prescaler
+ *
+ */
+void test_short_period(void)
+{
+    uint32_t psc, arr;
+    port_timer_compute_period(84000000, 10, 1000000, &psc, &arr);
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, psc, __LINE__, "A period shorter than 16 bits should not use the prescaler");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(839, arr, __LINE__, "10 us at 84 MHz are 840 ticks");
+}
+
+/**
+ * @brief Check that the prescaler goes up by one when the rounded one leaves the period out of 16 bits
+ *
+ */
+void test_prescaler_bump(void)
+{
+    uint32_t psc, arr;
+    port_timer_compute_period(84000000, 100, 1000, &psc, &arr);
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(128, psc, __LINE__, "The rounded prescaler leaves the period over 16 bits and should go up by one");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(65115, arr, __LINE__, "The period should be rounded to the nearest tick");
+}
+
+/**
+ * @brief Check the periods of the display PWM, the echo timer and a buzzer note against the old calculation in double precision
+ *
+ */
+void test_driver_periods(void)
+{
+    uint32_t psc, arr;
+    port_timer_compute_period(180000000, 1, 50, &psc, &arr);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(54, psc, __LINE__, "The prescaler of the display PWM is wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(65454, arr, __LINE__, "The period of the display PWM is wrong");
+
+    port_timer_compute_period(16000000, 65536, 1000000, &psc, &arr);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(15, psc, __LINE__, "The echo timer should count microseconds");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(65535, arr, __LINE__, "The echo timer should use the whole 16 bits");
+
+    port_timer_compute_period(90000000, 1, 261, &psc, &arr);
+    UNITY_TEST_ASSERT_EQUAL_UINT32(5, psc, __LINE__, "The prescaler of the note is wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(57470, arr, __LINE__, "The period of the note is wrong");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_short_period);
+    RUN_TEST(test_prescaler_bump);
+    RUN_TEST(test_driver_periods);
+
+    exit(UNITY_END());
+}
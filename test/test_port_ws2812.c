@@ -0,0 +1,99 @@
+/**
+ * @file test_port_ws2812.c
+ * @brief Test unitario de la trama de los WS2812: tamano, codificacion GRB de cada bit y tiempo de reset al final.
+ *
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-10
+ */
+/* System dependent libraries */
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+/* HW independent libraries */
+#include "port_display.h"
+#include "port_ws2812.h"
+
+/* Defines */
+#define TEST_NUM_LEDS 4 /*!< LEDs of the test strip @hideinitializer */
+#define TEST_GUARD_BYTE 0xA5 /*!< Value written after the frame to detect overflows @hideinitializer */
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t buffer[PORT_WS2812_BUFFER_SIZE(TEST_NUM_LEDS) + 1]; /*!< Encoded frame plus one guard byte */
+
+/* Private functions ----------------------------------------------------------*/
+void setUp(void)
+{
+    memset(buffer, TEST_GUARD_BYTE, sizeof(buffer));
+}
+
+void tearDown(void)
+{
+    // Nothing to do
+}
+
+/**
+ * @brief Check the size of the frame and that the encoder does not write past it
+ *
+ */
+void test_frame_size(void)
+{
+    rgb_color_t pixels[TEST_NUM_LEDS] = {COLOR_OFF, COLOR_OFF, COLOR_OFF, COLOR_OFF};
+
+    uint32_t num_bytes = port_ws2812_encode(pixels, TEST_NUM_LEDS, buffer);
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TEST_NUM_LEDS * 9 + PORT_WS2812_RESET_BYTES, num_bytes, __LINE__, "The frame should have 9 bytes per LED plus the reset bytes");
+    UNITY_TEST_ASSERT_EQUAL_HEX8(TEST_GUARD_BYTE, buffer[num_bytes], __LINE__, "The encoder wrote past the end of the frame");
+}
+
+/**
+ * @brief Check the encoded frame byte for byte: GRB order, MSB first, 100 for a 0 and 110 for a 1
+ *
+ */
+void test_encoding(void)
+{
+    rgb_color_t pixels[TEST_NUM_LEDS] = {
+        COLOR_OFF,
+        {255, 255, 255},
+        {0x12, 0x34, 0xA5},
+        COLOR_YELLOW,
+    };
+    const uint8_t expected[TEST_NUM_LEDS * 9] = {
+        0x92, 0x49, 0x24, 0x92, 0x49, 0x24, 0x92, 0x49, 0x24, // off
+        0xDB, 0x6D, 0xB6, 0xDB, 0x6D, 0xB6, 0xDB, 0x6D, 0xB6, // white
+        0x93, 0x69, 0xA4, 0x92, 0x69, 0x34, 0xD3, 0x49, 0xA6, // G = 0x34, R = 0x12, B = 0xA5
+        0xDB, 0x4D, 0xA6, 0xDB, 0x4D, 0xA6, 0x92, 0x49, 0x24, // yellow (237, 237, 0)
+    };
+
+    port_ws2812_encode(pixels, TEST_NUM_LEDS, buffer);
+
+    UNITY_TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buffer, sizeof(expected), __LINE__, "The encoded colors do not match the WS2812 bit stream");
+}
+
+/**
+ * @brief Check that the frame ends with the reset time at low level
+ *
+ */
+void test_reset_tail(void)
+{
+    rgb_color_t pixels[TEST_NUM_LEDS] = {{255, 255, 255}, {255, 255, 255}, {255, 255, 255}, {255, 255, 255}};
+
+    port_ws2812_encode(pixels, TEST_NUM_LEDS, buffer);
+
+    for (uint32_t i = TEST_NUM_LEDS * PORT_WS2812_BYTES_PER_LED; i < PORT_WS2812_BUFFER_SIZE(TEST_NUM_LEDS); i++)
+    {
+        UNITY_TEST_ASSERT_EQUAL_HEX8(0x00, buffer[i], __LINE__, "The reset bytes at the end of the frame should be 0");
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_frame_size);
+    RUN_TEST(test_encoding);
+    RUN_TEST(test_reset_tail);
+
+    exit(UNITY_END());
+}
@@ -0,0 +1,101 @@
+/**
+ * @file test_trace.c
+ * @brief Test unitario de la traza: registros del buffer circular, marcas de las interrupciones e indice de la transicion de cada disparo.
+ *
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-18
+ */
+/* System dependent libraries */
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+/* HW independent libraries */
+#include "trace.h"
+#include "test_fsm_fixture.h"
+
+void setUp(void)
+{
+    trace_reset();
+}
+
+void tearDown(void)
+{
+    // Nothing to do
+}
+
+/**
+ * @brief Check that a fire keeps the FSM, the states and the index of the transition
+ *
+ */
+void test_fsm_fire(void)
+{
+    const trace_ring_t *p_ring = trace_get_ring();
+
+    fsm.current_state = 0;
+    trace_fsm_fire(3, 0, &fsm, 1);
+    fsm.current_state = 2;
+    trace_fsm_fire(3, 0, &fsm, 2);
+    trace_fsm_fire(3, 0, &fsm, 0);
+    fsm.current_state = 1;
+    trace_fsm_fire(3, 0, &fsm, 1);
+    trace_fsm_fire(3, 0, &fsm, 2);
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(5, p_ring->head, __LINE__, "Every fire should be recorded");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TRACE_TYPE_FSM, p_ring->records[0].type, __LINE__, "A fire should be recorded as a FSM record");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(3, p_ring->records[0].id, __LINE__, "The FSM id is wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(1, p_ring->records[0].from, __LINE__, "The state before the fire is wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(0, p_ring->records[0].to, __LINE__, "The state after the fire is wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(2, p_ring->records[0].guard, __LINE__, "The only transition from the origin to the destination should be found");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TRACE_GUARD_UNKNOWN, p_ring->records[1].guard, __LINE__, "A self transition may not have been taken");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TRACE_GUARD_NONE, p_ring->records[2].guard, __LINE__, "A fire with no transition between the states should have no guard");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TRACE_GUARD_NONE, p_ring->records[3].guard, __LINE__, "A state without a self transition should have no guard");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TRACE_GUARD_UNKNOWN, p_ring->records[4].guard, __LINE__, "With two transitions between the states the guard that held is not known");
+}
+
+/**
+ * @brief Check that the ISR markers keep their routine and their type
+ *
+ */
+void test_isr_markers(void)
+{
+    const trace_ring_t *p_ring = trace_get_ring();
+
+    trace_record(TRACE_TYPE_ISR_ENTER, TRACE_ISR_TIM2);
+    trace_record(TRACE_TYPE_ISR_EXIT, TRACE_ISR_TIM2);
+
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TRACE_TYPE_ISR_ENTER, p_ring->records[0].type, __LINE__, "The entry marker is wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TRACE_TYPE_ISR_EXIT, p_ring->records[1].type, __LINE__, "The exit marker is wrong");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TRACE_ISR_TIM2, p_ring->records[1].id, __LINE__, "The routine of the marker is wrong");
+    UNITY_TEST_ASSERT((p_ring->records[1].ts_us >= p_ring->records[0].ts_us), __LINE__, "The exit should not be before the entry");
+}
+
+/**
+ * @brief Check that a full buffer keeps the newest records
+ *
+ */
+void test_wrap(void)
+{
+    const trace_ring_t *p_ring = trace_get_ring();
+
+    for (uint32_t i = 0; i < TRACE_BUFFER_RECORDS + 5; i++)
+    {
+        trace_record(TRACE_TYPE_ISR_ENTER, (uint8_t)i);
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TRACE_BUFFER_RECORDS + 5, p_ring->head, __LINE__, "The head should count every record");
+    UNITY_TEST_ASSERT_EQUAL_UINT32((uint8_t)TRACE_BUFFER_RECORDS, p_ring->records[0].id, __LINE__, "The oldest record should be overwritten");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(5, p_ring->records[5].id, __LINE__, "Only the oldest records should be overwritten");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(TRACE_MAGIC, p_ring->magic, __LINE__, "The buffer should keep its mark for the memory dump");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_fsm_fire);
+    RUN_TEST(test_isr_markers);
+    RUN_TEST(test_wrap);
+
+    exit(UNITY_END());
+}
@@ -0,0 +1,139 @@
+/**
+ * @file test_zones.c
+ * @brief Test unitario de las zonas de distancia: tabla de una zona por centimetro, histeresis en cada limite y cambio de limites.
+ *
+ * @author Eneko Emilio Sendín Gallastegi
+ * @author Rodrigo Gutiérrez Fontán
+ * @date 2025-06-13
+ */
+/* System dependent libraries */
+#include <stdlib.h>
+#include <unity.h>
+
+/* HW independent libraries */
+#include "zones.h"
+
+/* Private variables ---------------------------------------------------------*/
+/**
+ * @brief Default limits of the zones, restored after every test
+ */
+static const uint32_t default_max_cm[ZONES_NUM] = {WARNING_MIN_CM, NO_PROBLEM_MIN_CM, INFO_MIN_CM, OK_MIN_CM, OK_MAX_CM};
+
+/* Private functions ----------------------------------------------------------*/
+void setUp(void)
+{
+    // Nothing to do
+}
+
+void tearDown(void)
+{
+    zones_set_limits(default_max_cm, ZONES_HYSTERESIS_CM);
+}
+
+/**
+ * @brief Check the zone of the distances at both sides of every default limit and out of range
+ *
+ */
+void test_lookup(void)
+{
+    for (uint32_t zone = 0; zone < ZONES_NUM; zone++)
+    {
+        int32_t max_cm = (int32_t)zones_get_max_cm(zone);
+        UNITY_TEST_ASSERT_EQUAL_UINT32(zone, zones_lookup(max_cm), __LINE__, "The maximum distance of a zone should belong to it");
+        UNITY_TEST_ASSERT_EQUAL_UINT32(zone + 1, zones_lookup(max_cm + 1), __LINE__, "The distance after the maximum of a zone should belong to the next one");
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(ZONE_DANGER, zones_lookup(0), __LINE__, "0 cm should be in the danger zone");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(ZONE_NONE, zones_lookup(-1), __LINE__, "A negative distance should be out of range");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(ZONE_NONE, zones_lookup(ZONES_RANGE_MAX_CM + 1), __LINE__, "A distance over the range of the sensor should be out of range");
+}
+
+/**
+ * @brief Check that a distance hovering at every limit does not change the zone until it leaves the hysteresis band
+ *
+ */
+void test_hysteresis_at_every_limit(void)
+{
+    const int32_t h = ZONES_HYSTERESIS_CM;
+    for (uint32_t zone = 0; zone < ZONES_NUM; zone++)
+    {
+        int32_t limit = (int32_t)zones_get_max_cm(zone);
+
+        // Coming from below, the zone only goes up once the distance is further than the band over the limit
+        uint32_t current = zones_classify(limit - h - 1, ZONE_NONE);
+        UNITY_TEST_ASSERT_EQUAL_UINT32(zone, current, __LINE__, "A distance far from the limit should be classified without hysteresis");
+        const int32_t hover_up[] = {limit, limit + 1, limit + h, limit - 1, limit + h, limit};
+        for (uint32_t i = 0; i < sizeof(hover_up) / sizeof(hover_up[0]); i++)
+        {
+            current = zones_classify(hover_up[i], current);
+            UNITY_TEST_ASSERT_EQUAL_UINT32(zone, current, __LINE__, "A distance hovering inside the band should keep the lower zone");
+        }
+        current = zones_classify(limit + h + 1, current);
+        UNITY_TEST_ASSERT_EQUAL_UINT32(zone + 1, current, __LINE__, "A distance past the band should change to the upper zone");
+
+        // Coming from above, the zone only goes down once the distance is further than the band under the limit
+        const int32_t hover_down[] = {limit + 1, limit, limit - h + 1, limit + 2, limit - h + 1};
+        for (uint32_t i = 0; i < sizeof(hover_down) / sizeof(hover_down[0]); i++)
+        {
+            current = zones_classify(hover_down[i], current);
+            UNITY_TEST_ASSERT_EQUAL_UINT32(zone + 1, current, __LINE__, "A distance hovering inside the band should keep the upper zone");
+        }
+        current = zones_classify(limit - h, current);
+        UNITY_TEST_ASSERT_EQUAL_UINT32(zone, current, __LINE__, "A distance past the band should change to the lower zone");
+    }
+}
+
+/**
+ * @brief Check that limits that are not increasing or do not fit in the range are rejected without changing anything
+ *
+ */
+void test_set_limits_rejected(void)
+{
+    const uint32_t repeated_cm[ZONES_NUM] = {10, 20, 20, 30, 40};
+    const uint32_t decreasing_cm[ZONES_NUM] = {10, 30, 20, 40, 50};
+    const uint32_t too_far_cm[ZONES_NUM] = {10, 20, 30, 40, ZONES_RANGE_MAX_CM};
+    uint32_t generation = zones_get_generation();
+
+    UNITY_TEST_ASSERT(!zones_set_limits(repeated_cm, ZONES_HYSTERESIS_CM), __LINE__, "Two equal limits should be rejected");
+    UNITY_TEST_ASSERT(!zones_set_limits(decreasing_cm, ZONES_HYSTERESIS_CM), __LINE__, "Decreasing limits should be rejected");
+    UNITY_TEST_ASSERT(!zones_set_limits(too_far_cm, ZONES_HYSTERESIS_CM), __LINE__, "The last limit plus the hysteresis should fit in the range");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(generation, zones_get_generation(), __LINE__, "Rejected limits should not change the generation");
+    for (uint32_t zone = 0; zone < ZONES_NUM; zone++)
+    {
+        UNITY_TEST_ASSERT_EQUAL_UINT32(default_max_cm[zone], zones_get_max_cm(zone), __LINE__, "Rejected limits should not change the zones");
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(ZONE_WARNING, zones_lookup(WARNING_MIN_CM + 1), __LINE__, "Rejected limits should not change the table");
+}
+
+/**
+ * @brief Check that new limits rebuild the table and change the hysteresis
+ *
+ */
+void test_set_limits_rebuilds_lut(void)
+{
+    const uint32_t max_cm[ZONES_NUM] = {10, 20, 30, 40, 50};
+    uint32_t generation = zones_get_generation();
+
+    UNITY_TEST_ASSERT(zones_set_limits(max_cm, 2), __LINE__, "Increasing limits should be accepted");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(generation + 1, zones_get_generation(), __LINE__, "New limits should change the generation");
+    for (uint32_t zone = 0; zone < ZONES_NUM; zone++)
+    {
+        UNITY_TEST_ASSERT_EQUAL_UINT32(max_cm[zone], zones_get_max_cm(zone), __LINE__, "The maximum of a zone should be the new limit");
+        UNITY_TEST_ASSERT_EQUAL_UINT32(zone, zones_lookup((int32_t)max_cm[zone]), __LINE__, "The table should use the new limits");
+        UNITY_TEST_ASSERT_EQUAL_UINT32(zone + 1, zones_lookup((int32_t)max_cm[zone] + 1), __LINE__, "The table should use the new limits");
+    }
+    UNITY_TEST_ASSERT_EQUAL_UINT32(11, zones_get_min_cm(ZONE_WARNING), __LINE__, "A zone should start after the maximum of the previous one");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(ZONE_OK, zones_classify(52, ZONE_OK), __LINE__, "The new hysteresis should keep the zone inside the band");
+    UNITY_TEST_ASSERT_EQUAL_UINT32(ZONE_NONE, zones_classify(53, ZONE_OK), __LINE__, "The new hysteresis should change the zone past the band");
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_lookup);
+    RUN_TEST(test_hysteresis_at_every_limit);
+    RUN_TEST(test_set_limits_rejected);
+    RUN_TEST(test_set_limits_rebuilds_lut);
+
+    exit(UNITY_END());
+}
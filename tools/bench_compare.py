@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""
+Comparador de los benchmarks de bench/ con la linea base.
+
+Cada benchmark imprime una linea por escenario, `BENCH <escenario> insns=<n> cycles=<n>`, y al final `BENCH_END`. Con
+QEMU en modo -icount las cuentas son siempre las mismas para el mismo binario, asi que cualquier subida es codigo nuevo
+en el camino medido. Falla si un escenario pasa de la linea base mas la tolerancia, si un escenario no esta en la linea
+base cuando otros del mismo benchmark si lo estan (hay que guardarlo con --update) o si el benchmark no llega al final.
+Un benchmark sin ningun escenario en la linea base todavia no tiene referencia: se avisa y no falla.
+
+Uso:
+    bench_compare.py bench/baseline.txt -- qemu-system-arm <opciones> -icount shift=0 -kernel bench_fsm.elf
+    bench_compare.py bench/baseline.txt --results salida.txt
+    bench_compare.py --update bench/baseline.txt --results salida.txt      # acepta las cuentas como nueva linea base
+
+Solo usa la biblioteca estandar de Python.
+"""
+
+import argparse
+import re
+import subprocess
+import sys
+
+RESULT = re.compile(r"^BENCH (\S+) insns=(\d+) cycles=(\d+)\s*$")
+END = "BENCH_END"
+COUNTERS = ("insns", "cycles")
+
+
+def parse_results(lines):
+    """Devuelve las cuentas de cada escenario y si el benchmark ha llegado al final."""
+    results = {}
+    finished = False
+    for line in lines:
+        line = line.strip()
+        match = RESULT.match(line)
+        if match:
+            results[match.group(1)] = {"insns": int(match.group(2)), "cycles": int(match.group(3))}
+        elif line == END:
+            finished = True
+    return results, finished
+
+
+def read_baseline(path):
+    """Devuelve los comentarios de cabecera y las cuentas de la linea base. Si no existe, esta vacia."""
+    header = []
+    baseline = {}
+    try:
+        with open(path) as f:
+            for line in f:
+                fields = line.split()
+                if not fields or fields[0].startswith("#"):
+                    if not baseline:
+                        header.append(line.rstrip("\n"))
+                    continue
+                baseline[fields[0]] = {k: int(v) for k, v in (field.split("=") for field in fields[1:])}
+    except FileNotFoundError:
+        pass
+    return header, baseline
+
+
+def write_baseline(path, header, baseline):
+    with open(path, "w") as f:
+        for line in header:
+            f.write(line + "\n")
+        for name in sorted(baseline):
+            f.write(name + "".join(f" {k}={baseline[name][k]}" for k in COUNTERS) + "\n")
+
+
+def compare(results, baseline, tolerance, out):
+    """Imprime cada escenario frente a la linea base y devuelve el numero de regresiones y de escenarios sin linea base."""
+    regressions = 0
+    missing = 0
+    for name, counts in results.items():
+        base = baseline.get(name)
+        if base is None:
+            out.write(f"{name}: FALTA en la linea base ({counts['insns']} instrucciones, {counts['cycles']} ciclos)\n")
+            missing += 1
+            continue
+        status = "igual"
+        report = []
+        for counter in COUNTERS:
+            old = base.get(counter, 0)
+            new = counts[counter]
+            change = (new - old) * 100.0 / old if old else 0.0
+            report.append(f"{counter} {old} -> {new} ({change:+.2f}%)")
+            if new > old * (1 + tolerance / 100.0):
+                status = "REGRESION"
+            elif new > old and status != "REGRESION":
+                status = "dentro de la tolerancia"
+            elif new < old and status == "igual":
+                status = "mejora"
+        if status == "REGRESION":
+            regressions += 1
+        out.write(f"{name}: {status}: {', '.join(report)}\n")
+    return regressions, missing
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compara las cuentas de los benchmarks con la linea base")
+    parser.add_argument("baseline", help="fichero de la linea base")
+    parser.add_argument("--results", help="salida ya guardada del benchmark, en lugar de ejecutarlo")
+    parser.add_argument("--tolerance", type=float, default=0.0, help="subida en %% que no se cuenta como regresion")
+    parser.add_argument("--update", action="store_true", help="guarda las cuentas en la linea base en lugar de compararlas")
+    # Lo que va despues de -- es el comando del benchmark, con sus propias opciones
+    argv = sys.argv[1:]
+    split = argv.index("--") if "--" in argv else len(argv)
+    args = parser.parse_args(argv[:split])
+    command = argv[split + 1:]
+    if args.results:
+        with open(args.results) as f:
+            lines = f.read().splitlines()
+    elif command:
+        run = subprocess.run(command, stdout=subprocess.PIPE, universal_newlines=True)
+        lines = run.stdout.splitlines()
+    else:
+        parser.error("hace falta --results o el comando del benchmark despues de --")
+
+    results, finished = parse_results(lines)
+    if not finished:
+        sys.stdout.write("\n".join(lines) + "\n")
+        sys.exit("el benchmark no ha llegado al final (BENCH_END)")
+
+    header, baseline = read_baseline(args.baseline)
+    if args.update:
+        baseline.update(results)
+        write_baseline(args.baseline, header, baseline)
+        print(f"{len(results)} escenarios guardados en {args.baseline}")
+        return
+
+    regressions, missing = compare(results, baseline, args.tolerance, sys.stdout)
+    if results and missing == len(results):
+        print(f"el benchmark no tiene linea base en {args.baseline}: se guarda con --update en una ejecucion de referencia")
+        return
+    errors = []
+    if regressions:
+        errors.append(f"{regressions} escenarios por encima de la linea base")
+    if missing:
+        errors.append(f"{missing} escenarios sin linea base (se guardan con --update)")
+    if errors:
+        sys.exit(", ".join(errors))
+
+
+if __name__ == "__main__":
+    main()
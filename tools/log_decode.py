@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""
+Decodificador de los registros binarios de logger.c.
+
+Cada registro son palabras de 32 bits en little endian: la cabecera (byte magico 0xA5, nivel y numero de
+argumentos), la direccion del formato en la flash y los argumentos. El formato se lee del ELF con el que se
+compilo el programa, asi que la placa nunca manda texto.
+
+Uso:
+    log_decode.py bin/stm32f446re/Debug/main.elf captura.bin           # captura del SWO con paquetes del ITM
+    log_decode.py --raw bin/stm32f446re/Debug/main.elf puerto1.bin     # palabras del puerto 1 ya separadas
+
+Solo usa la biblioteca estandar de Python.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+LOGGER_MAGIC = 0xA5
+LOGGER_HEADER_WORDS = 2
+LOGGER_ITM_PORT = 1
+LEVELS = ["DEBUG", "INFO", "WARN", "ERROR"]
+
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+
+
+class Elf:
+    """Secciones cargadas en memoria de un ELF de 32 bits en little endian."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1 or self.data[5] != 1:
+            sys.exit(f"{path}: no es un ELF de 32 bits en little endian")
+        e_shoff, = struct.unpack_from("<I", self.data, 0x20)
+        e_shentsize, e_shnum = struct.unpack_from("<HH", self.data, 0x2E)
+        self.sections = []
+        for i in range(e_shnum):
+            (_, sh_type, sh_flags, sh_addr, sh_offset, sh_size) = struct.unpack_from(
+                "<IIIIII", self.data, e_shoff + i * e_shentsize)
+            if (sh_flags & SHF_ALLOC) and sh_type != SHT_NOBITS and sh_size > 0:
+                self.sections.append((sh_addr, sh_offset, sh_size))
+
+    def string_at(self, address):
+        """Devuelve la cadena terminada en NUL que hay en una direccion, o None si no esta en el ELF."""
+        for sh_addr, sh_offset, sh_size in self.sections:
+            if sh_addr <= address < sh_addr + sh_size:
+                start = sh_offset + (address - sh_addr)
+                end = self.data.index(b"\x00", start, sh_offset + sh_size)
+                return self.data[start:end].decode("latin-1")
+        return None
+
+
+CONVERSION = re.compile(r"(%[-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|j|t)?([diouxXc%])")
+
+
+def format_record(fmt, args):
+    """Aplica un formato de printf a argumentos de 32 bits, con signo en %d e %i."""
+    arg_iter = iter(args)
+
+    def convert(match):
+        spec, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+        value = next(arg_iter, 0)
+        if conversion in "di" and value & 0x80000000:
+            value -= 1 << 32
+        # Sin el modificador de longitud, que en Python no existe
+        return (spec + conversion) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def itm_port_bytes(stream, port):
+    """Separa del flujo del SWO los datos de un puerto de estimulo del ITM."""
+    out = bytearray()
+    i = 0
+    while i < len(stream):
+        header = stream[i]
+        i += 1
+        if header == 0x00 or header == 0x70:
+            continue  # sincronizacion o desbordamiento
+        size = header & 0x03
+        if size != 0:
+            length = {1: 1, 2: 2, 3: 4}[size]
+            if not header & 0x04 and (header >> 3) == port:
+                out += stream[i:i + length]
+            i += length
+            continue
+        if header & 0x80:
+            # Marca de tiempo local o global: bytes de continuacion hasta uno sin el bit 7
+            while i < len(stream) and stream[i] & 0x80:
+                i += 1
+            i += 1
+    return bytes(out)
+
+
+def decode(elf, data, out):
+    words = [w for (w,) in struct.iter_unpack("<I", data[:len(data) & ~3])]
+    i = 0
+    lost = 0
+    while i + LOGGER_HEADER_WORDS <= len(words):
+        header = words[i]
+        num_args = header & 0xFF
+        if (header >> 24) != LOGGER_MAGIC or i + LOGGER_HEADER_WORDS + num_args > len(words):
+            # Palabra suelta (captura empezada a mitad de un registro): se busca la siguiente cabecera
+            i += 1
+            lost += 1
+            continue
+        level = (header >> 8) & 0xFF
+        address = words[i + 1]
+        fmt = elf.string_at(address)
+        args = words[i + LOGGER_HEADER_WORDS:i + LOGGER_HEADER_WORDS + num_args]
+        i += LOGGER_HEADER_WORDS + num_args
+        if fmt is None:
+            out.write(f"<{LEVELS[level] if level < len(LEVELS) else level}> formato desconocido 0x{address:08x} {args}\n")
+            continue
+        out.write(format_record(fmt, args))
+    if lost:
+        sys.stderr.write(f"{lost} palabras sin cabecera valida descartadas\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Reconstruye el texto de los registros binarios del logger")
+    parser.add_argument("elf", help="ELF del programa que genero los registros")
+    parser.add_argument("capture", help="captura binaria")
+    parser.add_argument("--raw", action="store_true", help="la captura ya son las palabras del puerto del ITM")
+    parser.add_argument("--port", type=int, default=LOGGER_ITM_PORT, help="puerto de estimulo del ITM")
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    with open(args.capture, "rb") as f:
+        data = f.read()
+    if not args.raw:
+        data = itm_port_bytes(data, args.port)
+    decode(elf, data, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
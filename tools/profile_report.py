@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""
+Perfil plano del firmware a partir del histograma de profiler.c.
+
+Con el programa compilado con -DUSE_PROFILER=true y la placa parada en el depurador tras un rato de uso:
+    (gdb) dump binary value profile.bin profiler_hist
+    $ profile_report.py bin/stm32f446re/Debug/main.elf profile.bin
+
+Cada intervalo del histograma se reparte entre las funciones del ELF que lo ocupan, en proporcion a los bytes de
+cada una. Las muestras en `port_system_power_sleep` son el tiempo dormido esperando una interrupcion.
+
+Solo usa la biblioteca estandar de Python.
+"""
+
+import argparse
+import struct
+import sys
+from collections import defaultdict
+
+PROFILER_MAGIC = 0x464F5250
+HEADER = struct.Struct("<IIIIII")
+
+SHT_SYMTAB = 2
+STT_FUNC = 2
+
+
+def read_functions(path):
+    """Devuelve las funciones del ELF como (inicio, fin, nombre), ordenadas por direccion."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+        sys.exit(f"{path}: no es un ELF de 32 bits en little endian")
+    e_shoff, = struct.unpack_from("<I", data, 0x20)
+    e_shentsize, e_shnum = struct.unpack_from("<HH", data, 0x2E)
+    sections = [struct.unpack_from("<IIIIIIIIII", data, e_shoff + i * e_shentsize) for i in range(e_shnum)]
+    functions = []
+    for (_, sh_type, _, _, sh_offset, sh_size, sh_link, _, _, sh_entsize) in sections:
+        if sh_type != SHT_SYMTAB:
+            continue
+        str_offset = sections[sh_link][4]
+        for n in range(sh_size // sh_entsize):
+            st_name, st_value, st_size, st_info = struct.unpack_from("<IIIB", data, sh_offset + n * sh_entsize)
+            if (st_info & 0x0F) != STT_FUNC or st_size == 0:
+                continue
+            end = data.index(b"\x00", str_offset + st_name)
+            name = data[str_offset + st_name:end].decode("latin-1")
+            start = st_value & ~1  # Thumb
+            functions.append((start, start + st_size, name))
+    if not functions:
+        sys.exit(f"{path}: el ELF no tiene tabla de simbolos")
+    return sorted(set(functions))
+
+
+def read_histogram(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    magic, code_base, bucket_shift, num_buckets, samples, out_of_range = HEADER.unpack_from(data, 0)
+    if magic != PROFILER_MAGIC:
+        sys.exit("el volcado no empieza por el histograma del perfilador (profiler_hist)")
+    buckets = struct.unpack_from(f"<{num_buckets}I", data, HEADER.size)
+    return code_base, 1 << bucket_shift, buckets, samples, out_of_range
+
+
+def profile(functions, code_base, bucket_size, buckets):
+    """Reparte las muestras de cada intervalo entre las funciones que lo ocupan."""
+    totals = defaultdict(float)
+    first = 0
+    for i, count in enumerate(buckets):
+        if count == 0:
+            continue
+        low = code_base + i * bucket_size
+        high = low + bucket_size
+        while first < len(functions) and functions[first][1] <= low:
+            first += 1
+        overlaps = []
+        for start, end, name in functions[first:]:
+            if start >= high:
+                break
+            overlaps.append((name, min(end, high) - max(start, low)))
+        covered = sum(size for _, size in overlaps)
+        if covered == 0:
+            totals[f"0x{low:08x}"] += count
+            continue
+        for name, size in overlaps:
+            totals[name] += count * size / covered
+    return totals
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Perfil plano del firmware a partir del histograma del perfilador")
+    parser.add_argument("elf", help="ELF del programa perfilado")
+    parser.add_argument("dump", help="volcado binario de profiler_hist")
+    parser.add_argument("-n", "--top", type=int, default=30, help="funciones que se muestran")
+    args = parser.parse_args()
+
+    code_base, bucket_size, buckets, samples, out_of_range = read_histogram(args.dump)
+    if samples == 0:
+        sys.exit("el histograma no tiene muestras")
+    totals = profile(read_functions(args.elf), code_base, bucket_size, buckets)
+
+    print(f"{samples} muestras, intervalos de {bucket_size} bytes desde 0x{code_base:08x}")
+    print(f"{'muestras':>9} {'%':>6}  funcion")
+    for name, count in sorted(totals.items(), key=lambda item: -item[1])[:args.top]:
+        print(f"{count:9.1f} {100.0 * count / samples:6.2f}  {name}")
+    if out_of_range:
+        print(f"{out_of_range:9d} {100.0 * out_of_range / samples:6.2f}  (fuera del histograma)")
+
+
+if __name__ == "__main__":
+    main()
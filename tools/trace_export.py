@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""
+Exportador de la traza de trace.c al formato JSON de eventos de Chrome/Perfetto.
+
+Con la placa parada en el depurador se vuelca el buffer de la traza y se exporta:
+    (gdb) dump binary value trace.bin trace_ring
+    $ trace_export.py trace.bin > trace.json
+
+El resultado se abre en https://ui.perfetto.dev o en chrome://tracing. Los nombres de las FSM son los que
+registra main.c segun su prioridad; se pueden cambiar con --fsm-names.
+
+Solo usa la biblioteca estandar de Python.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+TRACE_MAGIC = 0x54524345
+TRACE_TYPE_FSM = 0
+TRACE_TYPE_ISR_ENTER = 1
+TRACE_GUARD_NONE = 0xFF
+TRACE_GUARD_UNKNOWN = 0xFE
+PID_FSM = 1
+PID_ISR = 2
+
+FSM_NAMES = ["button", "ultrasound", "urbanite", "buzzer", "display"]
+ISR_NAMES = ["TIM11", "EXTI15_10", "TIM10", "TIM2", "TIM3", "TIM5"]
+
+HEADER = struct.Struct("<IIII")
+RECORD = struct.Struct("<IIBBBBB3x")
+
+
+def read_records(data):
+    """Devuelve los registros del volcado, del mas antiguo al mas reciente."""
+    magic, head, num_records, record_size = HEADER.unpack_from(data, 0)
+    if magic != TRACE_MAGIC:
+        sys.exit("el volcado no empieza por el buffer de la traza (trace_ring)")
+    if record_size != RECORD.size:
+        sys.exit(f"registros de {record_size} bytes, se esperaban {RECORD.size}")
+    first = head - num_records if head > num_records else 0
+    records = []
+    for n in range(first, head):
+        offset = HEADER.size + (n % num_records) * record_size
+        records.append(RECORD.unpack_from(data, offset))
+    return records
+
+
+def export_guard(guard):
+    """Indice de la transicion del disparo: None si no hay ninguna y "unknown" si no se puede saber cual."""
+    if guard == TRACE_GUARD_NONE:
+        return None
+    if guard == TRACE_GUARD_UNKNOWN:
+        return "unknown"
+    return guard
+
+
+def export(records, fsm_names):
+    events = [
+        {"name": "process_name", "ph": "M", "pid": PID_FSM, "args": {"name": "FSM"}},
+        {"name": "process_name", "ph": "M", "pid": PID_ISR, "args": {"name": "ISR"}},
+    ]
+    for tid, name in enumerate(fsm_names):
+        events.append({"name": "thread_name", "ph": "M", "pid": PID_FSM, "tid": tid, "args": {"name": name}})
+    for tid, name in enumerate(ISR_NAMES):
+        events.append({"name": "thread_name", "ph": "M", "pid": PID_ISR, "tid": tid, "args": {"name": name}})
+
+    for ts_us, dur_us, rec_type, rec_id, state_from, state_to, guard in records:
+        if rec_type == TRACE_TYPE_FSM:
+            events.append({
+                "name": f"{state_from}->{state_to}", "ph": "X", "ts": ts_us, "dur": dur_us,
+                "pid": PID_FSM, "tid": rec_id,
+                "args": {"from": state_from, "to": state_to, "guard": export_guard(guard)},
+            })
+        else:
+            name = ISR_NAMES[rec_id] if rec_id < len(ISR_NAMES) else "ISR"
+            events.append({"name": name, "ph": "B" if rec_type == TRACE_TYPE_ISR_ENTER else "E", "ts": ts_us,
+                           "pid": PID_ISR, "tid": rec_id})
+    return {"displayTimeUnit": "ms", "traceEvents": events}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Exporta un volcado de la traza a JSON de Chrome/Perfetto")
+    parser.add_argument("dump", help="volcado binario de trace_ring")
+    parser.add_argument("--fsm-names", default=",".join(FSM_NAMES), help="nombres de las FSM por prioridad, separados por comas")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        data = f.read()
+    json.dump(export(read_records(data), args.fsm_names.split(",")), sys.stdout, indent=1)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()